@@ -68,7 +68,6 @@ enum
 struct _PeaqFFTEarModel
 {
   PeaqEarModel parent;
-  GstFFTF64 *gstfft;
   gdouble *outer_middle_ear_weight;
   gdouble deltaZ;
   gdouble level_factor;
@@ -95,7 +94,10 @@ struct _PeaqFFTEarModelClass
   gdouble *hann_window;
 };
 
+/* each state has its own FFT, as its scratch memory would not allow
+ * processing several states concurrently otherwise */
 struct _PeaqFFTEarModelState {
+  GstFFTF64 *gstfft;
   gdouble *filtered_excitation;
   gdouble *unsmeared_excitation;
   gdouble *excitation;
@@ -241,8 +243,6 @@ init (GTypeInstance *obj, gpointer klass)
 {
   PeaqFFTEarModel *model = PEAQ_FFTEARMODEL (obj);
 
-  model->gstfft = gst_fft_f64_new (FFT_FRAMESIZE, FALSE);
-
   /* pre-compute weighting coefficients for outer and middle ear weighting 
    * function; (7) in [BS1387], (6) in [Kabal03], but taking the squared value
    * for applying in the power domain */
@@ -269,7 +269,6 @@ finalize (GObject *obj)
   GObjectClass *parent_class =
     G_OBJECT_CLASS (g_type_class_peek_parent (g_type_class_peek
                                               (PEAQ_TYPE_FFTEARMODEL)));
-  gst_fft_f64_free (model->gstfft);
   g_free (model->outer_middle_ear_weight);
   g_free (model->band_lower_end);
   g_free (model->band_upper_end);
@@ -317,6 +316,7 @@ static
 gpointer state_alloc (PeaqEarModel const *model)
 {
   PeaqFFTEarModelState *state = g_new0 (PeaqFFTEarModelState, 1);
+  state->gstfft = gst_fft_f64_new (FFT_FRAMESIZE, FALSE);
   state->filtered_excitation = g_new0 (gdouble, model->band_count);
   state->unsmeared_excitation = g_new0 (gdouble, model->band_count);
   state->excitation = g_new0 (gdouble, model->band_count);
@@ -326,6 +326,7 @@ gpointer state_alloc (PeaqEarModel const *model)
 static
 void state_free (PeaqEarModel const *model, gpointer state)
 {
+  gst_fft_f64_free (((PeaqFFTEarModelState *) state)->gstfft);
   g_free (((PeaqFFTEarModelState *) state)->filtered_excitation);
   g_free (((PeaqFFTEarModelState *) state)->unsmeared_excitation);
   g_free (((PeaqFFTEarModelState *) state)->excitation);
@@ -454,7 +455,7 @@ process_block (PeaqEarModel const *model, gpointer state,
   /* apply FFT to windowed data; (4) in [BS1387] and part of (4) in [Kabal03],
    * but without division by FFT_FRAMESIZE, which is subsumed in the
    * level_factor applied next */
-  gst_fft_f64_fft (fft_model->gstfft, windowed_data, fftoutput);
+  gst_fft_f64_fft (fft_state->gstfft, windowed_data, fftoutput);
 
   for (k = 0; k < FFT_FRAMESIZE / 2 + 1; k++) {
     /* compute power spectrum and apply scaling depending on playback level; in
@@ -36,6 +36,9 @@
  * GstPeaq supports both the basic and the advanced version of <xref
  * linkend="BS1387" />, as controlled with #GstPeaq:advanced.
  *
+ * The measurement itself is carried out by a #PeaqEngine, which may also be
+ * used directly where constructing a pipeline is not desired.
+ *
  * The resulting objective difference grade can be acquired at any time using
  * the #GstPeaq:odg property. If #GstPeaq:console-output is set to TRUE, the
  * final objective difference grade (and some additional data) is also printed
@@ -60,17 +63,9 @@
 #include <glib/gprintf.h>
 #include <gst/base/gstadapter.h>
 #include <gst/gst.h>
-#include <math.h>
-#include <string.h>
 
 #include "gstpeaq.h"
-#include "fbearmodel.h"
-#include "fftearmodel.h"
-#include "leveladapter.h"
-#include "modpatt.h"
-#include "movaccum.h"
-#include "movs.h"
-#include "nn.h"
+#include "peaqengine.h"
 
 enum
 {
@@ -83,29 +78,30 @@ enum
   PROP_CONSOLE_OUTPUT
 };
 
-enum _MovAdvanced {
-  MOVADV_RMS_MOD_DIFF,
-  MOVADV_RMS_NOISE_LOUD_ASYM,
-  MOVADV_SEGMENTAL_NMR,
-  MOVADV_EHS,
-  MOVADV_AVG_LIN_DIST,
-  COUNT_MOV_ADVANCED
-};
+/*
+ * Buffers are passed from the streaming thread of each pad to the processing
+ * thread through a bounded single-producer single-consumer ring. head is only
+ * written by the consumer and tail only by the producer, each publishing its
+ * index after accessing the entry, so the ring itself needs no lock. The
+ * queue_lock and queue_cond of the element are only used to sleep while the
+ * ring is full or while no ring has a buffer to take, announced by
+ * producer_waiting and consumer_waiting, respectively, which the other side
+ * checks after each update of its index. The consumer only takes a buffer
+ * from a pad whose adapter holds no more than the other one, unless the other
+ * pad has ended, so a pad running ahead fills its ring and waits instead of
+ * growing its adapter. eos is only written by the producer, once its last
+ * buffer is in the ring.
+ */
+#define QUEUE_LENGTH 64
 
-enum _MovBasic {
-  MOVBASIC_BANDWIDTH_REF,
-  MOVBASIC_BANDWIDTH_TEST,
-  MOVBASIC_TOTAL_NMR,
-  MOVBASIC_WIN_MOD_DIFF,
-  MOVBASIC_ADB,
-  MOVBASIC_EHS,
-  MOVBASIC_AVG_MOD_DIFF_1,
-  MOVBASIC_AVG_MOD_DIFF_2,
-  MOVBASIC_RMS_NOISE_LOUD,
-  MOVBASIC_MFPD,
-  MOVBASIC_REL_DIST_FRAMES,
-  COUNT_MOV_BASIC
-};
+typedef struct
+{
+  GstBuffer *buffers[QUEUE_LENGTH];
+  gint head;
+  gint tail;
+  gint producer_waiting;
+  gint eos;
+} BufferQueue;
 
 struct _GstPeaq
 {
@@ -114,28 +110,22 @@ struct _GstPeaq
   GstPad *testpad;
   gboolean ref_eos;
   gboolean test_eos;
-  GstAdapter *ref_adapter_fft;
-  GstAdapter *test_adapter_fft;
-  GstAdapter *ref_adapter_fb;
-  GstAdapter *test_adapter_fb;
+  GstAdapter *ref_adapter;
+  GstAdapter *test_adapter;
   gboolean console_output;
   gboolean advanced;
   gint channels;
-  guint frame_counter;
-  guint frame_counter_fb;
-  guint loudness_reached_frame;
-  PeaqEarModel *fft_ear_model;
-  gpointer *ref_fft_ear_state;
-  gpointer *test_fft_ear_state;
-  PeaqEarModel *fb_ear_model;
-  gpointer *ref_fb_ear_state;
-  gpointer *test_fb_ear_state;
-  PeaqLevelAdapter **level_adapter;
-  PeaqModulationProcessor **ref_modulation_processor;
-  PeaqModulationProcessor **test_modulation_processor;
-  PeaqMovAccum *mov_accum[COUNT_MOV_BASIC];
-  gdouble total_signal_energy;
-  gdouble total_noise_energy;
+  gdouble playback_level;
+  PeaqEngine *engine;
+  GMutex engine_lock;
+  BufferQueue ref_queue;
+  BufferQueue test_queue;
+  GMutex queue_lock;
+  GCond queue_cond;
+  gint consumer_waiting;
+  gboolean draining;
+  gboolean running;
+  GThread *processing_thread;
 };
 
 struct _GstPeaqClass
@@ -143,6 +133,12 @@ struct _GstPeaqClass
   GstElementClass parent_class;
 };
 
+#if GST_VERSION_MAJOR < 1
+#define FLOW_FLUSHING GST_FLOW_WRONG_STATE
+#else
+#define FLOW_FLUSHING GST_FLOW_FLUSHING
+#endif
+
 #if GST_VERSION_MAJOR < 1
 #define STATIC_CAPS \
   GST_STATIC_CAPS ( \
@@ -178,8 +174,19 @@ static void base_init (gpointer g_class);
 static void class_init (gpointer g_class, gpointer class_data);
 static void init (GTypeInstance *obj, gpointer g_class);
 static void finalize (GObject * object);
-static void free_per_channel_data(GstPeaq *peaq);
-static void alloc_per_channel_data(GstPeaq *peaq);
+static void rebuild_engine (GstPeaq *peaq);
+static gboolean queue_push (GstPeaq *peaq, BufferQueue *queue,
+                            GstBuffer *buffer);
+static void queue_end (GstPeaq *peaq, BufferQueue *queue);
+static gboolean queue_ready (BufferQueue *queue, GstAdapter *adapter,
+                             BufferQueue *other, GstAdapter *other_adapter);
+static gboolean queue_pop (GstPeaq *peaq, BufferQueue *queue,
+                           GstAdapter *adapter);
+static void queue_clear (BufferQueue *queue);
+static void start_processing (GstPeaq *peaq);
+static void stop_processing (GstPeaq *peaq);
+static void wait_processed (GstPeaq *peaq);
+static gpointer processing_thread (gpointer data);
 static void get_property (GObject *obj, guint id, GValue *value,
                           GParamSpec *pspec);
 static void set_property (GObject *obj, guint id, const GValue *value,
@@ -202,16 +209,9 @@ static GstStateChangeReturn change_state (GstElement * element,
 #if GST_VERSION_MAJOR < 1
 static gboolean send_event (GstElement *element, GstEvent *event);
 #endif
-static void process_fft_block_basic (GstPeaq *peaq, gfloat *refdata,
-                                     gfloat *testdata);
-static void process_fft_block_advanced (GstPeaq *peaq, gfloat *refdata,
-                                        gfloat *testdata);
-static void process_fb_block (GstPeaq *peaq, gfloat *refdata, gfloat *testdata);
-static double calculate_di_basic (GstPeaq * peaq);
-static double calculate_di_advanced (GstPeaq *peaq);
+static void print_movs (GstPeaq *peaq, PeaqResult const *result);
+static double calculate_di (GstPeaq *peaq);
 static double calculate_odg (GstPeaq * peaq);
-static gboolean is_frame_above_threshold (gfloat *framedata, guint framesize,
-                                          guint channels);
 
 GType
 gst_peaq_get_type (void)
@@ -382,15 +382,25 @@ class_init (gpointer g_class, gpointer class_data)
 static void
 init (GTypeInstance *obj, gpointer g_class)
 {
-  guint i;
   GstPadTemplate *template;
 
   GstPeaq *peaq = GST_PEAQ (obj);
 
-  peaq->ref_adapter_fft = gst_adapter_new ();
-  peaq->test_adapter_fft = gst_adapter_new ();
-  peaq->ref_adapter_fb = gst_adapter_new ();
-  peaq->test_adapter_fb = gst_adapter_new ();
+  peaq->ref_adapter = gst_adapter_new ();
+  peaq->test_adapter = gst_adapter_new ();
+  g_mutex_init (&peaq->engine_lock);
+  g_mutex_init (&peaq->queue_lock);
+  g_cond_init (&peaq->queue_cond);
+  peaq->ref_queue.head = peaq->ref_queue.tail = 0;
+  peaq->ref_queue.producer_waiting = FALSE;
+  peaq->ref_queue.eos = FALSE;
+  peaq->test_queue.head = peaq->test_queue.tail = 0;
+  peaq->test_queue.producer_waiting = FALSE;
+  peaq->test_queue.eos = FALSE;
+  peaq->consumer_waiting = FALSE;
+  peaq->draining = FALSE;
+  peaq->running = FALSE;
+  peaq->processing_thread = NULL;
 
   template = gst_static_pad_template_get (&gst_peaq_ref_template);
   peaq->refpad = gst_pad_new_from_template (template, "ref");
@@ -424,122 +434,44 @@ init (GTypeInstance *obj, gpointer g_class)
   GST_OBJECT_FLAG_SET (peaq, GST_ELEMENT_FLAG_SINK);
 #endif
 
-  peaq->frame_counter = 0;
-  peaq->frame_counter_fb = 0;
-  peaq->loudness_reached_frame = G_MAXUINT;
-  peaq->total_signal_energy = 0.;
-  peaq->total_noise_energy = 0.;
-
   peaq->channels = 0;
-  peaq->fft_ear_model = g_object_new (PEAQ_TYPE_FFTEARMODEL, NULL);
-  peaq->fb_ear_model = g_object_new (PEAQ_TYPE_FILTERBANKEARMODEL, NULL);
-
-  peaq->ref_fft_ear_state = NULL;
-  peaq->test_fft_ear_state = NULL;
-  peaq->ref_fb_ear_state = NULL;
-  peaq->test_fb_ear_state = NULL;
-
-  peaq->level_adapter = NULL;
-  peaq->ref_modulation_processor = NULL;
-  peaq->test_modulation_processor = NULL;
-  for (i = 0; i < COUNT_MOV_BASIC; i++)
-    peaq->mov_accum[i] = peaq_movaccum_new ();
+  peaq->advanced = FALSE;
+  peaq->playback_level = 92;
+  peaq->engine = NULL;
+  rebuild_engine (peaq);
 }
 
 static void
 finalize (GObject * object)
 {
-  guint i;
   GstElementClass *parent_class = 
     GST_ELEMENT_CLASS (g_type_class_peek_parent (g_type_class_peek
                                                  (GST_TYPE_PEAQ)));
   GstPeaq *peaq = GST_PEAQ (object);
-  free_per_channel_data (peaq);
-  g_object_unref (peaq->ref_adapter_fft);
-  g_object_unref (peaq->test_adapter_fft);
-  g_object_unref (peaq->ref_adapter_fb);
-  g_object_unref (peaq->test_adapter_fb);
-  g_object_unref (peaq->fft_ear_model);
-  g_object_unref (peaq->fb_ear_model);
-  for (i = 0; i < COUNT_MOV_BASIC; i++)
-    g_object_unref (peaq->mov_accum[i]);
+  stop_processing (peaq);
+  queue_clear (&peaq->ref_queue);
+  queue_clear (&peaq->test_queue);
+  g_object_unref (peaq->ref_adapter);
+  g_object_unref (peaq->test_adapter);
+  peaq_engine_free (peaq->engine);
+  g_mutex_clear (&peaq->engine_lock);
+  g_mutex_clear (&peaq->queue_lock);
+  g_cond_clear (&peaq->queue_cond);
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+/* The engine is created for a fixed mode and number of channels, so it is
+ * replaced whenever either of them changes. Once the element has been
+ * initialized, this requires the engine_lock. */
 static void
-free_per_channel_data (GstPeaq *peaq)
+rebuild_engine (GstPeaq *peaq)
 {
-  guint c;
-
-  if (peaq->ref_fft_ear_state) {
-    for (c = 0; c < peaq->channels; c++)
-      peaq_earmodel_state_free (peaq->fft_ear_model, peaq->ref_fft_ear_state[c]);
-    g_free (peaq->ref_fft_ear_state);
-  }
-  if (peaq->test_fft_ear_state) {
-    for (c = 0; c < peaq->channels; c++)
-      peaq_earmodel_state_free (peaq->fft_ear_model, peaq->test_fft_ear_state[c]);
-    g_free (peaq->test_fft_ear_state);
-  }
-  if (peaq->level_adapter) {
-    for (c = 0; c < peaq->channels; c++)
-      g_object_unref (peaq->level_adapter[c]);
-    g_free (peaq->level_adapter);
-  }
-  if (peaq->ref_modulation_processor) {
-    for (c = 0; c < peaq->channels; c++)
-      g_object_unref (peaq->ref_modulation_processor[c]);
-    g_free (peaq->ref_modulation_processor);
-  }
-  if (peaq->test_modulation_processor) {
-    for (c = 0; c < peaq->channels; c++)
-      g_object_unref (peaq->test_modulation_processor[c]);
-    g_free (peaq->test_modulation_processor);
-  }
-  if (peaq->ref_fb_ear_state) {
-    for (c = 0; c < peaq->channels; c++)
-      peaq_earmodel_state_free (peaq->fb_ear_model, peaq->ref_fb_ear_state[c]);
-    g_free (peaq->ref_fb_ear_state);
-  }
-  if (peaq->test_fb_ear_state) {
-    for (c = 0; c < peaq->channels; c++)
-      peaq_earmodel_state_free (peaq->fb_ear_model, peaq->test_fb_ear_state[c]);
-    g_free (peaq->test_fb_ear_state);
-  }
-}
-
-static void
-alloc_per_channel_data (GstPeaq *peaq)
-{
-  guint c;
-
-  peaq->ref_fft_ear_state = g_new (gpointer, peaq->channels);
-  peaq->test_fft_ear_state = g_new (gpointer, peaq->channels);
-  peaq->level_adapter = g_new (PeaqLevelAdapter *, peaq->channels);
-  peaq->ref_modulation_processor = g_new (PeaqModulationProcessor *, peaq->channels);
-  peaq->test_modulation_processor = g_new (PeaqModulationProcessor *, peaq->channels);
-  for (c = 0; c < peaq->channels; c++) {
-    peaq->ref_fft_ear_state[c] = peaq_earmodel_state_alloc (peaq->fft_ear_model);
-    peaq->test_fft_ear_state[c] = peaq_earmodel_state_alloc (peaq->fft_ear_model);
-    peaq->level_adapter[c] = peaq_leveladapter_new (peaq->fft_ear_model);
-    peaq->ref_modulation_processor[c] =
-      peaq_modulationprocessor_new (peaq->fft_ear_model);
-    peaq->test_modulation_processor[c] =
-      peaq_modulationprocessor_new (peaq->fft_ear_model);
-  }
-  if (peaq->advanced) {
-    peaq->ref_fb_ear_state = g_new (gpointer, peaq->channels);
-    peaq->test_fb_ear_state = g_new (gpointer, peaq->channels);
-    for (c = 0; c < peaq->channels; c++) {
-      peaq->ref_fb_ear_state[c] = peaq_earmodel_state_alloc (peaq->fb_ear_model);
-      peaq->test_fb_ear_state[c] = peaq_earmodel_state_alloc (peaq->fb_ear_model);
-      peaq_leveladapter_set_ear_model (peaq->level_adapter[c], peaq->fb_ear_model);
-      peaq_modulationprocessor_set_ear_model (peaq->ref_modulation_processor[c],
-                                              peaq->fb_ear_model);
-      peaq_modulationprocessor_set_ear_model (peaq->test_modulation_processor[c],
-                                              peaq->fb_ear_model);
-    }
-  }
+  if (peaq->engine)
+    peaq_engine_free (peaq->engine);
+  peaq->engine = peaq_engine_new (peaq->advanced ?
+                                  PEAQ_MODE_ADVANCED : PEAQ_MODE_BASIC,
+                                  peaq->channels);
+  peaq_engine_set_playback_level (peaq->engine, peaq->playback_level);
 }
 
 static void
@@ -548,22 +480,28 @@ get_property (GObject *obj, guint id, GValue *value, GParamSpec *pspec)
   GstPeaq *peaq = GST_PEAQ (obj);
   switch (id) {
     case PROP_PLAYBACK_LEVEL:
-      g_object_get_property (G_OBJECT (peaq->fft_ear_model),
-			     "playback-level", value);
+      g_mutex_lock (&peaq->engine_lock);
+      g_value_set_double (value,
+                          peaq_engine_get_playback_level (peaq->engine));
+      g_mutex_unlock (&peaq->engine_lock);
       break;
     case PROP_DI:
-      if (peaq->advanced)
-        g_value_set_double (value, calculate_di_advanced (peaq));
-      else
-        g_value_set_double (value, calculate_di_basic (peaq));
+      g_mutex_lock (&peaq->engine_lock);
+      g_value_set_double (value, calculate_di (peaq));
+      g_mutex_unlock (&peaq->engine_lock);
       break;
     case PROP_ODG:
+      g_mutex_lock (&peaq->engine_lock);
       g_value_set_double (value, calculate_odg (peaq));
+      g_mutex_unlock (&peaq->engine_lock);
       break;
     case PROP_TOTALSNR:
       {
-        gdouble snr = peaq->total_signal_energy / peaq->total_noise_energy;
-        g_value_set_double (value, 10 * log10 (snr));
+        PeaqResult result;
+        g_mutex_lock (&peaq->engine_lock);
+        peaq_engine_get_result (peaq->engine, &result);
+        g_mutex_unlock (&peaq->engine_lock);
+        g_value_set_double (value, result.total_snr);
       }
       break;
     case PROP_CONSOLE_OUTPUT:
@@ -578,56 +516,16 @@ set_property (GObject *obj, guint id, const GValue *value, GParamSpec *pspec)
   GstPeaq *peaq = GST_PEAQ (obj);
   switch (id) {
     case PROP_PLAYBACK_LEVEL:
-      g_object_set_property (G_OBJECT (peaq->fft_ear_model),
-			     "playback-level", value);
-      g_object_set_property (G_OBJECT (peaq->fb_ear_model),
-			     "playback-level", value);
+      g_mutex_lock (&peaq->engine_lock);
+      peaq->playback_level = g_value_get_double (value);
+      peaq_engine_set_playback_level (peaq->engine, peaq->playback_level);
+      g_mutex_unlock (&peaq->engine_lock);
       break;
     case PROP_MODE_ADVANCED:
-      {
-        guint band_count;
-        free_per_channel_data (peaq);
-        peaq->advanced = g_value_get_boolean (value);
-        if (peaq->advanced) {
-          band_count = 55;
-        } else {
-          band_count = 109;
-        }
-        g_object_set (peaq->fft_ear_model, "number-of-bands", band_count, NULL);
-        if (peaq->advanced) {
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVADV_RMS_MOD_DIFF],
-                                  MODE_RMS);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVADV_SEGMENTAL_NMR],
-                                  MODE_AVG);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVADV_EHS], MODE_AVG);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVADV_AVG_LIN_DIST],
-                                  MODE_AVG);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVADV_RMS_NOISE_LOUD_ASYM],
-                                  MODE_RMS_ASYM);
-        } else {
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVBASIC_BANDWIDTH_REF],
-                                  MODE_AVG);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVBASIC_BANDWIDTH_TEST],
-                                  MODE_AVG);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVBASIC_TOTAL_NMR],
-                                  MODE_AVG_LOG);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVBASIC_WIN_MOD_DIFF],
-                                  MODE_AVG_WINDOW);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVBASIC_ADB], MODE_ADB);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVBASIC_EHS], MODE_AVG);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVBASIC_AVG_MOD_DIFF_1],
-                                  MODE_AVG);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVBASIC_AVG_MOD_DIFF_2],
-                                  MODE_AVG);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVBASIC_RMS_NOISE_LOUD],
-                                  MODE_RMS);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVBASIC_MFPD],
-                                  MODE_FILTERED_MAX);
-          peaq_movaccum_set_mode (peaq->mov_accum[MOVBASIC_REL_DIST_FRAMES],
-                                  MODE_AVG);
-        }
-        alloc_per_channel_data (peaq);
-      }
+      g_mutex_lock (&peaq->engine_lock);
+      peaq->advanced = g_value_get_boolean (value);
+      rebuild_engine (peaq);
+      g_mutex_unlock (&peaq->engine_lock);
       break;
     case PROP_CONSOLE_OUTPUT:
       peaq->console_output = g_value_get_boolean (value);
@@ -667,22 +565,13 @@ set_caps (GstPad *pad, GstCaps *caps)
 {
   GstPeaq *peaq = GST_PEAQ (gst_pad_get_parent_element (pad));
 
-  GST_OBJECT_LOCK (peaq);
+  g_mutex_lock (&peaq->engine_lock);
 
-  free_per_channel_data (peaq);
-
-  guint i;
   gst_structure_get_int (gst_caps_get_structure (caps, 0),
                          "channels", &(peaq->channels));
-  for (i = 0; i < COUNT_MOV_BASIC; i++)
-    if (!peaq->advanced && (i == MOVBASIC_ADB || i == MOVBASIC_MFPD))
-      peaq_movaccum_set_channels (peaq->mov_accum[i], 1);
-    else
-      peaq_movaccum_set_channels (peaq->mov_accum[i], peaq->channels);
-
-  alloc_per_channel_data (peaq);
+  rebuild_engine (peaq);
 
-  GST_OBJECT_UNLOCK (peaq);
+  g_mutex_unlock (&peaq->engine_lock);
 
   gst_object_unref (peaq);
 
@@ -690,27 +579,36 @@ set_caps (GstPad *pad, GstCaps *caps)
 }
 
 static void
-do_processing (GstPeaq *peaq, GstAdapter *ref_adapter, GstAdapter *test_adapter,
-               void (*process_block)(GstPeaq *, gfloat*, gfloat *),
-               guint frame_size_bytes, guint step_size_bytes)
+do_processing (GstPeaq *peaq)
 {
-  while (gst_adapter_available (ref_adapter) >= frame_size_bytes &&
-         gst_adapter_available (test_adapter) >= frame_size_bytes)
-  {
+  guint frame_size_bytes = peaq->channels * sizeof (gfloat);
+  guint frame_count;
+
+  if (frame_size_bytes == 0)
+    return;
+  frame_count = MIN (gst_adapter_available (peaq->ref_adapter),
+                     gst_adapter_available (peaq->test_adapter)) /
+    frame_size_bytes;
+  if (frame_count > 0) {
+    guint data_count = frame_count * frame_size_bytes;
 #if GST_VERSION_MAJOR < 1
-    gfloat *refframe = (gfloat *) gst_adapter_peek (ref_adapter, frame_size_bytes);
-    gfloat *testframe = (gfloat *) gst_adapter_peek (test_adapter, frame_size_bytes);
+    const gfloat *refdata =
+      (const gfloat *) gst_adapter_peek (peaq->ref_adapter, data_count);
+    const gfloat *testdata =
+      (const gfloat *) gst_adapter_peek (peaq->test_adapter, data_count);
 #else
-    gfloat *refframe = (gfloat *) gst_adapter_map (ref_adapter, frame_size_bytes);
-    gfloat *testframe = (gfloat *) gst_adapter_map (test_adapter, frame_size_bytes);
+    const gfloat *refdata =
+      (const gfloat *) gst_adapter_map (peaq->ref_adapter, data_count);
+    const gfloat *testdata =
+      (const gfloat *) gst_adapter_map (peaq->test_adapter, data_count);
 #endif
-    process_block (peaq, refframe, testframe);
+    peaq_engine_push (peaq->engine, refdata, testdata, frame_count);
 #if GST_VERSION_MAJOR >= 1
-    gst_adapter_unmap (ref_adapter);
-    gst_adapter_unmap (test_adapter);
+    gst_adapter_unmap (peaq->ref_adapter);
+    gst_adapter_unmap (peaq->test_adapter);
 #endif
-    gst_adapter_flush (ref_adapter, step_size_bytes);
-    gst_adapter_flush (test_adapter, step_size_bytes);
+    gst_adapter_flush (peaq->ref_adapter, data_count);
+    gst_adapter_flush (peaq->test_adapter, data_count);
   }
 }
 
@@ -727,6 +625,7 @@ pad_chain (GstPad *pad, GstObject *parent, GstBuffer *buffer)
   GstElement *element = GST_ELEMENT (parent);
 #endif
   GstPeaq *peaq = GST_PEAQ (element);
+  GstFlowReturn ret = GST_FLOW_OK;
 
 #if GST_VERSION_MAJOR < 1
   if (buffer->caps != NULL) {
@@ -746,45 +645,205 @@ pad_chain (GstPad *pad, GstObject *parent, GstBuffer *buffer)
     element->pending_state = GST_STATE_VOID_PENDING;
   }
 
-  if (pad == peaq->refpad) {
+  if (pad == peaq->refpad)
     peaq->ref_eos = FALSE;
-    if (peaq->advanced)
-      gst_adapter_push (peaq->ref_adapter_fb, gst_buffer_copy (buffer));
-    gst_adapter_push (peaq->ref_adapter_fft, buffer);
-  } else if (pad == peaq->testpad) {
+  else if (pad == peaq->testpad)
     peaq->test_eos = FALSE;
-    if (peaq->advanced)
-      gst_adapter_push (peaq->test_adapter_fb, gst_buffer_copy (buffer));
-    gst_adapter_push (peaq->test_adapter_fft, buffer);
-  }
- 
-  guint frame_size_bytes =
-    peaq->channels * sizeof (gfloat) *
-    peaq_earmodel_get_frame_size (peaq->fft_ear_model);
-  guint step_size_bytes =
-    peaq->channels * sizeof (gfloat) *
-    peaq_earmodel_get_step_size (peaq->fft_ear_model);
-
-  if (peaq->advanced) {
-    do_processing (peaq, peaq->ref_adapter_fft, peaq->test_adapter_fft,
-                   process_fft_block_advanced, frame_size_bytes, step_size_bytes);
-    frame_size_bytes =
-      peaq->channels * sizeof (gfloat) *
-      peaq_earmodel_get_frame_size (peaq->fb_ear_model);
-    do_processing (peaq, peaq->ref_adapter_fb, peaq->test_adapter_fb,
-                   process_fb_block, frame_size_bytes, frame_size_bytes);
-  } else {
-    do_processing (peaq, peaq->ref_adapter_fft, peaq->test_adapter_fft,
-                   process_fft_block_basic, frame_size_bytes, step_size_bytes);
-  }
 
   GST_OBJECT_UNLOCK (peaq);
 
+  /* the processing is left to the processing thread, so neither pad waits for
+   * the other one's frames to be processed */
+  if (pad == peaq->refpad) {
+    if (!queue_push (peaq, &peaq->ref_queue, buffer))
+      ret = FLOW_FLUSHING;
+  } else if (pad == peaq->testpad) {
+    if (!queue_push (peaq, &peaq->test_queue, buffer))
+      ret = FLOW_FLUSHING;
+  }
+
 #if GST_VERSION_MAJOR < 1
   gst_object_unref (peaq);
 #endif
 
-  return GST_FLOW_OK;
+  return ret;
+}
+
+/* Appends buffer to queue, waiting while the queue is full. Returns FALSE,
+ * dropping the buffer, if the processing thread is not running and the queue
+ * is full. */
+static gboolean
+queue_push (GstPeaq *peaq, BufferQueue *queue, GstBuffer *buffer)
+{
+  guint tail = queue->tail;
+
+  g_atomic_int_set (&queue->eos, FALSE);
+  if (tail - (guint) g_atomic_int_get (&queue->head) >= QUEUE_LENGTH) {
+    g_mutex_lock (&peaq->queue_lock);
+    g_atomic_int_set (&queue->producer_waiting, TRUE);
+    while (peaq->running &&
+           tail - (guint) g_atomic_int_get (&queue->head) >= QUEUE_LENGTH)
+      g_cond_wait (&peaq->queue_cond, &peaq->queue_lock);
+    g_atomic_int_set (&queue->producer_waiting, FALSE);
+    g_mutex_unlock (&peaq->queue_lock);
+    if (tail - (guint) g_atomic_int_get (&queue->head) >= QUEUE_LENGTH) {
+      gst_buffer_unref (buffer);
+      return FALSE;
+    }
+  }
+
+  queue->buffers[tail % QUEUE_LENGTH] = buffer;
+  g_atomic_int_set (&queue->tail, tail + 1);
+  if (g_atomic_int_get (&peaq->consumer_waiting)) {
+    g_mutex_lock (&peaq->queue_lock);
+    g_cond_broadcast (&peaq->queue_cond);
+    g_mutex_unlock (&peaq->queue_lock);
+  }
+  return TRUE;
+}
+
+/* Marks the last buffer of queue as pushed, so that the other pad is no
+ * longer held back by it. */
+static void
+queue_end (GstPeaq *peaq, BufferQueue *queue)
+{
+  g_atomic_int_set (&queue->eos, TRUE);
+  if (g_atomic_int_get (&peaq->consumer_waiting)) {
+    g_mutex_lock (&peaq->queue_lock);
+    g_cond_broadcast (&peaq->queue_cond);
+    g_mutex_unlock (&peaq->queue_lock);
+  }
+}
+
+/* Returns whether the next buffer of queue may be moved to adapter, i.e.
+ * whether there is one and adapter is not ahead of the other pad's. */
+static gboolean
+queue_ready (BufferQueue *queue, GstAdapter *adapter,
+             BufferQueue *other, GstAdapter *other_adapter)
+{
+  if ((guint) g_atomic_int_get (&queue->tail) == (guint) queue->head)
+    return FALSE;
+  return g_atomic_int_get (&other->eos) ||
+    gst_adapter_available (adapter) <= gst_adapter_available (other_adapter);
+}
+
+/* Moves the next buffer from queue to adapter, returning whether there was
+ * one. Must only be called from one thread at a time. */
+static gboolean
+queue_pop (GstPeaq *peaq, BufferQueue *queue, GstAdapter *adapter)
+{
+  guint head = queue->head;
+  GstBuffer *buffer;
+
+  if (head == (guint) g_atomic_int_get (&queue->tail))
+    return FALSE;
+  buffer = queue->buffers[head % QUEUE_LENGTH];
+  g_atomic_int_set (&queue->head, head + 1);
+  gst_adapter_push (adapter, buffer);
+  if (g_atomic_int_get (&queue->producer_waiting)) {
+    g_mutex_lock (&peaq->queue_lock);
+    g_cond_broadcast (&peaq->queue_cond);
+    g_mutex_unlock (&peaq->queue_lock);
+  }
+  return TRUE;
+}
+
+static void
+queue_clear (BufferQueue *queue)
+{
+  while (queue->head != queue->tail) {
+    gst_buffer_unref (queue->buffers[(guint) queue->head % QUEUE_LENGTH]);
+    queue->head++;
+  }
+}
+
+static void
+start_processing (GstPeaq *peaq)
+{
+  queue_clear (&peaq->ref_queue);
+  queue_clear (&peaq->test_queue);
+  peaq->ref_queue.eos = FALSE;
+  peaq->test_queue.eos = FALSE;
+  peaq->running = TRUE;
+  peaq->processing_thread = g_thread_new ("peaq-process", processing_thread,
+                                          peaq);
+}
+
+/* Stops the processing thread after it has processed everything queued. Any
+ * buffer arriving meanwhile is moved to the adapters to be handled by
+ * do_flush(). */
+static void
+stop_processing (GstPeaq *peaq)
+{
+  if (!peaq->processing_thread)
+    return;
+  g_mutex_lock (&peaq->queue_lock);
+  peaq->running = FALSE;
+  g_cond_broadcast (&peaq->queue_cond);
+  g_mutex_unlock (&peaq->queue_lock);
+  g_thread_join (peaq->processing_thread);
+  peaq->processing_thread = NULL;
+  while (queue_pop (peaq, &peaq->ref_queue, peaq->ref_adapter));
+  while (queue_pop (peaq, &peaq->test_queue, peaq->test_adapter));
+}
+
+/* Waits until the processing thread has processed everything queued, i.e.
+ * until it sleeps with all queues empty. */
+static void
+wait_processed (GstPeaq *peaq)
+{
+  g_mutex_lock (&peaq->queue_lock);
+  peaq->draining = TRUE;
+  while (peaq->running &&
+         !(g_atomic_int_get (&peaq->consumer_waiting) &&
+           g_atomic_int_get (&peaq->ref_queue.tail) ==
+           g_atomic_int_get (&peaq->ref_queue.head) &&
+           g_atomic_int_get (&peaq->test_queue.tail) ==
+           g_atomic_int_get (&peaq->test_queue.head)))
+    g_cond_wait (&peaq->queue_cond, &peaq->queue_lock);
+  peaq->draining = FALSE;
+  g_mutex_unlock (&peaq->queue_lock);
+}
+
+static gpointer
+processing_thread (gpointer data)
+{
+  GstPeaq *peaq = data;
+
+  for (;;) {
+    gboolean received = FALSE;
+    gboolean running;
+
+    if (queue_ready (&peaq->ref_queue, peaq->ref_adapter,
+                     &peaq->test_queue, peaq->test_adapter))
+      received |= queue_pop (peaq, &peaq->ref_queue, peaq->ref_adapter);
+    if (queue_ready (&peaq->test_queue, peaq->test_adapter,
+                     &peaq->ref_queue, peaq->ref_adapter))
+      received |= queue_pop (peaq, &peaq->test_queue, peaq->test_adapter);
+    if (received) {
+      g_mutex_lock (&peaq->engine_lock);
+      do_processing (peaq);
+      g_mutex_unlock (&peaq->engine_lock);
+      continue;
+    }
+
+    g_mutex_lock (&peaq->queue_lock);
+    g_atomic_int_set (&peaq->consumer_waiting, TRUE);
+    if (peaq->draining)
+      g_cond_broadcast (&peaq->queue_cond);
+    while (peaq->running &&
+           !queue_ready (&peaq->ref_queue, peaq->ref_adapter,
+                         &peaq->test_queue, peaq->test_adapter) &&
+           !queue_ready (&peaq->test_queue, peaq->test_adapter,
+                         &peaq->ref_queue, peaq->ref_adapter))
+      g_cond_wait (&peaq->queue_cond, &peaq->queue_lock);
+    g_atomic_int_set (&peaq->consumer_waiting, FALSE);
+    running = peaq->running;
+    g_mutex_unlock (&peaq->queue_lock);
+    if (!running)
+      break;
+  }
+  return NULL;
 }
 
 static gboolean
@@ -807,11 +866,15 @@ pad_event (GstPad *pad, GstObject *parent, GstEvent* event)
 
         if (pad == peaq->refpad) {
           peaq->ref_eos = TRUE;
+          queue_end (peaq, &peaq->ref_queue);
         } else if (pad == peaq->testpad) {
           peaq->test_eos = TRUE;
+          queue_end (peaq, &peaq->test_queue);
         }
 
         if (peaq->ref_eos && peaq->test_eos) {
+          /* the results are expected to be complete once EOS is posted */
+          wait_processed (peaq);
 #if GST_VERSION_MAJOR < 1
           GstMessage *msg = gst_message_new_eos (GST_OBJECT_CAST (element));
 #else
@@ -861,44 +924,48 @@ pad_event (GstPad *pad, GstObject *parent, GstEvent* event)
 }
 
 static void
-do_flush (GstPeaq *peaq, GstAdapter *ref_adapter, GstAdapter *test_adapter,
-          void (*process_block)(GstPeaq *, gfloat*, gfloat *),
-          guint frame_size)
+do_flush (GstPeaq *peaq)
 {
-  guint ref_data_left_count, test_data_left_count;
-  ref_data_left_count = gst_adapter_available (ref_adapter);
-  test_data_left_count = gst_adapter_available (test_adapter);
-  if (ref_data_left_count || test_data_left_count) {
-    guint frame_size_bytes = peaq->channels * sizeof (gfloat) * frame_size;
-    gfloat *padded_ref_frame = g_newa (gfloat, peaq->channels * frame_size);
-    gfloat *padded_test_frame = g_newa (gfloat, peaq->channels * frame_size);
-    guint ref_data_count = MIN (ref_data_left_count, frame_size_bytes);
-    guint test_data_count = MIN (test_data_left_count, frame_size_bytes);
+  guint frame_size_bytes = peaq->channels * sizeof (gfloat);
+  guint ref_data_count, test_data_count;
+  const gfloat *refdata = NULL;
+  const gfloat *testdata = NULL;
+
+  if (frame_size_bytes == 0)
+    return;
+
+  /* whatever is left in one of the adapters extends beyond the end of the
+   * other signal */
+  ref_data_count = gst_adapter_available (peaq->ref_adapter) /
+    frame_size_bytes * frame_size_bytes;
+  test_data_count = gst_adapter_available (peaq->test_adapter) /
+    frame_size_bytes * frame_size_bytes;
 #if GST_VERSION_MAJOR < 1
-    gfloat *refframe = (gfloat *) gst_adapter_peek (ref_adapter,
-                                                    ref_data_count);
-    gfloat *testframe = (gfloat *) gst_adapter_peek (test_adapter,
-                                                     test_data_count);
+  if (ref_data_count)
+    refdata = (const gfloat *) gst_adapter_peek (peaq->ref_adapter,
+                                                 ref_data_count);
+  if (test_data_count)
+    testdata = (const gfloat *) gst_adapter_peek (peaq->test_adapter,
+                                                  test_data_count);
 #else
-    gfloat *refframe = (gfloat *) gst_adapter_map (ref_adapter,
-                                                   ref_data_count);
-    gfloat *testframe = (gfloat *) gst_adapter_map (test_adapter,
-                                                    test_data_count);
+  if (ref_data_count)
+    refdata = (const gfloat *) gst_adapter_map (peaq->ref_adapter,
+                                                ref_data_count);
+  if (test_data_count)
+    testdata = (const gfloat *) gst_adapter_map (peaq->test_adapter,
+                                                 test_data_count);
 #endif
-    g_memmove (padded_ref_frame, refframe, ref_data_count);
-    memset (((char *) padded_ref_frame) + ref_data_count, 0,
-            frame_size_bytes - ref_data_count);
-    g_memmove (padded_test_frame, testframe, test_data_count);
-    memset (((char *) padded_test_frame) + test_data_count, 0,
-            frame_size_bytes - test_data_count);
+  peaq_engine_push_tail (peaq->engine,
+                         refdata, ref_data_count / frame_size_bytes,
+                         testdata, test_data_count / frame_size_bytes);
 #if GST_VERSION_MAJOR >= 1
-    gst_adapter_unmap (ref_adapter);
-    gst_adapter_unmap (test_adapter);
+  if (ref_data_count)
+    gst_adapter_unmap (peaq->ref_adapter);
+  if (test_data_count)
+    gst_adapter_unmap (peaq->test_adapter);
 #endif
-    process_block (peaq, padded_ref_frame, padded_test_frame);
-    gst_adapter_flush (ref_adapter, ref_data_count);
-    gst_adapter_flush (test_adapter, test_data_count);
-  }
+  gst_adapter_clear (peaq->ref_adapter);
+  gst_adapter_clear (peaq->test_adapter);
 }
 
 static GstStateChangeReturn
@@ -915,22 +982,13 @@ change_state (GstElement * element, GstStateChange transition)
     case GST_STATE_CHANGE_NULL_TO_READY:
       break;
     case GST_STATE_CHANGE_READY_TO_PAUSED:
+      start_processing (peaq);
       break;
     case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
-      if (peaq->advanced) {
-        do_flush (peaq, peaq->ref_adapter_fft, peaq->test_adapter_fft,
-                  process_fft_block_advanced, 
-                  peaq_earmodel_get_frame_size (peaq->fft_ear_model));
-        do_flush (peaq, peaq->ref_adapter_fb, peaq->test_adapter_fb,
-                  process_fb_block, 
-                  peaq_earmodel_get_frame_size (peaq->fb_ear_model));
-      } else {
-        do_flush (peaq, peaq->ref_adapter_fft, peaq->test_adapter_fft,
-                  process_fft_block_basic, 
-                  peaq_earmodel_get_frame_size (peaq->fft_ear_model));
-      }
+      stop_processing (peaq);
+      do_flush (peaq);
 
       calculate_odg (peaq);
 
@@ -975,235 +1033,21 @@ send_event (GstElement *element, GstEvent *event)
 #endif
 
 static void
-apply_ear_model (PeaqEarModel *model, guint channels, gfloat *data,
-                 gpointer *state)
+print_movs (GstPeaq *peaq, PeaqResult const *result)
 {
-  guint c;
-  guint frame_size = peaq_earmodel_get_frame_size (model);
-  for (c = 0; c < channels; c++) {
-    gfloat *data_c;
-    if (channels != 1) {
-      guint i;
-      data_c = g_newa (gfloat, frame_size);
-      for (i = 0; i < frame_size; i++) {
-        data_c[i] = data[channels * i +c];
-      }
-    } else {
-      data_c = data;
-    }
-    peaq_earmodel_process_block (model, state[c], data_c);
-  }
-}
-
-static void
-apply_ear_model_and_preprocess (GstPeaq *peaq, PeaqEarModel *model,
-                                gfloat *refdata, gfloat *testdata,
-                                gpointer *refstate, gpointer *teststate,
-                                guint frame_counter)
-{
-  guint c;
-  gint channels = peaq->channels;
-  apply_ear_model (model, channels, refdata, refstate);
-  apply_ear_model (model, channels, testdata, teststate);
-  for (c = 0; c < channels; c++) {
-    gdouble const *ref_excitation =
-      peaq_earmodel_get_excitation (model, refstate[c]);
-    gdouble const *test_excitation =
-      peaq_earmodel_get_excitation (model, teststate[c]);
-    gdouble const *ref_unsmeared_excitation =
-      peaq_earmodel_get_unsmeared_excitation (model, refstate[c]);
-    gdouble const *test_unsmeared_excitation =
-      peaq_earmodel_get_unsmeared_excitation (model, teststate[c]);
-
-    peaq_leveladapter_process (peaq->level_adapter[c],
-                               ref_excitation, test_excitation);
-    peaq_modulationprocessor_process (peaq->ref_modulation_processor[c],
-                                      ref_unsmeared_excitation);
-    peaq_modulationprocessor_process (peaq->test_modulation_processor[c],
-                                      test_unsmeared_excitation);
-
-    if (peaq->loudness_reached_frame == G_MAXUINT) {
-      if (peaq_earmodel_calc_loudness (model, refstate[c]) > 0.1 &&
-          peaq_earmodel_calc_loudness (model, teststate[c]) > 0.1)
-        peaq->loudness_reached_frame = frame_counter;
-    }
-  }
-}
-
-static void
-process_fft_block_basic (GstPeaq *peaq, gfloat *refdata, gfloat *testdata)
-{
-  guint i;
-  gint channels = peaq->channels;
-
-  PeaqEarModel *ear_params = peaq->fft_ear_model;
-  guint frame_size = peaq_earmodel_get_frame_size (ear_params);
-
-  gboolean above_thres =
-    is_frame_above_threshold (refdata, frame_size, channels);
-
-  for (i = 0; i < COUNT_MOV_BASIC; i++)
-    peaq_movaccum_set_tentative (peaq->mov_accum[i], !above_thres);
-
-  apply_ear_model_and_preprocess (peaq, peaq->fft_ear_model,
-                                  refdata, testdata,
-                                  peaq->ref_fft_ear_state,
-                                  peaq->test_fft_ear_state,
-                                  peaq->frame_counter);
-
-  /* modulation difference */
-  if (peaq->frame_counter >= 24) {
-    peaq_mov_modulation_difference (peaq->ref_modulation_processor,
-                                    peaq->test_modulation_processor,
-                                    peaq->mov_accum[MOVBASIC_AVG_MOD_DIFF_1],
-                                    peaq->mov_accum[MOVBASIC_AVG_MOD_DIFF_2],
-                                    peaq->mov_accum[MOVBASIC_WIN_MOD_DIFF]);
-  }
-
-  /* noise loudness */
-  if (peaq->frame_counter >= 24 &&
-      peaq->frame_counter - 3 >= peaq->loudness_reached_frame) {
-    peaq_mov_noise_loudness (peaq->ref_modulation_processor,
-                             peaq->test_modulation_processor,
-                             peaq->level_adapter,
-                             peaq->mov_accum[MOVBASIC_RMS_NOISE_LOUD]);
-  }
-
-  /* bandwidth */
-  peaq_mov_bandwidth (peaq->ref_fft_ear_state,
-                      peaq->test_fft_ear_state, 
-                      peaq->mov_accum[MOVBASIC_BANDWIDTH_REF],
-                      peaq->mov_accum[MOVBASIC_BANDWIDTH_TEST]);
-
-  /* noise-to-mask ratio */
-  peaq_mov_nmr (PEAQ_FFTEARMODEL (peaq->fft_ear_model),
-                peaq->ref_fft_ear_state,
-                peaq->test_fft_ear_state,
-                peaq->mov_accum[MOVBASIC_TOTAL_NMR],
-                peaq->mov_accum[MOVBASIC_REL_DIST_FRAMES]);
-
-  /* probability of detection */
-  peaq_mov_prob_detect(peaq->fft_ear_model,
-                       peaq->ref_fft_ear_state,
-                       peaq->test_fft_ear_state,
-                       peaq->channels,
-                       peaq->mov_accum[MOVBASIC_ADB],
-                       peaq->mov_accum[MOVBASIC_MFPD]);
-
-  /* error harmonic structure */
-  peaq_mov_ehs (peaq->fft_ear_model, peaq->ref_fft_ear_state,
-                peaq->test_fft_ear_state, peaq->mov_accum[MOVBASIC_EHS]);
-
-  for (i = 0; i < channels * frame_size / 2; i++) {
-    peaq->total_signal_energy
-      += refdata[i] * refdata[i];
-    peaq->total_noise_energy 
-      += (refdata[i] - testdata[i]) * (refdata[i] - testdata[i]);
-  }
-
-  peaq->frame_counter++;
-}
-
-static void
-process_fft_block_advanced (GstPeaq *peaq, gfloat *refdata, gfloat *testdata)
-{
-  guint i;
-  gint channels = peaq->channels;
-
-  PeaqEarModel *ear_params = peaq->fft_ear_model;
-  guint frame_size = peaq_earmodel_get_frame_size (ear_params);
-
-  gboolean above_thres =
-    is_frame_above_threshold (refdata, frame_size, channels);
-
-  peaq_movaccum_set_tentative (peaq->mov_accum[MOVADV_SEGMENTAL_NMR],
-                               !above_thres);
-  peaq_movaccum_set_tentative (peaq->mov_accum[MOVADV_EHS], !above_thres);
-
-  apply_ear_model (peaq->fft_ear_model, channels, refdata,
-                   peaq->ref_fft_ear_state);
-  apply_ear_model (peaq->fft_ear_model, channels, testdata,
-                   peaq->test_fft_ear_state);
-
-  /* noise-to-mask ratio */
-  peaq_mov_nmr (PEAQ_FFTEARMODEL (peaq->fft_ear_model),
-                peaq->ref_fft_ear_state,
-                peaq->test_fft_ear_state,
-                peaq->mov_accum[MOVADV_SEGMENTAL_NMR],
-                NULL);
-
-  /* error harmonic structure */
-  peaq_mov_ehs (peaq->fft_ear_model, peaq->ref_fft_ear_state,
-                peaq->test_fft_ear_state, peaq->mov_accum[MOVADV_EHS]);
-
-  for (i = 0; i < channels * frame_size / 2; i++) {
-    peaq->total_signal_energy += refdata[i] * refdata[i];
-    peaq->total_noise_energy 
-      += (refdata[i] - testdata[i]) * (refdata[i] - testdata[i]);
-  }
-
-  peaq->frame_counter++;
-}
-
-static void
-process_fb_block (GstPeaq *peaq, gfloat *refdata, gfloat *testdata)
-{
-  gint channels = peaq->channels;
-  PeaqEarModel *ear_params = peaq->fb_ear_model;
-  guint frame_size = peaq_earmodel_get_frame_size (ear_params);
-
-  gboolean above_thres =
-    is_frame_above_threshold (refdata, frame_size, channels);
-
-  peaq_movaccum_set_tentative (peaq->mov_accum[MOVADV_RMS_MOD_DIFF],
-                               !above_thres);
-  peaq_movaccum_set_tentative (peaq->mov_accum[MOVADV_RMS_NOISE_LOUD_ASYM],
-                               !above_thres);
-  peaq_movaccum_set_tentative (peaq->mov_accum[MOVADV_AVG_LIN_DIST],
-                               !above_thres);
-
-  apply_ear_model_and_preprocess (peaq, peaq->fb_ear_model,
-                                  refdata, testdata,
-                                  peaq->ref_fb_ear_state,
-                                  peaq->test_fb_ear_state,
-                                  peaq->frame_counter_fb);
-
-  /* modulation difference */
-  if (peaq->frame_counter_fb >= 125) {
-    peaq_mov_modulation_difference (peaq->ref_modulation_processor,
-                                    peaq->test_modulation_processor,
-                                    peaq->mov_accum[MOVADV_RMS_MOD_DIFF],
-                                    NULL, NULL);
-  }
-
-  /* noise loudness */
-  if (peaq->frame_counter_fb >= 125 &&
-      peaq->frame_counter_fb - 13 >= peaq->loudness_reached_frame) {
-    peaq_mov_noise_loud_asym (peaq->ref_modulation_processor,
-                              peaq->test_modulation_processor,
-                              peaq->level_adapter,
-                              peaq->mov_accum[MOVADV_RMS_NOISE_LOUD_ASYM]);
-    peaq_mov_lin_dist (peaq->ref_modulation_processor,
-                       peaq->test_modulation_processor,
-                       peaq->level_adapter,
-                       peaq->ref_fb_ear_state,
-                       peaq->mov_accum[MOVADV_AVG_LIN_DIST]);
-  }
-
-  peaq->frame_counter_fb++;
-}
-
-static double
-calculate_di_basic (GstPeaq * peaq)
-{
-  guint i;
-  gdouble movs[11];
-  for (i = 0; i < COUNT_MOV_BASIC; i++)
-    movs[i] = peaq_movaccum_get_value (peaq->mov_accum[i]);
-
-  gdouble distortion_index = peaq_calculate_di_basic (movs);
-
-  if (peaq->console_output) {
+  gdouble const *movs = result->movs;
+  if (peaq->advanced) {
+    g_printf("RmsModDiffA = %f\n"
+             "RmsNoiseLoudAsymA = %f\n"
+             "SegmentalNMRB = %f\n"
+             "EHSB = %f\n"
+             "AvgLinDistA = %f\n",
+             movs[0],
+             movs[1],
+             movs[2],
+             movs[3],
+             movs[4]);
+  } else {
     g_printf ("   BandwidthRefB: %f\n"
               "  BandwidthTestB: %f\n"
               "      Total NMRB: %f\n"
@@ -1218,66 +1062,26 @@ calculate_di_basic (GstPeaq * peaq)
               movs[0], movs[1], movs[2], movs[3], movs[4], movs[5], movs[6],
               movs[7], movs[8], movs[9], movs[10]);
   }
-  return distortion_index;
 }
 
 static double
-calculate_di_advanced (GstPeaq *peaq)
+calculate_di (GstPeaq *peaq)
 {
-  guint i;
-  gdouble movs[5];
-  for (i = 0; i < COUNT_MOV_ADVANCED; i++)
-    movs[i] = peaq_movaccum_get_value (peaq->mov_accum[i]);
-
-  gdouble distortion_index = peaq_calculate_di_advanced (movs);
-
-  if (peaq->console_output) {
-    g_printf("RmsModDiffA = %f\n"
-             "RmsNoiseLoudAsymA = %f\n"
-             "SegmentalNMRB = %f\n"
-             "EHSB = %f\n"
-             "AvgLinDistA = %f\n",
-             movs[0],
-             movs[1],
-             movs[2],
-             movs[3],
-             movs[4]);
-  }
-  return distortion_index;
+  PeaqResult result;
+  peaq_engine_get_result (peaq->engine, &result);
+  if (peaq->console_output)
+    print_movs (peaq, &result);
+  return result.di;
 }
 
 static double
 calculate_odg (GstPeaq * peaq)
 {
-  gdouble distortion_index;
-  if (peaq->advanced)
-    distortion_index = calculate_di_advanced (peaq);
-  else
-    distortion_index = calculate_di_basic (peaq);
-  gdouble odg = peaq_calculate_odg (distortion_index);
+  PeaqResult result;
+  peaq_engine_get_result (peaq->engine, &result);
   if (peaq->console_output) {
-    g_printf ("Objective Difference Grade: %.3f\n", odg);
-  }
-  return odg;
-}
-
-static gboolean
-is_frame_above_threshold (gfloat *framedata, guint framesize, guint channels)
-{
-  gfloat sum;
-  guint i, c;
-
-  for (c = 0; c < channels; c++) {
-    sum = 0;
-    for (i = 0; i < 5; i++)
-      sum += fabs (framedata[channels * i + c]);
-    while (i < framesize) {
-      sum += fabs (framedata[channels * i + c]) -
-        fabs (framedata[channels * (i - 5) + c]);
-      if (sum >= 200. / 32768)
-        return TRUE;
-      i++;
-    }
+    print_movs (peaq, &result);
+    g_printf ("Objective Difference Grade: %.3f\n", result.odg);
   }
-  return FALSE;
+  return result.odg;
 }
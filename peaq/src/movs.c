@@ -1275,15 +1275,65 @@ peaq_mov_prob_detect (PeaqEarModel const *ear_model, const gpointer *ref_state,
                             binaural_detection_probability, 1.);
 }
 
+struct _PeaqMovEhsState
+{
+  GstFFTF64 *correlator_fft;
+  GstFFTF64 *correlator_inverse_fft;
+  GstFFTF64 *correlation_fft;
+  gdouble correlation_window[MAXLAG];
+};
+
+/**
+ * peaq_mov_ehs_state_new:
+ *
+ * Allocates the FFTs and the correlation window used by peaq_mov_ehs(). The
+ * FFTs carry their own scratch buffers, so every caller that may run
+ * concurrently with another needs its own state.
+ *
+ * Returns: The newly allocated state, to be freed with
+ * peaq_mov_ehs_state_free().
+ */
+PeaqMovEhsState *
+peaq_mov_ehs_state_new (void)
+{
+  guint i;
+  PeaqMovEhsState *ehs_state = g_new (PeaqMovEhsState, 1);
+
+  ehs_state->correlator_fft = gst_fft_f64_new (2 * MAXLAG, FALSE);
+  ehs_state->correlator_inverse_fft = gst_fft_f64_new (2 * MAXLAG, TRUE);
+  ehs_state->correlation_fft = gst_fft_f64_new (MAXLAG, FALSE);
+  /* centering the window of the correlation in the EHS computation at lag
+   * zero (as considered in [Kabal03] to be more reasonable) degrades
+   * conformance */
+  for (i = 0; i < MAXLAG; i++)
+#if defined(CENTER_EHS_CORRELATION_WINDOW) && CENTER_EHS_CORRELATION_WINDOW
+    ehs_state->correlation_window[i] = 0.81649658092773 *
+      (1 + cos (2 * M_PI * i / (2 * MAXLAG - 1))) / MAXLAG;
+#else
+    ehs_state->correlation_window[i] = 0.81649658092773 *
+      (1 - cos (2 * M_PI * i / (MAXLAG - 1))) / MAXLAG;
+#endif
+  return ehs_state;
+}
+
+/**
+ * peaq_mov_ehs_state_free:
+ * @ehs_state: The state to free.
+ *
+ * Frees a state allocated with peaq_mov_ehs_state_new().
+ */
+void
+peaq_mov_ehs_state_free (PeaqMovEhsState *ehs_state)
+{
+  gst_fft_f64_free (ehs_state->correlator_fft);
+  gst_fft_f64_free (ehs_state->correlator_inverse_fft);
+  gst_fft_f64_free (ehs_state->correlation_fft);
+  g_free (ehs_state);
+}
+
 static void
-do_xcorr(gdouble const* d, gdouble * c)
+do_xcorr(PeaqMovEhsState *ehs_state, gdouble const* d, gdouble * c)
 {
-  static GstFFTF64 *correlator_fft = NULL;
-  static GstFFTF64 *correlator_inverse_fft = NULL;
-  if (correlator_fft == NULL)
-    correlator_fft = gst_fft_f64_new (2 * MAXLAG, FALSE);
-  if (correlator_inverse_fft == NULL)
-    correlator_inverse_fft = gst_fft_f64_new (2 * MAXLAG, TRUE);
   /*
    * the follwing uses an equivalent computation in the frequency domain to
    * determine the correlation like function:
@@ -1298,9 +1348,9 @@ do_xcorr(gdouble const* d, gdouble * c)
   GstFFTF64Complex freqdata1[MAXLAG + 1];
   GstFFTF64Complex freqdata2[MAXLAG + 1];
   memcpy (timedata, d, 2 * MAXLAG * sizeof(gdouble));
-  gst_fft_f64_fft (correlator_fft, timedata, freqdata1);
+  gst_fft_f64_fft (ehs_state->correlator_fft, timedata, freqdata1);
   memset (timedata + MAXLAG, 0, MAXLAG * sizeof(gdouble));
-  gst_fft_f64_fft (correlator_fft, timedata, freqdata2);
+  gst_fft_f64_fft (ehs_state->correlator_fft, timedata, freqdata2);
   for (k = 0; k < MAXLAG + 1; k++) {
     /* multiply freqdata1 with the conjugate of freqdata2 */
     gdouble r = (freqdata1[k].r * freqdata2[k].r
@@ -1310,7 +1360,8 @@ do_xcorr(gdouble const* d, gdouble * c)
     freqdata1[k].r = r;
     freqdata1[k].i = i;
   }
-  gst_fft_f64_inverse_fft (correlator_inverse_fft, freqdata1, timedata);
+  gst_fft_f64_inverse_fft (ehs_state->correlator_inverse_fft, freqdata1,
+                           timedata);
   memcpy (c, timedata, MAXLAG * sizeof(gdouble));
 }
 
@@ -1320,6 +1371,8 @@ do_xcorr(gdouble const* d, gdouble * c)
  * @test_state belong.
  * @ref_state: Ear model states for the reference signal.
  * @test_state: Ear model states for the test signal.
+ * @ehs_state: FFTs and window from peaq_mov_ehs_state_new(), not shared with
+ * concurrent callers.
  * @mov_accum: Accumulator for the EHSB MOV.
  *
  * Calculates the error harmonic structure based model output variable as
@@ -1344,29 +1397,12 @@ do_xcorr(gdouble const* d, gdouble * c)
  */
 void
 peaq_mov_ehs (PeaqEarModel const *ear_model, gpointer *ref_state,
-              gpointer *test_state, PeaqMovAccum *mov_accum)
+              gpointer *test_state, PeaqMovEhsState *ehs_state,
+              PeaqMovAccum *mov_accum)
 {
   guint i;
   guint chan;
-
-  static GstFFTF64 *correlation_fft = NULL;
-  static gdouble *correlation_window = NULL;
-  if (correlation_fft == NULL)
-    correlation_fft = gst_fft_f64_new (MAXLAG, FALSE);
-  if (correlation_window == NULL) {
-    /* centering the window of the correlation in the EHS computation at lag
-     * zero (as considered in [Kabal03] to be more reasonable) degrades
-     * conformance */
-    correlation_window = g_new (gdouble, MAXLAG);
-    for (i = 0; i < MAXLAG; i++)
-#if defined(CENTER_EHS_CORRELATION_WINDOW) && CENTER_EHS_CORRELATION_WINDOW
-      correlation_window[i] = 0.81649658092773 *
-        (1 + cos (2 * M_PI * i / (2 * MAXLAG - 1))) / MAXLAG;
-#else
-    correlation_window[i] = 0.81649658092773 *
-      (1 - cos (2 * M_PI * i / (MAXLAG - 1))) / MAXLAG;
-#endif
-  }
+  gdouble const *correlation_window = ehs_state->correlation_window;
 
   gint channels = peaq_movaccum_get_channels(mov_accum);
 
@@ -1402,7 +1438,7 @@ peaq_mov_ehs (PeaqEarModel const *ear_model, gpointer *ref_state,
         d[i] = log (ftest / fref);
     }
 
-    do_xcorr(d, c);
+    do_xcorr(ehs_state, d, c);
 
     d0 = c[0];
     dk = d0;
@@ -1425,7 +1461,7 @@ peaq_mov_ehs (PeaqEarModel const *ear_model, gpointer *ref_state,
       dk += d[i + MAXLAG] * d[i + MAXLAG] - d[i] * d[i];
     }
 #endif
-    gst_fft_f64_fft (correlation_fft, c, c_fft);
+    gst_fft_f64_fft (ehs_state->correlation_fft, c, c_fft);
 #if !defined(EHS_SUBTRACT_DC_BEFORE_WINDOW) || !EHS_SUBTRACT_DC_BEFORE_WINDOW
     /* subtracting the average is equivalent to setting the DC component to
      * zero */
@@ -27,6 +27,8 @@
 #include "modpatt.h"
 #include "movaccum.h"
 
+typedef struct _PeaqMovEhsState PeaqMovEhsState;
+
 void peaq_mov_modulation_difference (PeaqModulationProcessor* const *ref_mod_proc,
                                      PeaqModulationProcessor* const *test_mod_proc,
                                      PeaqMovAccum *mov_accum1,
@@ -54,6 +56,9 @@ void peaq_mov_prob_detect (PeaqEarModel const *ear_model, const gpointer *ref_st
                            const gpointer *test_state, guint channels,
                            PeaqMovAccum *mov_accum_adb,
                            PeaqMovAccum *mov_accum_mfpd);
+PeaqMovEhsState *peaq_mov_ehs_state_new (void);
+void peaq_mov_ehs_state_free (PeaqMovEhsState *ehs_state);
 void peaq_mov_ehs (PeaqEarModel const *ear_model, gpointer *ref_state,
-                   gpointer *test_state, PeaqMovAccum *mov_accum);
+                   gpointer *test_state, PeaqMovEhsState *ehs_state,
+                   PeaqMovAccum *mov_accum);
 #endif
@@ -23,14 +23,25 @@
 #include <gst/gst.h>
 #include <glib/gprintf.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#include "peaqengine.h"
+#include "wavreader.h"
+
+/* frames read from both files and pushed to the engine at a time; has to be
+ * at least the frame size of the ear models for the tail of the longer file to
+ * reach the end of the final frame */
+#define CHUNK_FRAMES 4096
+
 static gchar **filenames;
 static gboolean advanced = FALSE;
 static gboolean print_version = FALSE;
+static gboolean direct = FALSE;
+static gchar *batch_filename = NULL;
 
 static GOptionEntry option_entries[] = {
   {"version", 0, 0, G_OPTION_ARG_NONE, &print_version, "print version information",
@@ -39,6 +50,11 @@ static GOptionEntry option_entries[] = {
     NULL},
   {"basic", 0, G_OPTION_FLAG_REVERSE, G_OPTION_ARG_NONE, &advanced,
     "use basic version (default)", NULL},
+  {"direct", 0, 0, G_OPTION_ARG_NONE, &direct,
+    "read the WAV files directly instead of using a GStreamer pipeline", NULL},
+  {"batch", 0, 0, G_OPTION_ARG_FILENAME, &batch_filename,
+    "process the pairs of REFFILE TESTFILE listed in FILE, one per line "
+    "(implies --direct)", "FILE"},
   {G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames, NULL,
    "REFFILE TESTFILE"},
   {NULL, 0, 0, G_OPTION_ARG_NONE, NULL, NULL, NULL}
@@ -83,6 +99,158 @@ new_pad (GstElement * element, GstPad * pad, gpointer data)
 }
 #endif
 
+/* The GStreamer option group initializes GStreamer when it is parsed, which
+ * is exactly the start-up cost the direct mode is meant to avoid, so the
+ * command line is checked for the direct mode beforehand. */
+static gboolean
+uses_pipeline (int argc, char *argv[])
+{
+  int i;
+  for (i = 1; i < argc && strcmp (argv[i], "--") != 0; i++)
+    if (strcmp (argv[i], "--direct") == 0 ||
+        strcmp (argv[i], "--batch") == 0 ||
+        strncmp (argv[i], "--batch=", 8) == 0)
+      return FALSE;
+  return TRUE;
+}
+
+static gboolean
+measure_direct (PeaqEngine **engine, gchar const *reffilename,
+                gchar const *testfilename, PeaqResult *result, GError **error)
+{
+  PeaqWavReader *ref_reader;
+  PeaqWavReader *test_reader;
+  guint channels;
+  guint64 common_frames;
+  guint64 done;
+  guint ref_count, test_count;
+  gfloat *ref_data;
+  gfloat *test_data;
+
+  ref_reader = peaq_wavreader_open (reffilename, error);
+  if (!ref_reader)
+    return FALSE;
+  test_reader = peaq_wavreader_open (testfilename, error);
+  if (!test_reader) {
+    peaq_wavreader_close (ref_reader);
+    return FALSE;
+  }
+  channels = peaq_wavreader_get_channels (ref_reader);
+  if (peaq_wavreader_get_channels (test_reader) != channels) {
+    g_set_error (error, PEAQ_WAVREADER_ERROR, PEAQ_WAVREADER_ERROR_FORMAT,
+                 "%s and %s differ in the number of channels",
+                 reffilename, testfilename);
+    peaq_wavreader_close (ref_reader);
+    peaq_wavreader_close (test_reader);
+    return FALSE;
+  }
+
+  /* the engine, and with it the ear model tables, is reused for all pairs
+   * with the same number of channels */
+  if (*engine && peaq_engine_get_channels (*engine) == channels) {
+    peaq_engine_reset (*engine);
+  } else {
+    if (*engine)
+      peaq_engine_free (*engine);
+    *engine = peaq_engine_new (advanced ? PEAQ_MODE_ADVANCED : PEAQ_MODE_BASIC,
+                               channels);
+  }
+
+  ref_data = g_new (gfloat, channels * CHUNK_FRAMES);
+  test_data = g_new (gfloat, channels * CHUNK_FRAMES);
+  common_frames = MIN (peaq_wavreader_get_frames (ref_reader),
+                       peaq_wavreader_get_frames (test_reader));
+  for (done = 0; done < common_frames; done += ref_count) {
+    ref_count = MIN (CHUNK_FRAMES, common_frames - done);
+    peaq_wavreader_read (ref_reader, ref_data, ref_count);
+    peaq_wavreader_read (test_reader, test_data, ref_count);
+    peaq_engine_push (*engine, ref_data, test_data, ref_count);
+  }
+  ref_count = peaq_wavreader_read (ref_reader, ref_data, CHUNK_FRAMES);
+  test_count = peaq_wavreader_read (test_reader, test_data, CHUNK_FRAMES);
+  peaq_engine_push_tail (*engine, ref_data, ref_count, test_data, test_count);
+  peaq_engine_finish (*engine, result);
+
+  g_free (ref_data);
+  g_free (test_data);
+  peaq_wavreader_close (ref_reader);
+  peaq_wavreader_close (test_reader);
+  return TRUE;
+}
+
+static int
+run_direct (gchar const *reffilename, gchar const *testfilename)
+{
+  PeaqEngine *engine = NULL;
+  PeaqResult result;
+  GError *error = NULL;
+
+  if (!measure_direct (&engine, reffilename, testfilename, &result, &error)) {
+    g_print ("Error: %s\n", error->message);
+    g_error_free (error);
+    return 1;
+  }
+  peaq_engine_free (engine);
+
+  g_printf ("Objective Difference Grade: %.3f\n", result.odg);
+  g_printf ("Distortion Index: %.3f\n", result.di);
+  return 0;
+}
+
+/* Each non-empty line of the batch file not starting with # names a
+ * reference and a test file, separated by white space. One line of
+ * tab-separated output is printed per pair. */
+static int
+run_batch (gchar const *filename)
+{
+  PeaqEngine *engine = NULL;
+  GError *error = NULL;
+  gchar *contents;
+  gchar **lines;
+  guint i;
+  int ret = 0;
+
+  if (!g_file_get_contents (filename, &contents, NULL, &error)) {
+    g_print ("Error: %s\n", error->message);
+    g_error_free (error);
+    return 1;
+  }
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  for (i = 0; lines[i]; i++) {
+    gchar *pair[3];
+    gchar **tokens;
+    guint j, count = 0;
+    PeaqResult result;
+
+    g_strstrip (lines[i]);
+    if (lines[i][0] == '\0' || lines[i][0] == '#')
+      continue;
+    tokens = g_strsplit_set (lines[i], " \t", -1);
+    for (j = 0; tokens[j]; j++)
+      if (tokens[j][0] != '\0' && count < 3)
+        pair[count++] = tokens[j];
+    if (count != 2) {
+      g_print ("Error: %s:%u: expected REFFILE TESTFILE\n", filename, i + 1);
+      ret = 1;
+    } else if (measure_direct (&engine, pair[0], pair[1], &result, &error)) {
+      g_printf ("%s\t%s\t%.3f\t%.3f\n", pair[0], pair[1], result.odg,
+                result.di);
+    } else {
+      g_printf ("%s\t%s\tError: %s\n", pair[0], pair[1], error->message);
+      g_clear_error (&error);
+      ret = 1;
+    }
+    g_strfreev (tokens);
+  }
+
+  g_strfreev (lines);
+  if (engine)
+    peaq_engine_free (engine);
+  return ret;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -109,7 +277,8 @@ main(int argc, char *argv[])
   g_option_group_add_entries (option_group, option_entries);
 
   g_option_context_set_main_group (context, option_group);
-  g_option_context_add_group (context, gst_init_get_option_group ());
+  if (uses_pipeline (argc, argv))
+    g_option_context_add_group (context, gst_init_get_option_group ());
   g_option_context_set_summary (context,
                                 "peaq computes the Objective Difference Grade based on ITU-R BS.1367-1 (but it\n"
                                 "does not meet its conformance requirements).");
@@ -132,8 +301,13 @@ main(int argc, char *argv[])
     return 0;
   }
 
-  if (filenames == NULL || filenames[0] == NULL || filenames[1] == NULL
-      || filenames[2] != NULL) {
+  if (batch_filename && filenames == NULL) {
+    g_option_context_free (context);
+    return run_batch (batch_filename);
+  }
+
+  if (batch_filename || filenames == NULL || filenames[0] == NULL
+      || filenames[1] == NULL || filenames[2] != NULL) {
     gchar *help = g_option_context_get_help (context, TRUE, NULL);
     puts (help);
     g_free (help);
@@ -144,6 +318,9 @@ main(int argc, char *argv[])
   reffilename = filenames[0];
   testfilename = filenames[1];
 
+  if (direct)
+    return run_direct (reffilename, testfilename);
+
   loop = g_main_loop_new (NULL, FALSE);
 
   pipeline = gst_pipeline_new ("pipeline");
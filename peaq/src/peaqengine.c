@@ -0,0 +1,1356 @@
+/* GstPEAQ
+ * Copyright (C) 2006, 2007, 2010, 2011, 2012, 2013, 2014, 2015
+ * Martin Holters <martin.holters@hsu-hh.de>
+ *
+ * peaqengine.c: Compute objective audio quality measures without GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:peaqengine
+ * @short_description: Objective audio quality measurement engine.
+ * @title: PeaqEngine
+ *
+ * A #PeaqEngine carries out the complete measurement of <xref
+ * linkend="BS1387" />, i.e. it runs the ear models, the pre-processing and the
+ * model output variable calculation and combines the latter into distortion
+ * index and objective difference grade. It does not depend on GStreamer, so
+ * it may be used directly wherever the reference and test signal are already
+ * available as interleaved floating point samples at 48 kHz.
+ *
+ * Both signals are fed with peaq_engine_push() in chunks of arbitrary size;
+ * the engine buffers them internally until a complete frame of the ear
+ * model(s) is available. Once the input is exhausted, peaq_engine_finish()
+ * processes the remaining partial frame and returns the #PeaqResult. To
+ * measure another pair with the same settings, call peaq_engine_reset(), which
+ * is considerably cheaper than creating a new engine.
+ *
+ * |[
+ * PeaqEngine *engine = peaq_engine_new (PEAQ_MODE_BASIC, 2);
+ * PeaqResult result;
+ * while ((n = read_frames (ref_file, test_file, ref, test)) > 0)
+ *   peaq_engine_push (engine, ref, test, n);
+ * peaq_engine_finish (engine, &result);
+ * peaq_engine_free (engine);
+ * ]|
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "peaqengine.h"
+#include "fbearmodel.h"
+#include "fftearmodel.h"
+#include "leveladapter.h"
+#include "modpatt.h"
+#include "movaccum.h"
+#include "movs.h"
+#include "nn.h"
+
+enum _MovAdvanced {
+  MOVADV_RMS_MOD_DIFF,
+  MOVADV_RMS_NOISE_LOUD_ASYM,
+  MOVADV_SEGMENTAL_NMR,
+  MOVADV_EHS,
+  MOVADV_AVG_LIN_DIST,
+  COUNT_MOV_ADVANCED
+};
+
+enum _MovBasic {
+  MOVBASIC_BANDWIDTH_REF,
+  MOVBASIC_BANDWIDTH_TEST,
+  MOVBASIC_TOTAL_NMR,
+  MOVBASIC_WIN_MOD_DIFF,
+  MOVBASIC_ADB,
+  MOVBASIC_EHS,
+  MOVBASIC_AVG_MOD_DIFF_1,
+  MOVBASIC_AVG_MOD_DIFF_2,
+  MOVBASIC_RMS_NOISE_LOUD,
+  MOVBASIC_MFPD,
+  MOVBASIC_REL_DIST_FRAMES,
+  COUNT_MOV_BASIC
+};
+
+static gchar const *mov_names_basic[COUNT_MOV_BASIC] = {
+  "BandwidthRefB",
+  "BandwidthTestB",
+  "Total NMRB",
+  "WinModDiff1B",
+  "ADBB",
+  "EHSB",
+  "AvgModDiff1B",
+  "AvgModDiff2B",
+  "RmsNoiseLoudB",
+  "MFPDB",
+  "RelDistFramesB"
+};
+
+static gchar const *mov_names_advanced[COUNT_MOV_ADVANCED] = {
+  "RmsModDiffA",
+  "RmsNoiseLoudAsymA",
+  "SegmentalNMRB",
+  "EHSB",
+  "AvgLinDistA"
+};
+
+/*
+ * Holds the samples of both signals from the earliest frame still needed by
+ * one of the ear models on. It is shared by the FFT and the filter bank ear
+ * model in advanced mode, so the input is stored only once. Positions are
+ * counted in frames from the start of the signals. Every channel is kept
+ * deinterleaved in a ring of size (a power of two) entries, each sample being
+ * written both at position & mask and size entries later. Any frame of up to
+ * size samples is therefore available contiguously at position & mask, so
+ * the ear models read it in place.
+ */
+typedef struct
+{
+  gfloat **ref_data;
+  gfloat **test_data;
+  guint channels;
+  guint size;
+  guint mask;
+  guint64 start;
+  guint64 end;
+} SampleStore;
+
+/*
+ * Reads the frames of one ear model from the #SampleStore. cursor is the
+ * position of the next frame, which is processed as soon as the store
+ * reaches cursor + frame_size, after which the cursor advances by step_size.
+ * ref_frame and test_frame receive the per-channel pointers to the frame being
+ * processed.
+ */
+typedef struct
+{
+  void (*process_block) (PeaqEngine *engine, gfloat const * const *refdata,
+                         gfloat const * const *testdata);
+  guint frame_size;
+  guint step_size;
+  guint64 cursor;
+  gfloat const **ref_frame;
+  gfloat const **test_frame;
+} FrameCursor;
+
+/*
+ * In advanced mode, the filter bank ear model runs on a thread of its own,
+ * concurrently with the FFT ear model on the calling thread. The two share
+ * nothing but the #SampleStore, each updating only its own states and model
+ * output variables. available is the end of the store as published to the
+ * worker; the filter bank cursor is only accessed with lock held, the worker
+ * publishing its progress after each batch of frames. The store is not
+ * written beyond what the filter bank cursor has released, so the worker
+ * reads its frames without holding the lock.
+ */
+typedef struct
+{
+  GThread *thread;
+  GMutex lock;
+  GCond cond;
+  guint64 available;
+  gboolean quit;
+} FilterBankWorker;
+
+/* lets the FFT ear model run ahead of the filter bank thread by about 0.7 s
+ * before waiting for it */
+#define WORKER_STORE_FRAMES 32768
+
+/*
+ * The ear model and modulation processor work of one frame, split into one
+ * unit per signal and channel. Each unit only touches its own ear model state
+ * and modulation processor, so the units are distributed round robin over
+ * lanes, lane 0 being the calling thread and each further lane a
+ * #SignalHelper. With two lanes, the reference signal is processed on the
+ * calling thread and the test signal on the helper; with more, the channels
+ * are spread as well. Level adapters, model output variables and their
+ * accumulators remain on the calling thread, so the results do not depend on
+ * the number of lanes.
+ */
+typedef struct
+{
+  PeaqEarModel *model;
+  guint channels;
+  guint lanes;
+  gfloat const * const *data[2];
+  gpointer *state[2];
+  PeaqModulationProcessor **modulation_processor[2];
+} EarModelJob;
+
+/*
+ * Runs one lane of the current #EarModelJob of its pool on a thread of its
+ * own. Frames are handed over one at a time by bumping posted, and completion
+ * is reported by setting done to the same value. Both sides spin for up to
+ * HELPER_SPIN polls before blocking on cond, announcing this by sleeping and
+ * waiting, respectively, so while frames keep coming, as within one push, a
+ * handover costs a few atomic operations and the sleep and wakeup are paid
+ * only once per batch.
+ */
+typedef struct
+{
+  GThread *thread;
+  GMutex lock;
+  GCond cond;
+  gint posted;
+  gint done;
+  gint sleeping;
+  gint waiting;
+  gboolean quit;
+  EarModelJob const *job;
+  guint lane;
+} SignalHelper;
+
+/* The helpers of one ear model path, i.e. job.lanes - 1 of them. */
+typedef struct
+{
+  EarModelJob job;
+  SignalHelper *helpers;
+} HelperPool;
+
+#define HELPER_SPIN 20000
+
+struct _PeaqEngine
+/**
+ * PeaqEngine:
+ *
+ * The opaque PeaqEngine structure.
+ */
+{
+  PeaqMode mode;
+  guint channels;
+  guint frame_counter;
+  guint frame_counter_fb;
+  guint loudness_reached_frame;
+  PeaqEarModel *fft_ear_model;
+  gpointer *ref_fft_ear_state;
+  gpointer *test_fft_ear_state;
+  PeaqEarModel *fb_ear_model;
+  gpointer *ref_fb_ear_state;
+  gpointer *test_fb_ear_state;
+  PeaqLevelAdapter **level_adapter;
+  PeaqModulationProcessor **ref_modulation_processor;
+  PeaqModulationProcessor **test_modulation_processor;
+  PeaqMovAccum *mov_accum[COUNT_MOV_BASIC];
+  PeaqMovEhsState *ehs_state;
+  gdouble total_signal_energy;
+  gdouble total_noise_energy;
+  SampleStore store;
+  FrameCursor fft_cursor;
+  FrameCursor fb_cursor;
+  FilterBankWorker worker;
+  HelperPool fft_pool;
+  HelperPool fb_pool;
+};
+
+static void alloc_state (PeaqEngine *engine);
+static void free_state (PeaqEngine *engine);
+static void store_init (SampleStore *store, guint channels, guint min_size);
+static void store_free (SampleStore *store);
+static void store_write (SampleStore *store, gfloat **data, guint channels,
+                         guint64 position, gfloat const *samples,
+                         guint nframes);
+static void cursor_init (FrameCursor *cursor, PeaqEarModel const *model,
+                         void (*process_block) (PeaqEngine *,
+                                                gfloat const * const *,
+                                                gfloat const * const *),
+                         gboolean overlap, guint channels);
+static void cursor_free (FrameCursor *cursor);
+static void cursor_process (PeaqEngine *engine, FrameCursor *cursor);
+static void cursor_flush (PeaqEngine *engine, FrameCursor *cursor,
+                          gfloat const *ref, guint ref_frames,
+                          gfloat const *test, guint test_frames);
+static void store_discard (PeaqEngine *engine);
+static void worker_start (PeaqEngine *engine);
+static void worker_stop (PeaqEngine *engine);
+static void worker_publish (PeaqEngine *engine);
+static void worker_drain (PeaqEngine *engine);
+static gpointer worker_thread (gpointer data);
+static guint pool_lanes (PeaqMode mode, guint channels);
+static void pool_start (HelperPool *pool, guint lanes);
+static void pool_stop (HelperPool *pool);
+static void pool_process (HelperPool *pool, PeaqEarModel *model,
+                          guint channels, gfloat const * const *refdata,
+                          gfloat const * const *testdata,
+                          gpointer *refstate, gpointer *teststate,
+                          PeaqModulationProcessor **ref_modulation_processor,
+                          PeaqModulationProcessor **test_modulation_processor);
+static void job_run (EarModelJob const *job, guint lane);
+static void helper_start (SignalHelper *helper);
+static void helper_stop (SignalHelper *helper);
+static void helper_post (SignalHelper *helper);
+static void helper_wait (SignalHelper *helper);
+static gpointer helper_thread (gpointer data);
+static void process_fft_block_basic (PeaqEngine *engine,
+                                     gfloat const * const *refdata,
+                                     gfloat const * const *testdata);
+static void process_fft_block_advanced (PeaqEngine *engine,
+                                        gfloat const * const *refdata,
+                                        gfloat const * const *testdata);
+static void process_fb_block (PeaqEngine *engine,
+                              gfloat const * const *refdata,
+                              gfloat const * const *testdata);
+static gboolean is_frame_above_threshold (gfloat const * const *framedata,
+                                          guint framesize, guint channels);
+
+/**
+ * peaq_engine_new:
+ * @mode: Whether to compute the basic or the advanced version.
+ * @channels: The number of interleaved channels of both input signals.
+ *
+ * Creates a new #PeaqEngine with the playback level set to the default of
+ * 92 dB SPL.
+ *
+ * Returns: The newly created #PeaqEngine, to be freed with
+ * peaq_engine_free().
+ */
+PeaqEngine *
+peaq_engine_new (PeaqMode mode, guint channels)
+{
+  PeaqEngine *engine = g_new0 (PeaqEngine, 1);
+
+  engine->mode = mode;
+  engine->channels = channels;
+  engine->fft_ear_model =
+    g_object_new (PEAQ_TYPE_FFTEARMODEL, "number-of-bands",
+                  mode == PEAQ_MODE_ADVANCED ? 55 : 109, NULL);
+  engine->fb_ear_model = g_object_new (PEAQ_TYPE_FILTERBANKEARMODEL, NULL);
+
+  cursor_init (&engine->fft_cursor, engine->fft_ear_model,
+               mode == PEAQ_MODE_ADVANCED ?
+               process_fft_block_advanced : process_fft_block_basic,
+               TRUE, channels);
+  if (mode == PEAQ_MODE_ADVANCED)
+    cursor_init (&engine->fb_cursor, engine->fb_ear_model,
+                 process_fb_block, FALSE, channels);
+
+  /* after processing, less than a frame remains behind each cursor, leaving
+   * room for at least another frame of input and for padding the last one */
+  store_init (&engine->store, channels,
+              mode == PEAQ_MODE_ADVANCED ? WORKER_STORE_FRAMES :
+              2 * engine->fft_cursor.frame_size);
+
+  alloc_state (engine);
+  pool_start (&engine->fft_pool, pool_lanes (mode, channels));
+  if (mode == PEAQ_MODE_ADVANCED) {
+    pool_start (&engine->fb_pool, pool_lanes (mode, channels));
+    worker_start (engine);
+  }
+
+  return engine;
+}
+
+/**
+ * peaq_engine_free:
+ * @engine: The #PeaqEngine to free.
+ *
+ * Frees the given #PeaqEngine and all associated resources.
+ */
+void
+peaq_engine_free (PeaqEngine *engine)
+{
+  if (engine->mode == PEAQ_MODE_ADVANCED) {
+    worker_stop (engine);
+    pool_stop (&engine->fb_pool);
+  }
+  pool_stop (&engine->fft_pool);
+  free_state (engine);
+  store_free (&engine->store);
+  cursor_free (&engine->fft_cursor);
+  cursor_free (&engine->fb_cursor);
+  g_object_unref (engine->fft_ear_model);
+  g_object_unref (engine->fb_ear_model);
+  g_free (engine);
+}
+
+/**
+ * peaq_engine_reset:
+ * @engine: The #PeaqEngine to reset.
+ *
+ * Discards all buffered samples and accumulated values so that the next call
+ * of peaq_engine_push() starts a new measurement. Mode, number of channels and
+ * playback level are retained, as are the ear models with their precomputed
+ * tables.
+ */
+void
+peaq_engine_reset (PeaqEngine *engine)
+{
+  if (engine->mode == PEAQ_MODE_ADVANCED)
+    worker_drain (engine);
+  free_state (engine);
+  alloc_state (engine);
+  engine->store.start = 0;
+  engine->store.end = 0;
+  engine->fft_cursor.cursor = 0;
+  if (engine->mode == PEAQ_MODE_ADVANCED) {
+    g_mutex_lock (&engine->worker.lock);
+    engine->fb_cursor.cursor = 0;
+    engine->worker.available = 0;
+    g_mutex_unlock (&engine->worker.lock);
+  }
+}
+
+/**
+ * peaq_engine_get_mode:
+ * @engine: The #PeaqEngine to query.
+ *
+ * Returns: The #PeaqMode the engine was created with.
+ */
+PeaqMode
+peaq_engine_get_mode (PeaqEngine const *engine)
+{
+  return engine->mode;
+}
+
+/**
+ * peaq_engine_get_channels:
+ * @engine: The #PeaqEngine to query.
+ *
+ * Returns: The number of channels the engine was created with.
+ */
+guint
+peaq_engine_get_channels (PeaqEngine const *engine)
+{
+  return engine->channels;
+}
+
+/**
+ * peaq_engine_set_playback_level:
+ * @engine: The #PeaqEngine to configure.
+ * @level: The playback level in dB SPL.
+ *
+ * Sets the playback level assumed by both ear models. This should be done
+ * before the first call of peaq_engine_push().
+ */
+void
+peaq_engine_set_playback_level (PeaqEngine *engine, gdouble level)
+{
+  g_object_set (engine->fft_ear_model, "playback-level", level, NULL);
+  g_object_set (engine->fb_ear_model, "playback-level", level, NULL);
+}
+
+/**
+ * peaq_engine_get_playback_level:
+ * @engine: The #PeaqEngine to query.
+ *
+ * Returns: The playback level in dB SPL.
+ */
+gdouble
+peaq_engine_get_playback_level (PeaqEngine const *engine)
+{
+  gdouble level;
+  g_object_get (engine->fft_ear_model, "playback-level", &level, NULL);
+  return level;
+}
+
+/**
+ * peaq_engine_push:
+ * @engine: The #PeaqEngine to feed.
+ * @ref: @nframes interleaved frames of the reference signal.
+ * @test: @nframes interleaved frames of the test signal.
+ * @nframes: The number of frames (samples per channel) in @ref and @test.
+ *
+ * Appends the given samples to both signals and processes all ear model
+ * frames thereby completed. In advanced mode, the filter bank ear model
+ * frames are processed concurrently on a separate thread and may still be
+ * pending on return.
+ */
+void
+peaq_engine_push (PeaqEngine *engine, gfloat const *ref, gfloat const *test,
+                  guint nframes)
+{
+  SampleStore *store = &engine->store;
+  guint channels = engine->channels;
+
+  while (nframes > 0) {
+    guint held = store->end - store->start;
+    guint count = MIN (nframes, store->size - held);
+    store_write (store, store->ref_data, channels, store->end, ref, count);
+    store_write (store, store->test_data, channels, store->end, test, count);
+    store->end += count;
+    ref += channels * count;
+    test += channels * count;
+    nframes -= count;
+
+    if (engine->mode == PEAQ_MODE_ADVANCED)
+      worker_publish (engine);
+    cursor_process (engine, &engine->fft_cursor);
+    store_discard (engine);
+  }
+}
+
+/**
+ * peaq_engine_push_tail:
+ * @engine: The #PeaqEngine to feed.
+ * @ref: @ref_frames interleaved frames of the reference signal.
+ * @ref_frames: The number of frames in @ref.
+ * @test: @test_frames interleaved frames of the test signal.
+ * @test_frames: The number of frames in @test.
+ *
+ * Processes the final, zero-padded frame where the two signals differ in
+ * length. Everything up to the end of the shorter signal has to be passed to
+ * peaq_engine_push() before; the remainder of the longer one is passed here,
+ * with the respective count of the shorter being zero. Only as much of it is
+ * used as reaches into the final frame of each ear model. After this,
+ * peaq_engine_finish() has nothing left to process.
+ */
+void
+peaq_engine_push_tail (PeaqEngine *engine,
+                       gfloat const *ref, guint ref_frames,
+                       gfloat const *test, guint test_frames)
+{
+  /* the padding of the final frames is written past store->end, where the
+   * ring still holds frames the worker may be reading, so it has to be done
+   * with them first */
+  if (engine->mode == PEAQ_MODE_ADVANCED)
+    worker_drain (engine);
+  cursor_flush (engine, &engine->fft_cursor, ref, ref_frames, test,
+                test_frames);
+  if (engine->mode == PEAQ_MODE_ADVANCED) {
+    /* the worker is idle after draining, but still evaluates its wait
+     * condition on spurious wakeups, hence the lock */
+    g_mutex_lock (&engine->worker.lock);
+    cursor_flush (engine, &engine->fb_cursor, ref, ref_frames, test,
+                  test_frames);
+    engine->worker.available = engine->store.end;
+    g_mutex_unlock (&engine->worker.lock);
+  }
+  engine->store.start = engine->store.end;
+}
+
+/**
+ * peaq_engine_finish:
+ * @engine: The #PeaqEngine to finish.
+ * @result: Location to store the #PeaqResult, or %NULL.
+ *
+ * Processes the samples still buffered as a final frame, padded with zeros,
+ * and computes the result. No further samples may be pushed afterwards until
+ * peaq_engine_reset() has been called.
+ *
+ * Returns: The objective difference grade.
+ */
+gdouble
+peaq_engine_finish (PeaqEngine *engine, PeaqResult *result)
+{
+  PeaqResult final;
+
+  peaq_engine_push_tail (engine, NULL, 0, NULL, 0);
+  if (!result)
+    result = &final;
+  peaq_engine_get_result (engine, result);
+  return result->odg;
+}
+
+/**
+ * peaq_engine_get_result:
+ * @engine: The #PeaqEngine to query.
+ * @result: Location to store the #PeaqResult.
+ *
+ * Computes the result from the frames processed so far, without processing
+ * any buffered samples. In advanced mode, this waits for the filter bank
+ * thread to process all frames pushed before.
+ */
+void
+peaq_engine_get_result (PeaqEngine *engine, PeaqResult *result)
+{
+  guint i;
+
+  if (engine->mode == PEAQ_MODE_ADVANCED)
+    worker_drain (engine);
+
+  if (engine->mode == PEAQ_MODE_ADVANCED) {
+    result->mov_count = COUNT_MOV_ADVANCED;
+    for (i = 0; i < COUNT_MOV_ADVANCED; i++)
+      result->movs[i] = peaq_movaccum_get_value (engine->mov_accum[i]);
+    result->di = peaq_calculate_di_advanced (result->movs);
+  } else {
+    result->mov_count = COUNT_MOV_BASIC;
+    for (i = 0; i < COUNT_MOV_BASIC; i++)
+      result->movs[i] = peaq_movaccum_get_value (engine->mov_accum[i]);
+    result->di = peaq_calculate_di_basic (result->movs);
+  }
+  result->odg = peaq_calculate_odg (result->di);
+  result->total_snr =
+    10 * log10 (engine->total_signal_energy / engine->total_noise_energy);
+}
+
+/**
+ * peaq_engine_get_mov_name:
+ * @mode: The #PeaqMode the model output variable belongs to.
+ * @index: The index into #PeaqResult.movs.
+ *
+ * Returns: The name of the model output variable as used in <xref
+ * linkend="BS1387" />, or %NULL if @index is out of range.
+ */
+gchar const *
+peaq_engine_get_mov_name (PeaqMode mode, guint index)
+{
+  if (mode == PEAQ_MODE_ADVANCED)
+    return index < COUNT_MOV_ADVANCED ? mov_names_advanced[index] : NULL;
+  return index < COUNT_MOV_BASIC ? mov_names_basic[index] : NULL;
+}
+
+static void
+alloc_state (PeaqEngine *engine)
+{
+  guint c, i;
+
+  engine->frame_counter = 0;
+  engine->frame_counter_fb = 0;
+  engine->loudness_reached_frame = G_MAXUINT;
+  engine->total_signal_energy = 0.;
+  engine->total_noise_energy = 0.;
+
+  for (i = 0; i < COUNT_MOV_BASIC; i++)
+    engine->mov_accum[i] = peaq_movaccum_new ();
+  if (engine->mode == PEAQ_MODE_ADVANCED) {
+    peaq_movaccum_set_mode (engine->mov_accum[MOVADV_RMS_MOD_DIFF], MODE_RMS);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVADV_SEGMENTAL_NMR], MODE_AVG);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVADV_EHS], MODE_AVG);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVADV_AVG_LIN_DIST], MODE_AVG);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVADV_RMS_NOISE_LOUD_ASYM],
+                            MODE_RMS_ASYM);
+  } else {
+    peaq_movaccum_set_mode (engine->mov_accum[MOVBASIC_BANDWIDTH_REF],
+                            MODE_AVG);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVBASIC_BANDWIDTH_TEST],
+                            MODE_AVG);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVBASIC_TOTAL_NMR],
+                            MODE_AVG_LOG);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVBASIC_WIN_MOD_DIFF],
+                            MODE_AVG_WINDOW);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVBASIC_ADB], MODE_ADB);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVBASIC_EHS], MODE_AVG);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVBASIC_AVG_MOD_DIFF_1],
+                            MODE_AVG);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVBASIC_AVG_MOD_DIFF_2],
+                            MODE_AVG);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVBASIC_RMS_NOISE_LOUD],
+                            MODE_RMS);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVBASIC_MFPD],
+                            MODE_FILTERED_MAX);
+    peaq_movaccum_set_mode (engine->mov_accum[MOVBASIC_REL_DIST_FRAMES],
+                            MODE_AVG);
+  }
+  for (i = 0; i < COUNT_MOV_BASIC; i++)
+    if (engine->mode == PEAQ_MODE_BASIC &&
+        (i == MOVBASIC_ADB || i == MOVBASIC_MFPD))
+      peaq_movaccum_set_channels (engine->mov_accum[i], 1);
+    else
+      peaq_movaccum_set_channels (engine->mov_accum[i], engine->channels);
+
+  engine->ehs_state = peaq_mov_ehs_state_new ();
+  engine->ref_fft_ear_state = g_new (gpointer, engine->channels);
+  engine->test_fft_ear_state = g_new (gpointer, engine->channels);
+  engine->level_adapter = g_new (PeaqLevelAdapter *, engine->channels);
+  engine->ref_modulation_processor =
+    g_new (PeaqModulationProcessor *, engine->channels);
+  engine->test_modulation_processor =
+    g_new (PeaqModulationProcessor *, engine->channels);
+  for (c = 0; c < engine->channels; c++) {
+    engine->ref_fft_ear_state[c] =
+      peaq_earmodel_state_alloc (engine->fft_ear_model);
+    engine->test_fft_ear_state[c] =
+      peaq_earmodel_state_alloc (engine->fft_ear_model);
+    engine->level_adapter[c] = peaq_leveladapter_new (engine->fft_ear_model);
+    engine->ref_modulation_processor[c] =
+      peaq_modulationprocessor_new (engine->fft_ear_model);
+    engine->test_modulation_processor[c] =
+      peaq_modulationprocessor_new (engine->fft_ear_model);
+  }
+  if (engine->mode == PEAQ_MODE_ADVANCED) {
+    engine->ref_fb_ear_state = g_new (gpointer, engine->channels);
+    engine->test_fb_ear_state = g_new (gpointer, engine->channels);
+    for (c = 0; c < engine->channels; c++) {
+      engine->ref_fb_ear_state[c] =
+        peaq_earmodel_state_alloc (engine->fb_ear_model);
+      engine->test_fb_ear_state[c] =
+        peaq_earmodel_state_alloc (engine->fb_ear_model);
+      peaq_leveladapter_set_ear_model (engine->level_adapter[c],
+                                       engine->fb_ear_model);
+      peaq_modulationprocessor_set_ear_model
+        (engine->ref_modulation_processor[c], engine->fb_ear_model);
+      peaq_modulationprocessor_set_ear_model
+        (engine->test_modulation_processor[c], engine->fb_ear_model);
+    }
+  }
+}
+
+static void
+free_state (PeaqEngine *engine)
+{
+  guint c, i;
+
+  for (c = 0; c < engine->channels; c++) {
+    peaq_earmodel_state_free (engine->fft_ear_model,
+                              engine->ref_fft_ear_state[c]);
+    peaq_earmodel_state_free (engine->fft_ear_model,
+                              engine->test_fft_ear_state[c]);
+    g_object_unref (engine->level_adapter[c]);
+    g_object_unref (engine->ref_modulation_processor[c]);
+    g_object_unref (engine->test_modulation_processor[c]);
+  }
+  g_free (engine->ref_fft_ear_state);
+  g_free (engine->test_fft_ear_state);
+  g_free (engine->level_adapter);
+  g_free (engine->ref_modulation_processor);
+  g_free (engine->test_modulation_processor);
+  if (engine->mode == PEAQ_MODE_ADVANCED) {
+    for (c = 0; c < engine->channels; c++) {
+      peaq_earmodel_state_free (engine->fb_ear_model,
+                                engine->ref_fb_ear_state[c]);
+      peaq_earmodel_state_free (engine->fb_ear_model,
+                                engine->test_fb_ear_state[c]);
+    }
+    g_free (engine->ref_fb_ear_state);
+    g_free (engine->test_fb_ear_state);
+  }
+  for (i = 0; i < COUNT_MOV_BASIC; i++)
+    g_object_unref (engine->mov_accum[i]);
+  peaq_mov_ehs_state_free (engine->ehs_state);
+}
+
+static void
+store_init (SampleStore *store, guint channels, guint min_size)
+{
+  guint c;
+
+  store->size = 1;
+  while (store->size < min_size)
+    store->size <<= 1;
+  store->mask = store->size - 1;
+  store->channels = channels;
+  store->ref_data = g_new (gfloat *, channels);
+  store->test_data = g_new (gfloat *, channels);
+  for (c = 0; c < channels; c++) {
+    store->ref_data[c] = g_new (gfloat, 2 * store->size);
+    store->test_data[c] = g_new (gfloat, 2 * store->size);
+  }
+  store->start = 0;
+  store->end = 0;
+}
+
+static void
+store_free (SampleStore *store)
+{
+  guint c;
+
+  for (c = 0; store->ref_data && c < store->channels; c++) {
+    g_free (store->ref_data[c]);
+    g_free (store->test_data[c]);
+  }
+  g_free (store->ref_data);
+  g_free (store->test_data);
+}
+
+/* Deinterleaves nframes frames into the rings from the given position on;
+ * samples may be NULL to write silence. */
+static void
+store_write (SampleStore *store, gfloat **data, guint channels,
+             guint64 position, gfloat const *samples, guint nframes)
+{
+  guint c, i;
+
+  for (c = 0; c < channels; c++) {
+    gfloat *ring = data[c];
+    for (i = 0; i < nframes; i++) {
+      guint index = (position + i) & store->mask;
+      gfloat value = samples ? samples[channels * i + c] : 0.f;
+      ring[index] = value;
+      ring[index + store->size] = value;
+    }
+  }
+}
+
+static void
+cursor_init (FrameCursor *cursor, PeaqEarModel const *model,
+             void (*process_block) (PeaqEngine *, gfloat const * const *,
+                                    gfloat const * const *),
+             gboolean overlap, guint channels)
+{
+  cursor->process_block = process_block;
+  cursor->frame_size = peaq_earmodel_get_frame_size (model);
+  cursor->step_size =
+    overlap ? peaq_earmodel_get_step_size (model) : cursor->frame_size;
+  cursor->cursor = 0;
+  cursor->ref_frame = g_new (gfloat const *, channels);
+  cursor->test_frame = g_new (gfloat const *, channels);
+}
+
+static void
+cursor_free (FrameCursor *cursor)
+{
+  g_free (cursor->ref_frame);
+  g_free (cursor->test_frame);
+}
+
+static void
+cursor_process_frame (PeaqEngine *engine, FrameCursor *cursor,
+                      guint64 position)
+{
+  SampleStore *store = &engine->store;
+  guint offset = position & store->mask;
+  guint c;
+
+  for (c = 0; c < engine->channels; c++) {
+    cursor->ref_frame[c] = store->ref_data[c] + offset;
+    cursor->test_frame[c] = store->test_data[c] + offset;
+  }
+  cursor->process_block (engine, cursor->ref_frame, cursor->test_frame);
+}
+
+/* Processes the frames from position on that are completed up to end,
+ * returning the position of the next frame without updating the cursor. */
+static guint64
+cursor_process_range (PeaqEngine *engine, FrameCursor *cursor,
+                      guint64 position, guint64 end)
+{
+  while (end - position >= cursor->frame_size) {
+    cursor_process_frame (engine, cursor, position);
+    position += cursor->step_size;
+  }
+  return position;
+}
+
+static void
+cursor_process (PeaqEngine *engine, FrameCursor *cursor)
+{
+  cursor->cursor = cursor_process_range (engine, cursor, cursor->cursor,
+                                         engine->store.end);
+}
+
+/* The final frame is padded in the otherwise unused part of the rings behind
+ * the end of the store, so the frames held there are left intact for the
+ * other ear model, which pads its final frame in the same place afterwards. */
+static void
+cursor_flush (PeaqEngine *engine, FrameCursor *cursor,
+              gfloat const *ref, guint ref_frames,
+              gfloat const *test, guint test_frames)
+{
+  SampleStore *store = &engine->store;
+  guint held = store->end - cursor->cursor;
+  if (held || ref_frames || test_frames) {
+    guint channels = engine->channels;
+    guint missing = cursor->frame_size - held;
+    guint ref_count = MIN (ref_frames, missing);
+    guint test_count = MIN (test_frames, missing);
+    store_write (store, store->ref_data, channels, store->end, ref,
+                 ref_count);
+    store_write (store, store->ref_data, channels, store->end + ref_count,
+                 NULL, missing - ref_count);
+    store_write (store, store->test_data, channels, store->end, test,
+                 test_count);
+    store_write (store, store->test_data, channels, store->end + test_count,
+                 NULL, missing - test_count);
+    cursor_process_frame (engine, cursor, cursor->cursor);
+    cursor->cursor = store->end;
+  }
+}
+
+/* Releases the frames all ear models are done with. If that leaves the store
+ * full, waits for the filter bank thread to catch up. */
+static void
+store_discard (PeaqEngine *engine)
+{
+  SampleStore *store = &engine->store;
+  guint64 start = engine->fft_cursor.cursor;
+
+  if (engine->mode == PEAQ_MODE_ADVANCED) {
+    FilterBankWorker *worker = &engine->worker;
+    g_mutex_lock (&worker->lock);
+    while (store->end - MIN (start, engine->fb_cursor.cursor) >= store->size)
+      g_cond_wait (&worker->cond, &worker->lock);
+    start = MIN (start, engine->fb_cursor.cursor);
+    g_mutex_unlock (&worker->lock);
+  }
+  store->start = start;
+}
+
+static void
+worker_start (PeaqEngine *engine)
+{
+  FilterBankWorker *worker = &engine->worker;
+
+  g_mutex_init (&worker->lock);
+  g_cond_init (&worker->cond);
+  worker->available = 0;
+  worker->quit = FALSE;
+  worker->thread = g_thread_new ("peaq-filterbank", worker_thread, engine);
+}
+
+static void
+worker_stop (PeaqEngine *engine)
+{
+  FilterBankWorker *worker = &engine->worker;
+
+  g_mutex_lock (&worker->lock);
+  worker->quit = TRUE;
+  g_cond_broadcast (&worker->cond);
+  g_mutex_unlock (&worker->lock);
+  g_thread_join (worker->thread);
+  g_mutex_clear (&worker->lock);
+  g_cond_clear (&worker->cond);
+}
+
+/* Hands the samples written to the store so far to the filter bank thread. */
+static void
+worker_publish (PeaqEngine *engine)
+{
+  FilterBankWorker *worker = &engine->worker;
+
+  g_mutex_lock (&worker->lock);
+  worker->available = engine->store.end;
+  g_cond_broadcast (&worker->cond);
+  g_mutex_unlock (&worker->lock);
+}
+
+/* Waits until the filter bank thread has processed all complete frames
+ * published to it. */
+static void
+worker_drain (PeaqEngine *engine)
+{
+  FilterBankWorker *worker = &engine->worker;
+  FrameCursor *cursor = &engine->fb_cursor;
+
+  g_mutex_lock (&worker->lock);
+  while (worker->available - cursor->cursor >= cursor->frame_size)
+    g_cond_wait (&worker->cond, &worker->lock);
+  g_mutex_unlock (&worker->lock);
+}
+
+static gpointer
+worker_thread (gpointer data)
+{
+  PeaqEngine *engine = data;
+  FilterBankWorker *worker = &engine->worker;
+  FrameCursor *cursor = &engine->fb_cursor;
+
+  g_mutex_lock (&worker->lock);
+  for (;;) {
+    guint64 end;
+    guint64 position;
+    while (!worker->quit &&
+           worker->available - cursor->cursor < cursor->frame_size)
+      g_cond_wait (&worker->cond, &worker->lock);
+    if (worker->quit)
+      break;
+    position = cursor->cursor;
+    end = worker->available;
+    g_mutex_unlock (&worker->lock);
+    position = cursor_process_range (engine, cursor, position, end);
+    g_mutex_lock (&worker->lock);
+    cursor->cursor = position;
+    g_cond_broadcast (&worker->cond);
+  }
+  g_mutex_unlock (&worker->lock);
+  return NULL;
+}
+
+/* One lane per signal and channel, but no more than the processors available
+ * to each ear model path, except that reference and test signal are always
+ * processed concurrently. */
+static guint
+pool_lanes (PeaqMode mode, guint channels)
+{
+  guint paths = mode == PEAQ_MODE_ADVANCED ? 2 : 1;
+  guint lanes = MIN (2 * channels, g_get_num_processors () / paths);
+  return MAX (lanes, 2);
+}
+
+static void
+pool_start (HelperPool *pool, guint lanes)
+{
+  guint i;
+
+  pool->job.lanes = lanes;
+  pool->helpers = g_new (SignalHelper, lanes - 1);
+  for (i = 0; i < lanes - 1; i++) {
+    pool->helpers[i].job = &pool->job;
+    pool->helpers[i].lane = i + 1;
+    helper_start (&pool->helpers[i]);
+  }
+}
+
+static void
+pool_stop (HelperPool *pool)
+{
+  guint i;
+
+  for (i = 0; i < pool->job.lanes - 1; i++)
+    helper_stop (&pool->helpers[i]);
+  g_free (pool->helpers);
+}
+
+/* Processes one frame of both signals with the ear model and, unless NULL,
+ * the modulation processors, using all lanes of the pool. */
+static void
+pool_process (HelperPool *pool, PeaqEarModel *model, guint channels,
+              gfloat const * const *refdata, gfloat const * const *testdata,
+              gpointer *refstate, gpointer *teststate,
+              PeaqModulationProcessor **ref_modulation_processor,
+              PeaqModulationProcessor **test_modulation_processor)
+{
+  EarModelJob *job = &pool->job;
+  guint i;
+
+  job->model = model;
+  job->channels = channels;
+  job->data[0] = refdata;
+  job->data[1] = testdata;
+  job->state[0] = refstate;
+  job->state[1] = teststate;
+  job->modulation_processor[0] = ref_modulation_processor;
+  job->modulation_processor[1] = test_modulation_processor;
+  for (i = 0; i < job->lanes - 1; i++)
+    helper_post (&pool->helpers[i]);
+  job_run (job, 0);
+  for (i = 0; i < job->lanes - 1; i++)
+    helper_wait (&pool->helpers[i]);
+}
+
+static void
+job_run (EarModelJob const *job, guint lane)
+{
+  guint unit;
+
+  for (unit = lane; unit < 2 * job->channels; unit += job->lanes) {
+    guint s = unit % 2;
+    guint c = unit / 2;
+    peaq_earmodel_process_block (job->model, job->state[s][c],
+                                 job->data[s][c]);
+    if (job->modulation_processor[s])
+      peaq_modulationprocessor_process (job->modulation_processor[s][c],
+                                        peaq_earmodel_get_unsmeared_excitation
+                                        (job->model, job->state[s][c]));
+  }
+}
+
+static void
+helper_start (SignalHelper *helper)
+{
+  g_mutex_init (&helper->lock);
+  g_cond_init (&helper->cond);
+  helper->posted = 0;
+  helper->done = 0;
+  helper->sleeping = FALSE;
+  helper->waiting = FALSE;
+  helper->quit = FALSE;
+  helper->thread = g_thread_new ("peaq-lane", helper_thread, helper);
+}
+
+static void
+helper_stop (SignalHelper *helper)
+{
+  g_mutex_lock (&helper->lock);
+  helper->quit = TRUE;
+  g_cond_broadcast (&helper->cond);
+  g_mutex_unlock (&helper->lock);
+  g_thread_join (helper->thread);
+  g_mutex_clear (&helper->lock);
+  g_cond_clear (&helper->cond);
+}
+
+/* Hands the current job to the helper; the previous one must have been waited
+ * for. The atomic operations are full barriers, so whichever side blocks
+ * last is guaranteed to see the other's update of posted or done and is
+ * woken otherwise. */
+static void
+helper_post (SignalHelper *helper)
+{
+  g_atomic_int_set (&helper->posted, helper->posted + 1);
+  if (g_atomic_int_get (&helper->sleeping)) {
+    g_mutex_lock (&helper->lock);
+    g_cond_broadcast (&helper->cond);
+    g_mutex_unlock (&helper->lock);
+  }
+}
+
+static void
+helper_wait (SignalHelper *helper)
+{
+  guint spin;
+
+  for (spin = 0; spin < HELPER_SPIN; spin++)
+    if (g_atomic_int_get (&helper->done) == helper->posted)
+      return;
+  g_mutex_lock (&helper->lock);
+  g_atomic_int_set (&helper->waiting, TRUE);
+  while (g_atomic_int_get (&helper->done) != helper->posted)
+    g_cond_wait (&helper->cond, &helper->lock);
+  g_atomic_int_set (&helper->waiting, FALSE);
+  g_mutex_unlock (&helper->lock);
+}
+
+static gpointer
+helper_thread (gpointer data)
+{
+  SignalHelper *helper = data;
+  gint seen = 0;
+
+  for (;;) {
+    guint spin;
+    for (spin = 0; spin < HELPER_SPIN; spin++)
+      if (g_atomic_int_get (&helper->posted) != seen)
+        break;
+    if (spin == HELPER_SPIN) {
+      gboolean quit;
+      g_mutex_lock (&helper->lock);
+      g_atomic_int_set (&helper->sleeping, TRUE);
+      while (!helper->quit && g_atomic_int_get (&helper->posted) == seen)
+        g_cond_wait (&helper->cond, &helper->lock);
+      g_atomic_int_set (&helper->sleeping, FALSE);
+      quit = helper->quit;
+      g_mutex_unlock (&helper->lock);
+      if (quit)
+        break;
+    }
+    seen = g_atomic_int_get (&helper->posted);
+
+    job_run (helper->job, helper->lane);
+
+    g_atomic_int_set (&helper->done, seen);
+    if (g_atomic_int_get (&helper->waiting)) {
+      g_mutex_lock (&helper->lock);
+      g_cond_broadcast (&helper->cond);
+      g_mutex_unlock (&helper->lock);
+    }
+  }
+  return NULL;
+}
+
+static void
+apply_ear_model_and_preprocess (PeaqEngine *engine, HelperPool *pool,
+                                PeaqEarModel *model,
+                                gfloat const * const *refdata,
+                                gfloat const * const *testdata,
+                                gpointer *refstate, gpointer *teststate,
+                                guint frame_counter)
+{
+  guint c;
+  guint channels = engine->channels;
+  pool_process (pool, model, channels, refdata, testdata, refstate,
+                teststate, engine->ref_modulation_processor,
+                engine->test_modulation_processor);
+  for (c = 0; c < channels; c++) {
+    gdouble const *ref_excitation =
+      peaq_earmodel_get_excitation (model, refstate[c]);
+    gdouble const *test_excitation =
+      peaq_earmodel_get_excitation (model, teststate[c]);
+
+    peaq_leveladapter_process (engine->level_adapter[c],
+                               ref_excitation, test_excitation);
+
+    if (engine->loudness_reached_frame == G_MAXUINT) {
+      if (peaq_earmodel_calc_loudness (model, refstate[c]) > 0.1 &&
+          peaq_earmodel_calc_loudness (model, teststate[c]) > 0.1)
+        engine->loudness_reached_frame = frame_counter;
+    }
+  }
+}
+
+static void
+process_fft_block_basic (PeaqEngine *engine, gfloat const * const *refdata,
+                         gfloat const * const *testdata)
+{
+  guint i, c;
+  guint channels = engine->channels;
+
+  PeaqEarModel *ear_params = engine->fft_ear_model;
+  guint frame_size = peaq_earmodel_get_frame_size (ear_params);
+
+  gboolean above_thres =
+    is_frame_above_threshold (refdata, frame_size, channels);
+
+  for (i = 0; i < COUNT_MOV_BASIC; i++)
+    peaq_movaccum_set_tentative (engine->mov_accum[i], !above_thres);
+
+  apply_ear_model_and_preprocess (engine, &engine->fft_pool,
+                                  engine->fft_ear_model,
+                                  refdata, testdata,
+                                  engine->ref_fft_ear_state,
+                                  engine->test_fft_ear_state,
+                                  engine->frame_counter);
+
+  /* modulation difference */
+  if (engine->frame_counter >= 24) {
+    peaq_mov_modulation_difference (engine->ref_modulation_processor,
+                                    engine->test_modulation_processor,
+                                    engine->mov_accum[MOVBASIC_AVG_MOD_DIFF_1],
+                                    engine->mov_accum[MOVBASIC_AVG_MOD_DIFF_2],
+                                    engine->mov_accum[MOVBASIC_WIN_MOD_DIFF]);
+  }
+
+  /* noise loudness */
+  if (engine->frame_counter >= 24 &&
+      engine->frame_counter - 3 >= engine->loudness_reached_frame) {
+    peaq_mov_noise_loudness (engine->ref_modulation_processor,
+                             engine->test_modulation_processor,
+                             engine->level_adapter,
+                             engine->mov_accum[MOVBASIC_RMS_NOISE_LOUD]);
+  }
+
+  /* bandwidth */
+  peaq_mov_bandwidth (engine->ref_fft_ear_state,
+                      engine->test_fft_ear_state,
+                      engine->mov_accum[MOVBASIC_BANDWIDTH_REF],
+                      engine->mov_accum[MOVBASIC_BANDWIDTH_TEST]);
+
+  /* noise-to-mask ratio */
+  peaq_mov_nmr (PEAQ_FFTEARMODEL (engine->fft_ear_model),
+                engine->ref_fft_ear_state,
+                engine->test_fft_ear_state,
+                engine->mov_accum[MOVBASIC_TOTAL_NMR],
+                engine->mov_accum[MOVBASIC_REL_DIST_FRAMES]);
+
+  /* probability of detection */
+  peaq_mov_prob_detect(engine->fft_ear_model,
+                       engine->ref_fft_ear_state,
+                       engine->test_fft_ear_state,
+                       engine->channels,
+                       engine->mov_accum[MOVBASIC_ADB],
+                       engine->mov_accum[MOVBASIC_MFPD]);
+
+  /* error harmonic structure */
+  peaq_mov_ehs (engine->fft_ear_model, engine->ref_fft_ear_state,
+                engine->test_fft_ear_state, engine->ehs_state,
+                engine->mov_accum[MOVBASIC_EHS]);
+
+  for (i = 0; i < frame_size / 2; i++) {
+    for (c = 0; c < channels; c++) {
+      engine->total_signal_energy
+        += refdata[c][i] * refdata[c][i];
+      engine->total_noise_energy
+        += (refdata[c][i] - testdata[c][i]) * (refdata[c][i] - testdata[c][i]);
+    }
+  }
+
+  engine->frame_counter++;
+}
+
+static void
+process_fft_block_advanced (PeaqEngine *engine,
+                            gfloat const * const *refdata,
+                            gfloat const * const *testdata)
+{
+  guint i, c;
+  guint channels = engine->channels;
+
+  PeaqEarModel *ear_params = engine->fft_ear_model;
+  guint frame_size = peaq_earmodel_get_frame_size (ear_params);
+
+  gboolean above_thres =
+    is_frame_above_threshold (refdata, frame_size, channels);
+
+  peaq_movaccum_set_tentative (engine->mov_accum[MOVADV_SEGMENTAL_NMR],
+                               !above_thres);
+  peaq_movaccum_set_tentative (engine->mov_accum[MOVADV_EHS], !above_thres);
+
+  pool_process (&engine->fft_pool, engine->fft_ear_model, channels, refdata,
+                testdata, engine->ref_fft_ear_state,
+                engine->test_fft_ear_state, NULL, NULL);
+
+  /* noise-to-mask ratio */
+  peaq_mov_nmr (PEAQ_FFTEARMODEL (engine->fft_ear_model),
+                engine->ref_fft_ear_state,
+                engine->test_fft_ear_state,
+                engine->mov_accum[MOVADV_SEGMENTAL_NMR],
+                NULL);
+
+  /* error harmonic structure */
+  peaq_mov_ehs (engine->fft_ear_model, engine->ref_fft_ear_state,
+                engine->test_fft_ear_state, engine->ehs_state,
+                engine->mov_accum[MOVADV_EHS]);
+
+  for (i = 0; i < frame_size / 2; i++) {
+    for (c = 0; c < channels; c++) {
+      engine->total_signal_energy += refdata[c][i] * refdata[c][i];
+      engine->total_noise_energy
+        += (refdata[c][i] - testdata[c][i]) * (refdata[c][i] - testdata[c][i]);
+    }
+  }
+
+  engine->frame_counter++;
+}
+
+static void
+process_fb_block (PeaqEngine *engine, gfloat const * const *refdata,
+                  gfloat const * const *testdata)
+{
+  guint channels = engine->channels;
+  PeaqEarModel *ear_params = engine->fb_ear_model;
+  guint frame_size = peaq_earmodel_get_frame_size (ear_params);
+
+  gboolean above_thres =
+    is_frame_above_threshold (refdata, frame_size, channels);
+
+  peaq_movaccum_set_tentative (engine->mov_accum[MOVADV_RMS_MOD_DIFF],
+                               !above_thres);
+  peaq_movaccum_set_tentative (engine->mov_accum[MOVADV_RMS_NOISE_LOUD_ASYM],
+                               !above_thres);
+  peaq_movaccum_set_tentative (engine->mov_accum[MOVADV_AVG_LIN_DIST],
+                               !above_thres);
+
+  apply_ear_model_and_preprocess (engine, &engine->fb_pool,
+                                  engine->fb_ear_model,
+                                  refdata, testdata,
+                                  engine->ref_fb_ear_state,
+                                  engine->test_fb_ear_state,
+                                  engine->frame_counter_fb);
+
+  /* modulation difference */
+  if (engine->frame_counter_fb >= 125) {
+    peaq_mov_modulation_difference (engine->ref_modulation_processor,
+                                    engine->test_modulation_processor,
+                                    engine->mov_accum[MOVADV_RMS_MOD_DIFF],
+                                    NULL, NULL);
+  }
+
+  /* noise loudness */
+  if (engine->frame_counter_fb >= 125 &&
+      engine->frame_counter_fb - 13 >= engine->loudness_reached_frame) {
+    peaq_mov_noise_loud_asym (engine->ref_modulation_processor,
+                              engine->test_modulation_processor,
+                              engine->level_adapter,
+                              engine->mov_accum[MOVADV_RMS_NOISE_LOUD_ASYM]);
+    peaq_mov_lin_dist (engine->ref_modulation_processor,
+                       engine->test_modulation_processor,
+                       engine->level_adapter,
+                       engine->ref_fb_ear_state,
+                       engine->mov_accum[MOVADV_AVG_LIN_DIST]);
+  }
+
+  engine->frame_counter_fb++;
+}
+
+static gboolean
+is_frame_above_threshold (gfloat const * const *framedata, guint framesize,
+                          guint channels)
+{
+  gfloat sum;
+  guint i, c;
+
+  for (c = 0; c < channels; c++) {
+    sum = 0;
+    for (i = 0; i < 5; i++)
+      sum += fabs (framedata[c][i]);
+    while (i < framesize) {
+      sum += fabs (framedata[c][i]) - fabs (framedata[c][i - 5]);
+      if (sum >= 200. / 32768)
+        return TRUE;
+      i++;
+    }
+  }
+  return FALSE;
+}
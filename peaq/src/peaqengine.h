@@ -0,0 +1,88 @@
+/* GstPEAQ
+ * Copyright (C) 2006, 2007, 2010, 2011, 2012, 2013, 2014, 2015
+ * Martin Holters <martin.holters@hsu-hh.de>
+ *
+ * peaqengine.h: Compute objective audio quality measures without GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __PEAQENGINE_H__
+#define __PEAQENGINE_H__ 1
+
+#include <glib.h>
+
+/**
+ * PeaqMode:
+ * @PEAQ_MODE_BASIC: The basic version of <xref linkend="BS1387" />, based on
+ * the FFT ear model only and eleven model output variables.
+ * @PEAQ_MODE_ADVANCED: The advanced version of <xref linkend="BS1387" />,
+ * combining the FFT and the filter bank ear model into five model output
+ * variables.
+ */
+typedef enum
+{
+  PEAQ_MODE_BASIC,
+  PEAQ_MODE_ADVANCED
+} PeaqMode;
+
+/**
+ * PEAQ_MAX_MOVS:
+ *
+ * The number of model output variables of the basic version, which is the
+ * larger of the two.
+ */
+#define PEAQ_MAX_MOVS 11
+
+/**
+ * PeaqResult:
+ * @odg: The objective difference grade.
+ * @di: The distortion index.
+ * @total_snr: The overall signal to noise ratio in dB.
+ * @mov_count: The number of valid entries in @movs, 11 in basic and 5 in
+ * advanced mode.
+ * @movs: The model output variables in the order expected by
+ * peaq_calculate_di_basic() or peaq_calculate_di_advanced(), respectively.
+ */
+typedef struct
+{
+  gdouble odg;
+  gdouble di;
+  gdouble total_snr;
+  guint mov_count;
+  gdouble movs[PEAQ_MAX_MOVS];
+} PeaqResult;
+
+typedef struct _PeaqEngine PeaqEngine;
+
+PeaqEngine *peaq_engine_new (PeaqMode mode, guint channels);
+void peaq_engine_free (PeaqEngine *engine);
+void peaq_engine_reset (PeaqEngine *engine);
+PeaqMode peaq_engine_get_mode (PeaqEngine const *engine);
+guint peaq_engine_get_channels (PeaqEngine const *engine);
+void peaq_engine_set_playback_level (PeaqEngine *engine, gdouble level);
+gdouble peaq_engine_get_playback_level (PeaqEngine const *engine);
+void peaq_engine_push (PeaqEngine *engine, gfloat const *ref,
+                       gfloat const *test, guint nframes);
+void peaq_engine_push_tail (PeaqEngine *engine,
+                            gfloat const *ref, guint ref_frames,
+                            gfloat const *test, guint test_frames);
+gdouble peaq_engine_finish (PeaqEngine *engine, PeaqResult *result);
+void peaq_engine_get_result (PeaqEngine *engine, PeaqResult *result);
+gchar const *peaq_engine_get_mov_name (PeaqMode mode, guint index);
+
+#endif /* __PEAQENGINE_H__ */
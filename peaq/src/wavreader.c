@@ -0,0 +1,428 @@
+/* GstPEAQ
+ * Copyright (C) 2012, 2013, 2014, 2015
+ * Martin Holters <martin.holters@hsu-hh.de>
+ *
+ * wavreader.c: Read WAV files as 48 kHz floating point frames
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:wavreader
+ * @short_description: Direct WAV file input.
+ * @title: PeaqWavReader
+ *
+ * A #PeaqWavReader maps a WAV file into memory and delivers its content as
+ * interleaved floating point frames at %PEAQ_WAVREADER_RATE, scaled to a full
+ * scale of one as audioconvert does. Integer PCM with 8, 16, 24 or 32 bits
+ * and IEEE floating point with 32 or 64 bits are supported, also when wrapped
+ * in WAVE_FORMAT_EXTENSIBLE. Files at other sampling rates are converted with
+ * a Kaiser-windowed sinc interpolator which, like audioresample, is a close
+ * but not exact approximation of ideal band-limited resampling.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "wavreader.h"
+
+#define FORMAT_PCM 0x0001
+#define FORMAT_IEEE_FLOAT 0x0003
+#define FORMAT_EXTENSIBLE 0xFFFE
+
+/* zero crossings of the interpolation kernel on either side, the number of
+ * table entries per zero crossing, and the Kaiser window shape parameter */
+#define KERNEL_ZERO_CROSSINGS 16
+#define KERNEL_OVERSAMPLING 256
+#define KERNEL_BETA 8.6
+/* fraction of the lower Nyquist frequency passed unattenuated */
+#define KERNEL_ROLLOFF 0.98
+
+struct _PeaqWavReader
+/**
+ * PeaqWavReader:
+ *
+ * The opaque PeaqWavReader structure.
+ */
+{
+  GMappedFile *file;
+  guint8 const *data;
+  guint format;
+  guint channels;
+  guint rate;
+  guint bytes_per_sample;
+  guint block_align;
+  guint64 input_frames;
+  guint64 frames;
+  guint64 position;
+  gdouble cutoff;
+  gint half_taps;
+  gfloat *kernel;
+  gfloat *weights;
+  gfloat *scratch;
+  gsize scratch_frames;
+};
+
+static gdouble bessel_i0 (gdouble x);
+static void init_kernel (PeaqWavReader *reader);
+static void convert_frames (PeaqWavReader const *reader, gint64 first,
+                            gsize count, gfloat *data);
+static void resample_frames (PeaqWavReader *reader, gfloat *data,
+                             guint nframes);
+
+GQuark
+peaq_wavreader_error_quark (void)
+{
+  return g_quark_from_static_string ("peaq-wavreader-error-quark");
+}
+
+static guint
+get_le16 (guint8 const *p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+static guint32
+get_le32 (guint8 const *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((guint32) p[3] << 24);
+}
+
+/**
+ * peaq_wavreader_open:
+ * @filename: The name of the WAV file to open.
+ * @error: Return location for a #GError, or %NULL.
+ *
+ * Maps the given file into memory and parses its header.
+ *
+ * Returns: The newly created #PeaqWavReader positioned at the first frame, to
+ * be freed with peaq_wavreader_close(), or %NULL if the file could not be
+ * opened or is not a supported WAV file.
+ */
+PeaqWavReader *
+peaq_wavreader_open (gchar const *filename, GError **error)
+{
+  PeaqWavReader *reader;
+  GMappedFile *file;
+  guint8 const *contents;
+  gsize length;
+  gsize offset;
+  guint8 const *fmt = NULL;
+  guint32 fmt_size = 0;
+  guint8 const *data = NULL;
+  gsize data_size = 0;
+  guint bits;
+
+  file = g_mapped_file_new (filename, FALSE, error);
+  if (!file)
+    return NULL;
+  contents = (guint8 const *) g_mapped_file_get_contents (file);
+  length = g_mapped_file_get_length (file);
+
+  if (length < 12 || memcmp (contents, "RIFF", 4) != 0 ||
+      memcmp (contents + 8, "WAVE", 4) != 0) {
+    g_set_error (error, PEAQ_WAVREADER_ERROR, PEAQ_WAVREADER_ERROR_FORMAT,
+                 "%s is not a WAV file", filename);
+    g_mapped_file_unref (file);
+    return NULL;
+  }
+
+  for (offset = 12; offset + 8 <= length && !data; ) {
+    guint32 chunk_size = get_le32 (contents + offset + 4);
+    gsize available = length - offset - 8;
+    if (memcmp (contents + offset, "fmt ", 4) == 0) {
+      fmt = contents + offset + 8;
+      fmt_size = MIN (chunk_size, available);
+    } else if (memcmp (contents + offset, "data", 4) == 0) {
+      /* a size beyond the end of the file is left by recorders that were
+       * interrupted; use whatever is there */
+      data = contents + offset + 8;
+      data_size = MIN (chunk_size, available);
+    }
+    if (chunk_size > available)
+      break;
+    offset += 8 + chunk_size + (chunk_size & 1);
+  }
+
+  if (!fmt || fmt_size < 16 || !data) {
+    g_set_error (error, PEAQ_WAVREADER_ERROR, PEAQ_WAVREADER_ERROR_FORMAT,
+                 "%s lacks a format or data chunk", filename);
+    g_mapped_file_unref (file);
+    return NULL;
+  }
+
+  reader = g_new0 (PeaqWavReader, 1);
+  reader->file = file;
+  reader->data = data;
+  reader->format = get_le16 (fmt);
+  reader->channels = get_le16 (fmt + 2);
+  reader->rate = get_le32 (fmt + 4);
+  reader->block_align = get_le16 (fmt + 12);
+  bits = get_le16 (fmt + 14);
+  if (reader->format == FORMAT_EXTENSIBLE && fmt_size >= 26)
+    reader->format = get_le16 (fmt + 24);
+  reader->bytes_per_sample = (bits + 7) / 8;
+
+  if (!((reader->format == FORMAT_PCM && reader->bytes_per_sample >= 1 &&
+         reader->bytes_per_sample <= 4) ||
+        (reader->format == FORMAT_IEEE_FLOAT &&
+         (reader->bytes_per_sample == 4 || reader->bytes_per_sample == 8))) ||
+      reader->channels == 0 || reader->rate == 0 ||
+      reader->block_align < reader->channels * reader->bytes_per_sample) {
+    g_set_error (error, PEAQ_WAVREADER_ERROR, PEAQ_WAVREADER_ERROR_FORMAT,
+                 "%s uses an unsupported sample format (format tag %u, "
+                 "%u bits, %u channels, %u Hz)", filename, reader->format,
+                 bits, reader->channels, reader->rate);
+    peaq_wavreader_close (reader);
+    return NULL;
+  }
+
+  reader->input_frames = data_size / reader->block_align;
+  reader->frames =
+    (reader->input_frames * PEAQ_WAVREADER_RATE + reader->rate - 1) /
+    reader->rate;
+  reader->position = 0;
+  if (reader->rate != PEAQ_WAVREADER_RATE)
+    init_kernel (reader);
+
+  return reader;
+}
+
+/**
+ * peaq_wavreader_close:
+ * @reader: The #PeaqWavReader to close.
+ *
+ * Unmaps the file and frees the given #PeaqWavReader.
+ */
+void
+peaq_wavreader_close (PeaqWavReader *reader)
+{
+  g_mapped_file_unref (reader->file);
+  g_free (reader->kernel);
+  g_free (reader->weights);
+  g_free (reader->scratch);
+  g_free (reader);
+}
+
+/**
+ * peaq_wavreader_get_channels:
+ * @reader: The #PeaqWavReader to query.
+ *
+ * Returns: The number of interleaved channels.
+ */
+guint
+peaq_wavreader_get_channels (PeaqWavReader const *reader)
+{
+  return reader->channels;
+}
+
+/**
+ * peaq_wavreader_get_rate:
+ * @reader: The #PeaqWavReader to query.
+ *
+ * Returns: The sampling rate stored in the file, which may differ from the
+ * %PEAQ_WAVREADER_RATE of the delivered frames.
+ */
+guint
+peaq_wavreader_get_rate (PeaqWavReader const *reader)
+{
+  return reader->rate;
+}
+
+/**
+ * peaq_wavreader_get_frames:
+ * @reader: The #PeaqWavReader to query.
+ *
+ * Returns: The total number of frames delivered at %PEAQ_WAVREADER_RATE.
+ */
+guint64
+peaq_wavreader_get_frames (PeaqWavReader const *reader)
+{
+  return reader->frames;
+}
+
+/**
+ * peaq_wavreader_read:
+ * @reader: The #PeaqWavReader to read from.
+ * @data: Location to store up to @nframes interleaved frames.
+ * @nframes: The maximum number of frames to read.
+ *
+ * Reads the next frames of the file, converted to floating point and
+ * resampled to %PEAQ_WAVREADER_RATE if necessary.
+ *
+ * Returns: The number of frames stored, which is only less than @nframes at
+ * the end of the file.
+ */
+guint
+peaq_wavreader_read (PeaqWavReader *reader, gfloat *data, guint nframes)
+{
+  if (nframes > reader->frames - reader->position)
+    nframes = reader->frames - reader->position;
+  if (nframes == 0)
+    return 0;
+  if (reader->rate == PEAQ_WAVREADER_RATE)
+    convert_frames (reader, reader->position, nframes, data);
+  else
+    resample_frames (reader, data, nframes);
+  reader->position += nframes;
+  return nframes;
+}
+
+static gdouble
+bessel_i0 (gdouble x)
+{
+  gdouble sum = 1.;
+  gdouble term = 1.;
+  guint k;
+  for (k = 1; term > 1e-12 * sum; k++) {
+    term *= (x / (2 * k)) * (x / (2 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+/* Tabulates sinc (x) w (x) for x = i / KERNEL_OVERSAMPLING, w being a Kaiser
+ * window reaching zero at KERNEL_ZERO_CROSSINGS. When reducing the rate, the
+ * kernel is stretched by 1 / cutoff to suppress aliasing, widening it to
+ * 2 half_taps input samples. */
+static void
+init_kernel (PeaqWavReader *reader)
+{
+  guint i;
+  guint length = KERNEL_ZERO_CROSSINGS * KERNEL_OVERSAMPLING + 2;
+  gdouble norm = bessel_i0 (KERNEL_BETA);
+
+  reader->cutoff = KERNEL_ROLLOFF *
+    MIN (1., (gdouble) PEAQ_WAVREADER_RATE / reader->rate);
+  reader->half_taps = (gint) ceil (KERNEL_ZERO_CROSSINGS / reader->cutoff);
+  reader->kernel = g_new (gfloat, length);
+  for (i = 0; i < length; i++) {
+    gdouble x = (gdouble) i / KERNEL_OVERSAMPLING;
+    gdouble r = x / KERNEL_ZERO_CROSSINGS;
+    if (r >= 1.) {
+      reader->kernel[i] = 0.;
+    } else {
+      gdouble sinc = i == 0 ? 1. : sin (M_PI * x) / (M_PI * x);
+      reader->kernel[i] =
+        sinc * bessel_i0 (KERNEL_BETA * sqrt (1. - r * r)) / norm;
+    }
+  }
+  reader->weights = g_new (gfloat, 2 * reader->half_taps);
+}
+
+/* Converts count input frames starting at first, which may lie partly or
+ * wholly outside the file, the missing frames being taken as silence. */
+static void
+convert_frames (PeaqWavReader const *reader, gint64 first, gsize count,
+                gfloat *data)
+{
+  guint channels = reader->channels;
+  gsize i;
+  guint c;
+
+  for (i = 0; i < count; i++, first++) {
+    guint8 const *frame;
+    if (first < 0 || first >= (gint64) reader->input_frames) {
+      for (c = 0; c < channels; c++)
+        *data++ = 0.;
+      continue;
+    }
+    frame = reader->data + first * reader->block_align;
+    for (c = 0; c < channels; c++) {
+      guint8 const *p = frame + c * reader->bytes_per_sample;
+      gfloat value;
+      if (reader->format == FORMAT_IEEE_FLOAT) {
+        if (reader->bytes_per_sample == 4) {
+          union { guint32 i; gfloat f; } u;
+          u.i = get_le32 (p);
+          value = u.f;
+        } else {
+          union { guint64 i; gdouble f; } u;
+          u.i = get_le32 (p) | ((guint64) get_le32 (p + 4) << 32);
+          value = u.f;
+        }
+      } else {
+        switch (reader->bytes_per_sample) {
+          case 1:
+            value = (p[0] - 128) / 128.f;
+            break;
+          case 2:
+            value = (gint16) get_le16 (p) / 32768.f;
+            break;
+          case 3:
+            value = ((gint32) ((p[0] << 8) | (p[1] << 16) |
+                               ((guint32) p[2] << 24)) >> 8) / 8388608.f;
+            break;
+          default:
+            value = (gint32) get_le32 (p) / 2147483648.f;
+            break;
+        }
+      }
+      *data++ = value;
+    }
+  }
+}
+
+/* Output frame n lies at n rate / PEAQ_WAVREADER_RATE in input frames; kept
+ * as an integer ratio so that long files accumulate no rounding error. */
+static void
+resample_frames (PeaqWavReader *reader, gfloat *data, guint nframes)
+{
+  guint channels = reader->channels;
+  gint taps = 2 * reader->half_taps;
+  gint64 first = (gint64) (reader->position * reader->rate /
+                           PEAQ_WAVREADER_RATE) - reader->half_taps + 1;
+  gint64 last = (gint64) ((reader->position + nframes - 1) * reader->rate /
+                          PEAQ_WAVREADER_RATE) + reader->half_taps;
+  gsize span = last - first + 1;
+  gdouble scale = reader->cutoff * KERNEL_OVERSAMPLING;
+  guint n;
+  guint c;
+  gint k;
+
+  if (span > reader->scratch_frames) {
+    g_free (reader->scratch);
+    reader->scratch = g_new (gfloat, span * channels);
+    reader->scratch_frames = span;
+  }
+  convert_frames (reader, first, span, reader->scratch);
+
+  for (n = 0; n < nframes; n++) {
+    guint64 position = (reader->position + n) * reader->rate;
+    gint64 index = position / PEAQ_WAVREADER_RATE;
+    gdouble frac =
+      (gdouble) (position % PEAQ_WAVREADER_RATE) / PEAQ_WAVREADER_RATE;
+    gfloat const *input =
+      reader->scratch + (index - reader->half_taps + 1 - first) * channels;
+
+    for (k = 0; k < taps; k++) {
+      gdouble x = fabs (k - reader->half_taps + 1 - frac) * scale;
+      guint i = (guint) x;
+      gdouble t = x - i;
+      if (i >= KERNEL_ZERO_CROSSINGS * KERNEL_OVERSAMPLING)
+        reader->weights[k] = 0.;
+      else
+        reader->weights[k] = reader->cutoff *
+          ((1. - t) * reader->kernel[i] + t * reader->kernel[i + 1]);
+    }
+    for (c = 0; c < channels; c++) {
+      gfloat sum = 0.;
+      for (k = 0; k < taps; k++)
+        sum += reader->weights[k] * input[k * channels + c];
+      *data++ = sum;
+    }
+  }
+}
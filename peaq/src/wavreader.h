@@ -0,0 +1,60 @@
+/* GstPEAQ
+ * Copyright (C) 2012, 2013, 2014, 2015
+ * Martin Holters <martin.holters@hsu-hh.de>
+ *
+ * wavreader.h: Read WAV files as 48 kHz floating point frames
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __WAVREADER_H__
+#define __WAVREADER_H__ 1
+
+#include <glib.h>
+
+#define PEAQ_WAVREADER_ERROR (peaq_wavreader_error_quark ())
+
+/**
+ * PeaqWavReaderError:
+ * @PEAQ_WAVREADER_ERROR_FORMAT: The file is not a WAV file or uses a sample
+ * format that is not supported.
+ */
+typedef enum
+{
+  PEAQ_WAVREADER_ERROR_FORMAT
+} PeaqWavReaderError;
+
+/**
+ * PEAQ_WAVREADER_RATE:
+ *
+ * The sampling rate all files are converted to, as required by the ear
+ * models.
+ */
+#define PEAQ_WAVREADER_RATE 48000
+
+typedef struct _PeaqWavReader PeaqWavReader;
+
+GQuark peaq_wavreader_error_quark (void);
+PeaqWavReader *peaq_wavreader_open (gchar const *filename, GError **error);
+void peaq_wavreader_close (PeaqWavReader *reader);
+guint peaq_wavreader_get_channels (PeaqWavReader const *reader);
+guint peaq_wavreader_get_rate (PeaqWavReader const *reader);
+guint64 peaq_wavreader_get_frames (PeaqWavReader const *reader);
+guint peaq_wavreader_read (PeaqWavReader *reader, gfloat *data,
+                           guint nframes);
+
+#endif /* __WAVREADER_H__ */
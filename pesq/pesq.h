@@ -1,294 +1,588 @@
-/*****************************************************************************
-
-Perceptual Evaluation of Speech Quality (PESQ)
-ITU-T Recommendation P.862.
-Version 1.2 - 2 August 2002.
-
-              ****************************************
-              PESQ Intellectual Property Rights Notice
-              ****************************************
-
-DEFINITIONS:
-------------
-For the purposes of this Intellectual Property Rights Notice
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
 the terms Perceptual Evaluation of Speech Quality Algorithm?
-and PESQ Algorithm?refer to the objective speech quality
-measurement algorithm defined in ITU-T Recommendation P.862;
-the term PESQ Software?refers to the C-code component of P.862. 
-
-NOTICE:
--------
-All copyright, trade marks, trade names, patents, know-how and
-all or any other intellectual rights subsisting in or used in
-connection with including all algorithms, documents and manuals
-relating to the PESQ Algorithm and or PESQ Software are and remain
-the sole property in law, ownership, regulations, treaties and
-patent rights of the Owners identified below. The user may not
-dispute or question the ownership of the PESQ Algorithm and
-or PESQ Software.
-
-OWNERS ARE:
------------
-
-1.	British Telecommunications plc (BT), all rights assigned
-      to Psytechnics Limited
-2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
-
-RESTRICTIONS:
--------------
-
-The user cannot:
-
-1.	alter, duplicate, modify, adapt, or translate in whole or in
-      part any aspect of the PESQ Algorithm and or PESQ Software
-2.	sell, hire, loan, distribute, dispose or put to any commercial
-      use other than those permitted below in whole or in part any
-      aspect of the PESQ Algorithm and or PESQ Software
-
-PERMITTED USE:
---------------
-
-The user may:
-
-1.	Use the PESQ Software to:
-      i)   understand the PESQ Algorithm; or
-      ii)  evaluate the ability of the PESQ Algorithm to perform
-           its intended function of predicting the speech quality
-           of a system; or
-      iii) evaluate the computational complexity of the PESQ Algorithm,
-           with the limitation that none of said evaluations or its
-           results shall be used for external commercial use.
-
-2.	Use the PESQ Software to test if an implementation of the PESQ
-      Algorithm conforms to ITU-T Recommendation P.862.
-
-3.	With the prior written permission of both Psytechnics Limited
-      and OPTICOM GmbH, use the PESQ Software in accordance with the
-      above Restrictions to perform work that meets all of the following
-      criteria:
-      i)    the work must contribute directly to the maintenance of an
-            existing ITU recommendation or the development of a new ITU
-            recommendation under an approved ITU Study Item; and
-      ii)   the work and its results must be fully described in a
-            written contribution to the ITU that is presented at a formal
-            ITU meeting within one year of the start of the work; and
-      iii)  neither the work nor its results shall be put to any
-            commercial use other than making said contribution to the ITU.
-            Said permission will be provided on a case-by-case basis.
-
-
-ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
-ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
-FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
-
-EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
-IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
-AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
-
-
-***********************************************************************
-*  OPTICOM GmbH                    *  Psytechnics Limited             *
-*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
-*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
-*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
-*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
-*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
-*  www.opticom.de                  *  www.psytechnics.com             *
-***********************************************************************
-
-Further information is also available from www.pesq.org
-
-*****************************************************************************/
-
-#include <string.h>
-#include <stdlib.h>
-
-#ifndef TRUE
-#define TRUE 1
-#endif
-
-#ifndef FALSE
-#define FALSE 0
-#endif
-
-
-#define LINIIR 60
-
-#define MAXNUTTERANCES 50
-
-#define WHOLE_SIGNAL -1
-
-#define LINIIR 60
-#define LSMJ 20
-#define LFBANK 35
-
-#define DATAPADDING_MSECS 320
-#define SEARCHBUFFER 75  
-
-#define EPS 1E-12
-
-#define MINSPEECHLGTH 4
-
-#define JOINSPEECHLGTH 50
-
-#define MINUTTLENGTH 50
-
-#define SATDB 90.31
-#define FIXDB -32.0
-
-#define TWOPI 6.28318530717959
-
-int Nb ;
-
-#define Nfmax 512
-
-#define Sp_8k   2.764344e-5
-#define Sl_8k   1.866055e-1
-
-#define Sp_16k  6.910853e-006
-#define Sl_16k  1.866055e-001
-
-extern float Sp;
-extern float Sl;
-
-#define Dz 0.312
-
-#define gamma 0.001
-
-#define Tl 10000.0f
-
-#define Ts 10000000.0f
-
-#define Tt 0.02f
-
-#define Tn 0.01f
-
-
-#ifndef min
-  #define min(a,b)  (((a) < (b)) ? (a) : (b))
-#endif
-
-#ifndef max
-  #define max(a,b)  (((a) > (b)) ? (a) : (b))
-#endif
-
-
-typedef struct {
-  char  path_name[512];
-  char  file_name [128];
-  long  Nsamples;
-  long  apply_swap;
-
-  float * data;
-  float * VAD;
-  float * logVAD;
-} SIGNAL_INFO;
-
-typedef struct {
-  long Nutterances;
-  long Largest_uttsize;
-  long Nsurf_samples;
-
-  long  Crude_DelayEst;
-  float Crude_DelayConf;
-  long  UttSearch_Start[MAXNUTTERANCES];
-  long  UttSearch_End[MAXNUTTERANCES];
-  long  Utt_DelayEst[MAXNUTTERANCES];
-  long  Utt_Delay[MAXNUTTERANCES];
-  float Utt_DelayConf[MAXNUTTERANCES];
-  long  Utt_Start[MAXNUTTERANCES];
-  long  Utt_End[MAXNUTTERANCES];
-
-  float pesq_mos;
-  float subj_mos;
-  int   cond_nr;
-} ERROR_INFO;
-
-
-extern long Fs;
-extern long Downsample;
-extern float * InIIR_Hsos;
-extern long Align_Nfft;
-
-extern long Fs_8k;
-extern long Downsample_8k;
-extern long InIIR_Nsos_8k;
-extern long Align_Nfft_8k;
-
-extern long Fs_16k;
-extern long Downsample_16k;
-extern long InIIR_Nsos_16k;
-extern long Align_Nfft_16k;
-
-extern float * InIIR_Hsos;
-
-void input_filter(
-       SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, float * ftmp );
-void apply_filters( float * data, long Nsamples );
-void make_stereo_file (char *, SIGNAL_INFO *, SIGNAL_INFO *);
-void make_stereo_file2 (char *, SIGNAL_INFO *, float *);
-void select_rate( long sample_rate,
-     long * Error_Flag, char ** Error_Type );
-int  file_exist( char * fname );
-void load_src( long * Error_Flag, char ** Error_Type,
-     SIGNAL_INFO * sinfo);
-void alloc_other( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, 
-    long * Error_Flag, char ** Error_Type, float ** ftmp);
-void calc_VAD( SIGNAL_INFO * pinfo );
-int  id_searchwindows( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
-       ERROR_INFO * err_info );
-void id_utterances( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
-       ERROR_INFO * err_info );
-void utterance_split( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
-       ERROR_INFO * err_info, float * ftmp );
-void utterance_locate( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
-       ERROR_INFO * err_info, float * ftmp );
-void auditory_transform( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
-       ERROR_INFO * err_info, long Utt_id, float * ftmp);
-void calc_err( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, 
-       ERROR_INFO * err_info, long Utt_id);
-void extract_params( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
-    ERROR_INFO * err_info, long Utt_id, float * ftmp );
-void utterance_process(SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
-       ERROR_INFO * err_info, long Utt_id, float * ftmp);
-void DC_block( float * data, long Nsamples );
-void apply_filter ( float * data, long Nsamples, int, double [][2] );
-double pow_of (const float * const , long , long, long);
-void apply_VAD(
-     SIGNAL_INFO * pinfo, float * data, float * VAD, float * logVAD );
-void crude_align(
-     SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, ERROR_INFO * err_info,
-     long Utt_id, float * ftmp);
-void time_align(
-     SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, ERROR_INFO * err_info,
-     long Utt_id, float * ftmp );
-void split_align( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
-     ERROR_INFO * err_info, float * ftmp,
-     long Utt_Start, long Utt_SpeechStart, long Utt_SpeechEnd, long Utt_End,
-     long Utt_DelayEst, float Utt_DelayConf,
-     long * Best_ED1, long * Best_D1, float * Best_DC1,
-     long * Best_ED2, long * Best_D2, float * Best_DC2,
-     long * Best_BP );
-void pesq_psychoacoustic_model(
-SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
-ERROR_INFO * err_info, float * ftmp);
-void apply_pesq( float * x_data, float * ref_surf,
-float * y_data, float * deg_surf, long NVAD_windows, float * ftmp,
-ERROR_INFO * err_info );
-
-
-
-#define     D_POW_F     2
-#define     D_POW_S     6
-#define     D_POW_T     2
-
-#define     A_POW_F     1
-#define     A_POW_S     6
-#define     A_POW_T     2
-
-
-#define     D_WEIGHT    0.1
-#define     A_WEIGHT    0.0309
-
-/* END OF FILE */
-
+and PESQ Algorithm?refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term PESQ Software?refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+
+#define LINIIR 60
+
+#define MAXNUTTERANCES 50
+
+#define MAXCHANNELS 8
+
+#define MAXJOBS 64
+
+#define WHOLE_SIGNAL -1
+
+#define TRIAGE_DECIMATION 4
+#define TRIAGE_DISTURBED_FRAME 10
+#define TRIAGE_ERROR_BASE 0.1
+#define TRIAGE_ERROR_DISTURBED 15.0
+#define TRIAGE_ERROR_MAX 1.5
+
+#define LINIIR 60
+#define LSMJ 20
+#define LFBANK 35
+
+#define DATAPADDING_MSECS 320
+#define SEARCHBUFFER 75  
+#define CRITERIUM_FOR_SILENCE_OF_5_SAMPLES 500.
+#define THRESHOLD_BAD_FRAMES 30
+
+#define EPS 1E-12
+
+#define MINSPEECHLGTH 4
+
+#define JOINSPEECHLGTH 50
+
+#define MINUTTLENGTH 50
+
+#define SATDB 90.31
+#define FIXDB -32.0
+
+#define TWOPI 6.28318530717959
+
+int Nb ;
+
+#define Nfmax 512
+
+#define Sp_8k   2.764344e-5
+#define Sl_8k   1.866055e-1
+
+#define Sp_16k  6.910853e-006
+#define Sl_16k  1.866055e-001
+
+extern float Sp;
+extern float Sl;
+
+#define Dz 0.312
+
+#define gamma 0.001
+
+#define Tl 10000.0f
+
+#define Ts 10000000.0f
+
+#define Tt 0.02f
+
+#define Tn 0.01f
+
+
+#ifndef min
+  #define min(a,b)  (((a) < (b)) ? (a) : (b))
+#endif
+
+#ifndef max
+  #define max(a,b)  (((a) > (b)) ? (a) : (b))
+#endif
+
+
+typedef struct {
+  char  path_name[512];
+  char  file_name [128];
+  long  Nsamples;
+  long  apply_swap;
+  long  input_rate;
+  double range_start;
+  double range_end;
+  long  channel;
+  long  Nchannels;
+
+  float * data;
+  float * VAD;
+  float * logVAD;
+} SIGNAL_INFO;
+
+typedef struct {
+  long Nutterances;
+  long Largest_uttsize;
+  long Nsurf_samples;
+
+  long  Crude_DelayEst;
+  float Crude_DelayConf;
+  long  UttSearch_Start[MAXNUTTERANCES];
+  long  UttSearch_End[MAXNUTTERANCES];
+  long  Utt_DelayEst[MAXNUTTERANCES];
+  long  Utt_Delay[MAXNUTTERANCES];
+  float Utt_DelayConf[MAXNUTTERANCES];
+  long  Utt_Start[MAXNUTTERANCES];
+  long  Utt_End[MAXNUTTERANCES];
+
+  float pesq_mos;
+  float pesq_mos_error;
+  float subj_mos;
+  int   cond_nr;
+} ERROR_INFO;
+
+#define RESULTS_ITU         0
+#define RESULTS_SIMPLE      1
+#define RESULTS_CSV         2
+#define RESULTS_JSON        3
+#define RESULTS_PROFILE     4
+
+#define MAXRESULTFILES      5
+#define RESULTBUFFER        65536
+
+typedef struct {
+  char  path_name [512];
+  int   format;
+  int   fd;
+  char *buffer;
+  long  used;
+} RESULT_FILE;
+
+typedef struct {
+  long        Nfiles;
+  RESULT_FILE file [MAXRESULTFILES];
+} RESULT_SINK;
+
+#define SYNTH_CLEAN         0
+#define SYNTH_DELAY_JUMP    1
+#define SYNTH_PACKET_LOSS   2
+#define SYNTH_SILENCE       3
+#define SYNTH_KINDS         4
+
+extern char * Synth_Kind_Name [SYNTH_KINDS];
+
+/* Stage times are inclusive; PROFILE_UTTERANCE_LOCATE contains the
+   per-utterance crude_align, time_align and split_align. */
+#define PROFILE_LOAD                0
+#define PROFILE_FIX_POWER_LEVEL     1
+#define PROFILE_APPLY_FILTER        2
+#define PROFILE_INPUT_FILTER        3
+#define PROFILE_CALC_VAD            4
+#define PROFILE_CRUDE_ALIGN         5
+#define PROFILE_UTTERANCE_LOCATE    6
+#define PROFILE_TIME_ALIGN          7
+#define PROFILE_SPLIT_ALIGN         8
+#define PROFILE_MODEL               9
+#define PROFILE_REALIGN             10
+#define PROFILE_LPQ                 11
+#define PROFILE_STAGES              12
+
+/* Checksums of intermediate model data, recorded so that regression
+   runs can tell which stage a result first moved in. */
+#define CHECKSUM_PITCH_POW_DENS_REF         0
+#define CHECKSUM_PITCH_POW_DENS_DEG         1
+#define CHECKSUM_FRAME_DISTURBANCE          2
+#define CHECKSUM_FRAME_DISTURBANCE_ASYM     3
+#define CHECKSUM_REALIGNED_DISTURBANCE      4
+#define CHECKSUM_REALIGNED_DISTURBANCE_ASYM 5
+#define PROFILE_CHECKSUMS                   6
+
+typedef struct {
+  double stage_time [PROFILE_STAGES];
+  long   stage_calls [PROFILE_STAGES];
+  double stage_start [PROFILE_STAGES];
+
+  long   Nutterances;
+  long   Nbad_intervals;
+  long   Nframes;
+
+  double checksum [PROFILE_CHECKSUMS];
+} PROFILE_INFO;
+
+extern PROFILE_INFO Profile;
+extern char * Profile_Stage_Name [PROFILE_STAGES];
+
+/* Trace of model internals, for finding out why a pair scores as it does.
+   Built with -DPESQ_TRACE, the hooks append binary records to the file
+   given with +trace=file; otherwise TRACE expands to nothing. A record is
+   a TRACE_RECORD followed by Nvalues floats, laid out as listed. */
+#define TRACE_PAIR                          0   /* Fs, ref and deg Nsamples, triage */
+#define TRACE_CRUDE_DELAY                   1   /* delay, confidence */
+#define TRACE_UTTERANCE                     2   /* index utterance: start, end, delay,
+                                                   estimated delay, confidence */
+#define TRACE_FRAME_DISTURBANCE             3   /* one value per frame */
+#define TRACE_FRAME_DISTURBANCE_ASYM        4
+#define TRACE_BAD_INTERVAL                  5   /* index interval: start and stop
+                                                   sample, delay, correlation */
+#define TRACE_REALIGNED_DISTURBANCE         6   /* one value per frame */
+#define TRACE_REALIGNED_DISTURBANCE_ASYM    7
+#define TRACE_RESULT                        8   /* MOS, d and a indicators */
+
+#define TRACE_MAGIC                         "PESQTRC1"
+
+typedef struct {
+  unsigned short kind;
+  unsigned short index;
+  unsigned int   Nvalues;
+} TRACE_RECORD;
+
+#ifdef PESQ_TRACE
+#define TRACE(call)     call
+#else
+#define TRACE(call)
+#endif
+
+typedef struct SRC_STREAM SRC_STREAM;
+
+/* State of a live engine. Samples arrive in pieces and a window of the
+   last Nwindow samples is scored every Nhop samples, a whole number of
+   half frames. The band densities of each frame wholly inside a window
+   are kept, before level scaling, by the sample the frame starts at, for
+   as long as the frame can be in a window. delay is that of the last
+   utterance of the last window scored. Once ended, no more samples
+   arrive. */
+typedef struct {
+  long    Nwindow;
+  long    Nhop;
+  long    Nf;
+  long    next;
+
+  float * ref;
+  float * deg;
+  long    size;
+  long    base;
+  long    Nref;
+  long    Ndeg;
+  int     ended;
+
+  long    delay;
+
+  long    Nslots;
+  long  * ref_frame_start;
+  long  * deg_frame_start;
+  float * ref_dens;
+  float * deg_dens;
+  float * irs_gain;
+  float * window;
+  float * frame;
+
+  long    Nframes_computed;
+} LIVE_INFO;
+
+
+extern long Fs;
+extern long Downsample;
+extern float * InIIR_Hsos;
+extern long Align_Nfft;
+
+extern long Fs_8k;
+extern long Downsample_8k;
+extern long InIIR_Nsos_8k;
+extern long Align_Nfft_8k;
+
+extern long Fs_16k;
+extern long Downsample_16k;
+extern long InIIR_Nsos_16k;
+extern long Align_Nfft_16k;
+
+extern float * InIIR_Hsos;
+
+void input_filter(
+       SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, float * ftmp );
+void apply_filters( float * data, long Nsamples );
+void make_stereo_file (char *, SIGNAL_INFO *, SIGNAL_INFO *);
+void make_stereo_file2 (char *, SIGNAL_INFO *, float *);
+void select_rate( long sample_rate,
+     long * Error_Flag, char ** Error_Type );
+int  file_exist( char * fname );
+void load_src( long * Error_Flag, char ** Error_Type,
+     SIGNAL_INFO * sinfo);
+void src_cache_enable( int enable );
+
+long src_prefetch( const char * path_name );
+int  parse_range( const char * text, SIGNAL_INFO * sinfo );
+int  parse_channel( const char * text, SIGNAL_INFO * sinfo );
+long load_src_channels( long * Error_Flag, char ** Error_Type,
+     SIGNAL_INFO * sinfo, SIGNAL_INFO * channel_info, long max_channels );
+void load_samples( long * Error_Flag, char ** Error_Type,
+     SIGNAL_INFO * sinfo, const float * samples, long Nsamples );
+#define FLAC_ALL_CHANNELS   -1
+int  flac_decode( const unsigned char * bytes, long Nbytes, long channel,
+     float ** samples, long * Nsamples, long * sample_rate, long * channels );
+int  flac_info( const unsigned char * bytes, long Nbytes,
+     long * Nsamples, long * sample_rate, long * channels );
+long src_length( SIGNAL_INFO * sinfo );
+void alloc_other( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, 
+    long * Error_Flag, char ** Error_Type, float ** ftmp);
+void calc_VAD( SIGNAL_INFO * pinfo );
+int  id_searchwindows( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+       ERROR_INFO * err_info );
+void id_utterances( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+       ERROR_INFO * err_info );
+void utterance_split( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+       ERROR_INFO * err_info, float * ftmp );
+void utterance_locate( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+       ERROR_INFO * err_info, float * ftmp );
+void auditory_transform( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+       ERROR_INFO * err_info, long Utt_id, float * ftmp);
+void calc_err( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, 
+       ERROR_INFO * err_info, long Utt_id);
+void extract_params( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, long Utt_id, float * ftmp );
+void utterance_process(SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+       ERROR_INFO * err_info, long Utt_id, float * ftmp);
+void DC_block( float * data, long Nsamples );
+void apply_filter ( float * data, long Nsamples, int, double [][2] );
+double pow_of (const float * const , long , long, long);
+void apply_VAD(
+     SIGNAL_INFO * pinfo, float * data, float * VAD, float * logVAD );
+void crude_align(
+     SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, ERROR_INFO * err_info,
+     long Utt_id, float * ftmp);
+void time_align(
+     SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, ERROR_INFO * err_info,
+     long Utt_id, float * ftmp );
+void split_align( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     ERROR_INFO * err_info, float * ftmp,
+     long Utt_Start, long Utt_SpeechStart, long Utt_SpeechEnd, long Utt_End,
+     long Utt_DelayEst, float Utt_DelayConf,
+     long * Best_ED1, long * Best_D1, float * Best_DC1,
+     long * Best_ED2, long * Best_D2, float * Best_DC2,
+     long * Best_BP );
+void select_model_tables( void );
+void short_term_fft( int Nf, SIGNAL_INFO * info, float * window,
+     long start_sample, float * hz_spectrum, float * fft_tmp );
+void freq_warping( int number_of_hz_bands, float * hz_spectrum, int Nb,
+     float * pitch_pow_dens, long frame );
+float total_audible( int frame, float * pitch_pow_dens, float factor );
+void time_avg_audible_of( int number_of_frames, int * silent,
+     float * pitch_pow_dens, float * avg_pitch_pow_dens, int total_number_of_frames );
+void freq_resp_compensation( int number_of_frames, float * pitch_pow_dens_ref,
+     float * avg_pitch_pow_dens_ref, float * avg_pitch_pow_dens_deg, float constant );
+void frame_disturbance_of( int frame, float * pitch_pow_dens_ref, float * pitch_pow_dens_deg,
+     float * old_scale, float * total_power_ref,
+     float * loudness_dens_ref, float * loudness_dens_deg,
+     float * disturbance_dens, float * deadzone,
+     float * disturbance, float * disturbance_asym_add );
+float Lpq_weight( int start_frame, int stop_frame, float power_syllable,
+     float power_time, float * frame_disturbance, float * time_weight );
+long utterance_delay_at( ERROR_INFO * err_info, long start_sample_ref );
+void model_frame_range( SIGNAL_INFO * ref_info, long maxNsamples,
+     long * start_frame, long * stop_frame );
+void pesq_score_frames( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     ERROR_INFO * err_info, long start_frame, long stop_frame,
+     float * window, int * silent,
+     float * pitch_pow_dens_ref, float * pitch_pow_dens_deg, int triage );
+float * filter_factors( long pow_of_2, int number_of_points, double filter_curve_db [][2] );
+void free_filter_factors( float * factor );
+void retain_filter_factors( int retain );
+extern double align_filter_dB [26][2];
+extern double standard_IRS_filter_dB [26][2];
+void pesq_psychoacoustic_model(
+SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+ERROR_INFO * err_info, float * ftmp, int triage);
+void apply_pesq( float * x_data, float * ref_surf,
+float * y_data, float * deg_surf, long NVAD_windows, float * ftmp,
+ERROR_INFO * err_info );
+
+void open_results( RESULT_SINK * sink );
+int  add_results_file( RESULT_SINK * sink, const char * path_name, int format );
+long format_result( char * buffer, long size, int format,
+     SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, ERROR_INFO * err_info,
+     double elapsed );
+void write_results( RESULT_SINK * sink,
+     SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, ERROR_INFO * err_info,
+     double elapsed );
+long format_error( char * buffer, long size,
+     SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     long Error_Flag, char * Error_Type );
+int  flush_results( RESULT_SINK * sink );
+void close_results( RESULT_SINK * sink );
+long merge_results( const char * out_name, const char ** in_names, long Nin );
+
+/* Part of every result cache key; change it whenever a change to the
+   model moves scores, so that results stored before are not reused. */
+#define RESULT_CACHE_VERSION    "P.862 1.2 cache 1"
+
+typedef unsigned long long CACHE_WORD;
+
+int  result_cache_open( const char * path_name );
+void result_cache_close( void );
+int  result_cache_enabled( void );
+void result_cache_share( void );
+void result_cache_sync( void );
+void result_cache_key( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, int triage,
+     CACHE_WORD * key );
+int  result_cache_find( const CACHE_WORD * key, ERROR_INFO * err_info );
+void result_cache_store( const CACHE_WORD * key, ERROR_INFO * err_info );
+
+void synth_pair( int kind, long sample_rate, double seconds, unsigned long seed,
+     float ** ref, float ** deg, long * Nref, long * Ndeg );
+
+void profile_reset( void );
+void profile_start( int stage );
+void profile_stop( int stage );
+void profile_checksum( int which, const float * x, long n );
+
+int  trace_open( const char * path_name );
+void trace_values( int kind, long index, int Nvalues, ... );
+void trace_array( int kind, const float * x, long n );
+void trace_utterances( ERROR_INFO * err_info );
+void trace_flush( void );
+
+float power_level_gain( SIGNAL_INFO * info, long maxNsamples );
+void align_pair( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     ERROR_INFO * err_info, float * ftmp, int triage );
+void pesq_measure( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type );
+void pesq_process( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type );
+void pesq_triage( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type );
+void pesq_triage_process( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type );
+void measure_pair( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     ERROR_INFO * err_info, RESULT_SINK * sink,
+     long * Error_Flag, char ** Error_Type );
+void triage_pair( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     ERROR_INFO * err_info, RESULT_SINK * sink, float threshold,
+     long * Error_Flag, char ** Error_Type );
+void measure_channels( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     ERROR_INFO * err_info, RESULT_SINK * sink,
+     long * Error_Flag, char ** Error_Type );
+long pair_footprint( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info );
+long start_pair_job( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     ERROR_INFO * err_info, RESULT_SINK * sink, int triage, float threshold );
+long wait_pair_job( ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type );
+
+SRC_STREAM * open_src_stream( long * Error_Flag, char ** Error_Type,
+     SIGNAL_INFO * sinfo );
+long read_src_stream( SRC_STREAM * stream, SIGNAL_INFO * sinfo,
+     float * samples, long Nsamples );
+void close_src_stream( SRC_STREAM * stream );
+
+LIVE_INFO * live_open( double window_seconds, double hop_seconds,
+     long * Error_Flag, char ** Error_Type );
+int  live_push( LIVE_INFO * live, const float * ref, long Nref,
+     const float * deg, long Ndeg );
+void live_end( LIVE_INFO * live );
+int  live_score( LIVE_INFO * live, ERROR_INFO * err_info );
+void live_close( LIVE_INFO * live );
+void live_measure( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     double window_seconds, double hop_seconds, RESULT_SINK * sink,
+     long * Error_Flag, char ** Error_Type );
+
+FILE * serve_redirect_stdout( void );
+int  serve_stream( FILE * in, FILE * out, RESULT_SINK * sink,
+     long sample_rate, long apply_swap, long input_rate );
+int  serve_socket( const char * socket_path, RESULT_SINK * sink,
+     long sample_rate, long apply_swap, long input_rate );
+
+
+
+#define     D_POW_F     2
+#define     D_POW_S     6
+#define     D_POW_T     2
+
+#define     A_POW_F     1
+#define     A_POW_S     6
+#define     A_POW_T     2
+
+
+#define     D_WEIGHT    0.1
+#define     A_WEIGHT    0.0309
+
+/* END OF FILE */
+
@@ -0,0 +1,285 @@
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
+the terms Perceptual Evaluation of Speech Quality Algorithm?
+and PESQ Algorithm?refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term PESQ Software?refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "pesq.h"
+#include "dsp.h"
+
+/* Benchmark: scores the synthetic pairs of pesqgen.c with pesq_process
+   and writes pairs per second, per-stage times and peak heap use as
+   JSON. Build from every source file except pesqmain.c. */
+
+#define BENCH_RESULTS_FILE  "_pesq_bench.json"
+#define BENCH_MAXLENGTHS    8
+
+void usage (void) {
+    printf ("Usage:\n");
+    printf (" PESQBENCH [options] [output]\n");
+    printf (" Score deterministic synthetic pairs and write timings as JSON to output,\n");
+    printf (" %s by default or standard output for '-'.\n", BENCH_RESULTS_FILE);
+    printf ("\n");
+    printf ("Options: +8000 +16000 +iterations=N +seconds=a,b,...\n");
+    printf (" Sample rate - both rates unless one is selected.\n");
+    printf (" Iterations - times each pair is scored, 3 by default.\n");
+    printf (" Seconds - signal lengths, 4,8,16 by default.\n");
+}
+
+static void bench_case (FILE * out, int first, long sample_rate, int kind, double seconds,
+    long iterations, double * total_time, long * total_pairs, long * total_peak)
+{
+    SIGNAL_INFO ref_info;
+    SIGNAL_INFO deg_info;
+    ERROR_INFO  err_info;
+    double      stage_time [PROFILE_STAGES];
+    double      elapsed = 0;
+    long        peak = 0;
+    long        Nref, Ndeg;
+    float      *ref, *deg;
+    long        Error_Flag = 0;
+    char       *Error_Type = "Unknown error type.";
+    long        it;
+    int         stage;
+
+    select_rate (sample_rate, &Error_Flag, &Error_Type);
+    synth_pair (kind, sample_rate, seconds, (unsigned long) (kind * 1000 + seconds * 10),
+                &ref, &deg, &Nref, &Ndeg);
+
+    for (stage = 0; stage < PROFILE_STAGES; stage++) {
+        stage_time [stage] = 0;
+    }
+
+    for (it = 0; (it < iterations) && (Error_Flag == 0); it++) {
+        double start_time;
+
+        sprintf (ref_info. path_name, "synth:%s:%.0f:ref", Synth_Kind_Name [kind], seconds);
+        sprintf (deg_info. path_name, "synth:%s:%.0f:deg", Synth_Kind_Name [kind], seconds);
+        err_info. subj_mos = 0;
+        err_info. cond_nr = 0;
+
+        profile_reset ();
+        start_time = wall_clock ();
+
+        profile_start (PROFILE_LOAD);
+        load_samples (&Error_Flag, &Error_Type, &ref_info, ref, Nref);
+        if (Error_Flag == 0) {
+            load_samples (&Error_Flag, &Error_Type, &deg_info, deg, Ndeg);
+        }
+        profile_stop (PROFILE_LOAD);
+
+        if (Error_Flag == 0) {
+            pesq_process (&ref_info, &deg_info, &err_info, &Error_Flag, &Error_Type);
+        }
+
+        elapsed += wall_clock () - start_time;
+        peak = max (peak, heap_peak);
+        for (stage = 0; stage < PROFILE_STAGES; stage++) {
+            stage_time [stage] += Profile. stage_time [stage];
+        }
+    }
+
+    safe_free (ref);
+    safe_free (deg);
+
+    fprintf (out, "%s\n  {\"name\":\"%s\",\"sample_freq\":%ld,\"seconds\":%.1f,",
+             first ? "" : ",", Synth_Kind_Name [kind], sample_rate, seconds);
+    if (Error_Flag != 0) {
+        fprintf (out, "\"error\":%ld,\"message\":\"%s\"}", Error_Flag, Error_Type);
+        fprintf (stderr, "%-12s %5ld Hz %5.1f s  error %ld (%s)\n",
+                 Synth_Kind_Name [kind], sample_rate, seconds, Error_Flag, Error_Type);
+        return;
+    }
+
+    fprintf (out, "\"pesq_mos\":%.3f,\"pairs\":%ld,\"time\":%.6f,\"pairs_per_sec\":%.3f,",
+             err_info. pesq_mos, iterations, elapsed, iterations / elapsed);
+    fprintf (out, "\"utterances\":%ld,\"bad_intervals\":%ld,\"peak_heap\":%ld,\"stages\":{",
+             Profile. Nutterances, Profile. Nbad_intervals, peak);
+    for (stage = 0; stage < PROFILE_STAGES; stage++) {
+        fprintf (out, "%s\"%s\":%.6f", (stage == 0) ? "" : ",",
+                 Profile_Stage_Name [stage], stage_time [stage] / iterations);
+    }
+    fprintf (out, "}}");
+
+    fprintf (stderr, "%-12s %5ld Hz %5.1f s  MOS %.3f  %8.3f pairs/s  peak %ld bytes\n",
+             Synth_Kind_Name [kind], sample_rate, seconds, err_info. pesq_mos,
+             iterations / elapsed, peak);
+
+    *total_time += elapsed;
+    *total_pairs += iterations;
+    *total_peak = max (*total_peak, peak);
+}
+
+int main (int argc, const char *argv []) {
+    long        rates [2] = {8000L, 16000L};
+    long        Nrates = 2;
+    double      seconds [BENCH_MAXLENGTHS] = {4, 8, 16};
+    long        Nlengths = 3;
+    long        iterations = 3;
+    const char *output_name = BENCH_RESULTS_FILE;
+    FILE       *out;
+    double      total_time = 0;
+    long        total_pairs = 0;
+    long        total_peak = 0;
+    int         first = 1;
+    int         arg;
+    long        r, l;
+    int         kind;
+
+    for (arg = 1; arg < argc; arg++) {
+        if (strcmp (argv [arg], "+8000") == 0) {
+            rates [0] = 8000L;
+            Nrates = 1;
+        } else if (strcmp (argv [arg], "+16000") == 0) {
+            rates [0] = 16000L;
+            Nrates = 1;
+        } else if (strncmp (argv [arg], "+iterations=", 12) == 0) {
+            iterations = atol (argv [arg] + 12);
+        } else if (strncmp (argv [arg], "+seconds=", 9) == 0) {
+            const char *p = argv [arg] + 9;
+            Nlengths = 0;
+            while ((*p != '\0') && (Nlengths < BENCH_MAXLENGTHS)) {
+                seconds [Nlengths++] = atof (p);
+                while ((*p != '\0') && (*p != ',')) p++;
+                if (*p == ',') p++;
+            }
+        } else if ((argv [arg][0] == '+') || (strcmp (argv [arg], "HELP") == 0)) {
+            usage ();
+            return 1;
+        } else {
+            output_name = argv [arg];
+        }
+    }
+    if ((iterations < 1) || (Nlengths < 1)) {
+        usage ();
+        return 1;
+    }
+
+    if (strcmp (output_name, "-") == 0) {
+        out = serve_redirect_stdout ();
+    } else {
+        out = fopen (output_name, "wt");
+    }
+    if (out == NULL) {
+        fprintf (stderr, "Could not open benchmark output %s.\n", output_name);
+        return 1;
+    }
+
+    fprintf (out, "{\"benchmark\":\"pesq\",\"iterations\":%ld,\"cases\":[", iterations);
+
+    for (r = 0; r < Nrates; r++) {
+        for (kind = 0; kind < SYNTH_KINDS; kind++) {
+            for (l = 0; l < Nlengths; l++) {
+                bench_case (out, first, rates [r], kind, seconds [l], iterations,
+                            &total_time, &total_pairs, &total_peak);
+                first = 0;
+            }
+        }
+    }
+
+    fprintf (out, "\n],\"total\":{\"pairs\":%ld,\"time\":%.6f,\"pairs_per_sec\":%.3f,\"peak_heap\":%ld}}\n",
+             total_pairs, total_time, (total_time > 0) ? total_pairs / total_time : 0.0, total_peak);
+    fclose (out);
+
+    return 0;
+}
+
+/* END OF FILE */
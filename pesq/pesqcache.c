@@ -0,0 +1,480 @@
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
+the terms Perceptual Evaluation of Speech Quality Algorithm?
+and PESQ Algorithm?refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term PESQ Software?refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "pesq.h"
+#include "dsp.h"
+
+/* Results on disk, keyed by the content of a pair. The cache is two files:
+
+   - path, an append-only log of fixed-size records, each holding the key
+     of a pair and what write_results needs of its ERROR_INFO;
+   - path.idx, an open addressing table of RESULT_CACHE_SLOT, each slot
+     the upper half of a key and the record number plus one, with the
+     number of slots and of records indexed in front.
+
+   A lookup reads a slot or two and one record, whatever the size of the
+   log. The index is only ever a summary of the log: records appended by
+   another process are indexed on the next lookup, and when the index is
+   missing, damaged or half full it is rebuilt from the log. Only one
+   process should write to a cache at a time, other than the workers of a
+   batch, which only append to the log (see result_cache_share). */
+
+#define RESULT_CACHE_MAGIC      0x43514550UL
+#define RESULT_CACHE_MIN_SLOTS  65536UL
+
+typedef struct {
+    CACHE_WORD    key [2];
+    float         pesq_mos;
+    float         pesq_mos_error;
+    int           Crude_DelayEst;
+    int           Nutterances;
+    int           Utt_Delay [MAXNUTTERANCES];
+} RESULT_CACHE_RECORD;
+
+typedef struct {
+    unsigned int  tag;
+    unsigned int  record;
+} RESULT_CACHE_SLOT;
+
+typedef struct {
+    unsigned int  magic;
+    unsigned int  Nslots;
+    CACHE_WORD    Nindexed;
+} RESULT_CACHE_HEADER;
+
+#ifdef _WIN32
+  #define cache_seek(f, o)  _fseeki64 ((f), (__int64) (o), SEEK_SET)
+  #define cache_tell(f)     ((CACHE_WORD) _ftelli64 (f))
+#else
+  #define cache_seek(f, o)  fseeko ((f), (off_t) (o), SEEK_SET)
+  #define cache_tell(f)     ((CACHE_WORD) ftello (f))
+#endif
+
+char                Result_Cache_Path [512];
+FILE              * Result_Cache_Log = NULL;
+FILE              * Result_Cache_Index = NULL;
+RESULT_CACHE_HEADER Result_Cache_Header;
+int                 Result_Cache_Shared = 0;
+
+static CACHE_WORD cache_mix( CACHE_WORD h )
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/* Two independent 64 bit lanes over x, a 32 bit word at a time. */
+
+static void cache_hash( CACHE_WORD * key, const void * x, long Nbytes )
+{
+    const unsigned char * p = (const unsigned char *) x;
+    long                  i;
+    int                   k;
+
+    for (i = 0; i < Nbytes; i += 4, p += 4) {
+        CACHE_WORD w = 0;
+        for (k = 0; (k < 4) && (i + k < Nbytes); k++) {
+            w |= (CACHE_WORD) p [k] << (8 * k);
+        }
+        key [0] = (key [0] ^ w) * 0x100000001B3ULL;
+        key [1] = (key [1] + w * 0x9E3779B97F4A7C15ULL);
+        key [1] = ((key [1] << 31) | (key [1] >> 33)) * 0x87C37B91114253D5ULL;
+    }
+}
+
+static CACHE_WORD cache_records( void )
+{
+    fseek (Result_Cache_Log, 0, SEEK_END);
+    return cache_tell (Result_Cache_Log) / sizeof (RESULT_CACHE_RECORD);
+}
+
+static int cache_read_record( CACHE_WORD n, RESULT_CACHE_RECORD * record )
+{
+    return (cache_seek (Result_Cache_Log, n * sizeof (RESULT_CACHE_RECORD)) != 0) ||
+           (fread (record, sizeof (RESULT_CACHE_RECORD), 1, Result_Cache_Log) != 1);
+}
+
+static int cache_write_header( void )
+{
+    return (cache_seek (Result_Cache_Index, 0) != 0) ||
+           (fwrite (&Result_Cache_Header, sizeof (Result_Cache_Header), 1, Result_Cache_Index) != 1);
+}
+
+/* Enters record n under key, probing linearly from the slot the lower
+   half of the key selects. */
+
+static int cache_index_record( const CACHE_WORD * key, CACHE_WORD n )
+{
+    unsigned int      mask = Result_Cache_Header. Nslots - 1;
+    unsigned int      slot = (unsigned int) key [0] & mask;
+    RESULT_CACHE_SLOT entry;
+
+    for (;;) {
+        CACHE_WORD offset = sizeof (RESULT_CACHE_HEADER) + (CACHE_WORD) slot * sizeof (RESULT_CACHE_SLOT);
+        if ((cache_seek (Result_Cache_Index, offset) != 0) ||
+            (fread (&entry, sizeof (entry), 1, Result_Cache_Index) != 1)) {
+            return -1;
+        }
+        if (entry. record == 0) {
+            entry. tag = (unsigned int) (key [1] >> 32);
+            entry. record = (unsigned int) (n + 1);
+            if ((cache_seek (Result_Cache_Index, offset) != 0) ||
+                (fwrite (&entry, sizeof (entry), 1, Result_Cache_Index) != 1)) {
+                return -1;
+            }
+            return 0;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+/* Writes an empty index of Nslots and enters every record of the log. */
+
+static int cache_rebuild_index( unsigned int Nslots )
+{
+    char                index_path [sizeof (Result_Cache_Path) + 8];
+    RESULT_CACHE_SLOT   empty = {0, 0};
+    RESULT_CACHE_RECORD record;
+    CACHE_WORD          Nrecords = cache_records ();
+    CACHE_WORD          n;
+    unsigned int        slot;
+
+    while ((CACHE_WORD) Nslots < 2 * (Nrecords + 1)) {
+        Nslots <<= 1;
+    }
+
+    sprintf (index_path, "%s.idx", Result_Cache_Path);
+    if (Result_Cache_Index != NULL) {
+        fclose (Result_Cache_Index);
+    }
+    Result_Cache_Index = fopen (index_path, "w+b");
+    if (Result_Cache_Index == NULL) {
+        return -1;
+    }
+
+    Result_Cache_Header. magic = RESULT_CACHE_MAGIC;
+    Result_Cache_Header. Nslots = Nslots;
+    Result_Cache_Header. Nindexed = 0;
+    if (cache_write_header () != 0) {
+        return -1;
+    }
+    for (slot = 0; slot < Nslots; slot++) {
+        if (fwrite (&empty, sizeof (empty), 1, Result_Cache_Index) != 1) {
+            return -1;
+        }
+    }
+
+    for (n = 0; n < Nrecords; n++) {
+        if ((cache_read_record (n, &record) != 0) || (cache_index_record (record. key, n) != 0)) {
+            return -1;
+        }
+    }
+    Result_Cache_Header. Nindexed = Nrecords;
+    return cache_write_header ();
+}
+
+/* Indexes records appended since the index was last brought up to date,
+   growing it first if that would leave it more than half full. */
+
+static int cache_catch_up( void )
+{
+    RESULT_CACHE_RECORD record;
+    CACHE_WORD          Nrecords = cache_records ();
+    CACHE_WORD          n;
+
+    if (Result_Cache_Shared || (Nrecords == Result_Cache_Header. Nindexed)) {
+        return 0;
+    }
+    if ((Nrecords < Result_Cache_Header. Nindexed) ||
+        (2 * (Nrecords + 1) > (CACHE_WORD) Result_Cache_Header. Nslots)) {
+        return cache_rebuild_index (Result_Cache_Header. Nslots);
+    }
+    for (n = Result_Cache_Header. Nindexed; n < Nrecords; n++) {
+        if ((cache_read_record (n, &record) != 0) || (cache_index_record (record. key, n) != 0)) {
+            return -1;
+        }
+    }
+    Result_Cache_Header. Nindexed = Nrecords;
+    return cache_write_header ();
+}
+
+void result_cache_close( void )
+{
+    if (Result_Cache_Log != NULL) {
+        fclose (Result_Cache_Log);
+    }
+    if (Result_Cache_Index != NULL) {
+        fclose (Result_Cache_Index);
+    }
+    Result_Cache_Log = NULL;
+    Result_Cache_Index = NULL;
+}
+
+/* Opens, or creates, the cache at path_name. Returns 0 on success. */
+
+int result_cache_open( const char * path_name )
+{
+    char index_path [sizeof (Result_Cache_Path) + 8];
+    int  usable;
+
+    result_cache_close ();
+    if (strlen (path_name) >= sizeof (Result_Cache_Path)) {
+        return -1;
+    }
+    strcpy (Result_Cache_Path, path_name);
+    sprintf (index_path, "%s.idx", Result_Cache_Path);
+
+    Result_Cache_Log = fopen (path_name, "a+b");
+    if (Result_Cache_Log == NULL) {
+        return -1;
+    }
+
+    Result_Cache_Index = fopen (index_path, "r+b");
+    usable = (Result_Cache_Index != NULL) &&
+             (fread (&Result_Cache_Header, sizeof (Result_Cache_Header), 1, Result_Cache_Index) == 1) &&
+             (Result_Cache_Header. magic == RESULT_CACHE_MAGIC) &&
+             (Result_Cache_Header. Nslots >= RESULT_CACHE_MIN_SLOTS) &&
+             ((Result_Cache_Header. Nslots & (Result_Cache_Header. Nslots - 1)) == 0);
+
+    if ((usable ? cache_catch_up () : cache_rebuild_index (RESULT_CACHE_MIN_SLOTS)) != 0) {
+        result_cache_close ();
+        return -1;
+    }
+    return 0;
+}
+
+/* Makes this process a worker on a cache owned by the process that forked
+   it. Both files are opened afresh, so that no file position is shared
+   with the owner, and from then on the log is only appended to and the
+   index only read: records appended since the owner last indexed them are
+   not found here. The owner picks them up with result_cache_sync. */
+
+void result_cache_share( void )
+{
+    char index_path [sizeof (Result_Cache_Path) + 8];
+
+    if (Result_Cache_Log == NULL) {
+        return;
+    }
+    result_cache_close ();
+    sprintf (index_path, "%s.idx", Result_Cache_Path);
+    Result_Cache_Shared = 1;
+    Result_Cache_Log = fopen (Result_Cache_Path, "a+b");
+    Result_Cache_Index = fopen (index_path, "rb");
+    if ((Result_Cache_Log == NULL) || (Result_Cache_Index == NULL) ||
+        (fread (&Result_Cache_Header, sizeof (Result_Cache_Header), 1, Result_Cache_Index) != 1) ||
+        (Result_Cache_Header. magic != RESULT_CACHE_MAGIC)) {
+        result_cache_close ();
+    }
+}
+
+/* Indexes what workers have appended to the log. */
+
+void result_cache_sync( void )
+{
+    if (Result_Cache_Log != NULL) {
+        cache_catch_up ();
+    }
+}
+
+int result_cache_enabled( void )
+{
+    return Result_Cache_Log != NULL;
+}
+
+/* The key of a loaded pair: its samples as scored, the model rate, the
+   software version and whether the result is a triage estimate. */
+
+void result_cache_key( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, int triage,
+     CACHE_WORD * key )
+{
+    static const char version [] = RESULT_CACHE_VERSION;
+    long              setup [4];
+
+    setup [0] = Fs;
+    setup [1] = triage;
+    setup [2] = ref_info-> Nsamples;
+    setup [3] = deg_info-> Nsamples;
+
+    key [0] = 0xCBF29CE484222325ULL;
+    key [1] = 0x52DCE729DA3ED18DULL;
+    cache_hash (key, version, (long) sizeof (version));
+    cache_hash (key, setup, (long) sizeof (setup));
+    cache_hash (key, ref_info-> data, ref_info-> Nsamples * (long) sizeof (float));
+    cache_hash (key, deg_info-> data, deg_info-> Nsamples * (long) sizeof (float));
+    key [0] = cache_mix (key [0] ^ key [1]);
+    key [1] = cache_mix (key [1] + key [0]);
+}
+
+/* Fills the results in err_info and returns 1 if key is in the cache. */
+
+int result_cache_find( const CACHE_WORD * key, ERROR_INFO * err_info )
+{
+    unsigned int        mask;
+    unsigned int        slot;
+    RESULT_CACHE_SLOT   entry;
+    RESULT_CACHE_RECORD record;
+    long                utt;
+
+    if ((Result_Cache_Log == NULL) || (cache_catch_up () != 0)) {
+        return 0;
+    }
+
+    mask = Result_Cache_Header. Nslots - 1;
+    for (slot = (unsigned int) key [0] & mask; ; slot = (slot + 1) & mask) {
+        if ((cache_seek (Result_Cache_Index, sizeof (RESULT_CACHE_HEADER) +
+                         (CACHE_WORD) slot * sizeof (RESULT_CACHE_SLOT)) != 0) ||
+            (fread (&entry, sizeof (entry), 1, Result_Cache_Index) != 1) ||
+            (entry. record == 0)) {
+            return 0;
+        }
+        if ((entry. tag == (unsigned int) (key [1] >> 32)) &&
+            (cache_read_record (entry. record - 1, &record) == 0) &&
+            (record. key [0] == key [0]) && (record. key [1] == key [1])) {
+            break;
+        }
+    }
+
+    err_info-> pesq_mos = record. pesq_mos;
+    err_info-> pesq_mos_error = record. pesq_mos_error;
+    err_info-> Crude_DelayEst = record. Crude_DelayEst;
+    err_info-> Nutterances = min (max (record. Nutterances, 0), MAXNUTTERANCES);
+    for (utt = 0; utt < err_info-> Nutterances; utt++) {
+        err_info-> Utt_Delay [utt] = record. Utt_Delay [utt];
+    }
+    return 1;
+}
+
+/* Appends the results of err_info under key and indexes them. */
+
+void result_cache_store( const CACHE_WORD * key, ERROR_INFO * err_info )
+{
+    RESULT_CACHE_RECORD record;
+    long                utt;
+
+    if ((Result_Cache_Log == NULL) || (cache_catch_up () != 0)) {
+        return;
+    }
+
+    memset (&record, 0, sizeof (record));
+    record. key [0] = key [0];
+    record. key [1] = key [1];
+    record. pesq_mos = err_info-> pesq_mos;
+    record. pesq_mos_error = err_info-> pesq_mos_error;
+    record. Crude_DelayEst = (int) err_info-> Crude_DelayEst;
+    record. Nutterances = (int) err_info-> Nutterances;
+    for (utt = 0; utt < err_info-> Nutterances; utt++) {
+        record. Utt_Delay [utt] = (int) err_info-> Utt_Delay [utt];
+    }
+
+    fseek (Result_Cache_Log, 0, SEEK_END);
+    if ((fwrite (&record, sizeof (record), 1, Result_Cache_Log) == 1) &&
+        (fflush (Result_Cache_Log) == 0)) {
+        cache_catch_up ();
+    }
+}
+
+/* END OF FILE */
@@ -0,0 +1,543 @@
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
+the terms Perceptual Evaluation of Speech Quality Algorithm?
+and PESQ Algorithm?refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term PESQ Software?refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "pesq.h"
+#include "dsp.h"
+
+/* FLAC decoder for the source loader. It handles everything the format
+   allows for up to 24 bit samples: constant, verbatim, fixed and LPC
+   subframes, wasted bits, both residual coding methods with escaped
+   partitions and the three stereo decorrelation modes. One channel of
+   the stream is returned as float, scaled to the 16 bit range used for
+   PCM input. Frame CRCs are not checked. */
+
+#define FLAC_MAXBLOCK       65535
+#define FLAC_MAXCHANNELS    8
+#define FLAC_MAXORDER       32
+
+typedef struct {
+    const unsigned char * p;
+    long                  n;
+    long                  pos;
+    int                   bit;
+    int                   error;
+} FLAC_READER;
+
+static unsigned long flac_bits (FLAC_READER * r, int n)
+{
+    unsigned long value = 0;
+
+    while (n > 0) {
+        int avail, take;
+
+        if (r-> pos >= r-> n) {
+            r-> error = 1;
+            return 0;
+        }
+        avail = 8 - r-> bit;
+        take = (n < avail) ? n : avail;
+        value = (value << take) | ((r-> p [r-> pos] >> (avail - take)) & ((1U << take) - 1));
+        r-> bit += take;
+        if (r-> bit == 8) {
+            r-> bit = 0;
+            r-> pos++;
+        }
+        n -= take;
+    }
+    return value;
+}
+
+static long flac_signed (FLAC_READER * r, int n)
+{
+    unsigned long value;
+
+    if (n == 0) {
+        return 0;
+    }
+    value = flac_bits (r, n);
+    if (value & (1UL << (n - 1))) {
+        return (long) value - (long) (1UL << (n - 1)) - (long) (1UL << (n - 1));
+    }
+    return (long) value;
+}
+
+static unsigned long flac_unary (FLAC_READER * r)
+{
+    unsigned long zeros = 0;
+
+    while (!r-> error) {
+        if ((r-> bit == 0) && (r-> pos < r-> n) && (r-> p [r-> pos] == 0)) {
+            zeros += 8;
+            r-> pos++;
+            continue;
+        }
+        if (flac_bits (r, 1)) {
+            break;
+        }
+        zeros++;
+    }
+    return zeros;
+}
+
+static void flac_align (FLAC_READER * r)
+{
+    if (r-> bit != 0) {
+        r-> bit = 0;
+        r-> pos++;
+    }
+}
+
+static int flac_residual (FLAC_READER * r, long * res, long blocksize, int order)
+{
+    int  method = (int) flac_bits (r, 2);
+    int  param_bits = (method == 0) ? 4 : 5;
+    int  escape = (method == 0) ? 15 : 31;
+    int  partition_order = (int) flac_bits (r, 4);
+    long partitions = 1L << partition_order;
+    long p, i, k = 0;
+
+    if ((method > 1) || ((blocksize >> partition_order) < order)) {
+        return -1;
+    }
+
+    for (p = 0; p < partitions; p++) {
+        long n = (blocksize >> partition_order) - ((p == 0) ? order : 0);
+        int  param = (int) flac_bits (r, param_bits);
+
+        if (param == escape) {
+            int raw = (int) flac_bits (r, 5);
+            for (i = 0; i < n; i++) {
+                res [k++] = flac_signed (r, raw);
+            }
+        } else {
+            for (i = 0; i < n; i++) {
+                unsigned long u = (flac_unary (r) << param) | flac_bits (r, param);
+                res [k++] = (long) (u >> 1) ^ -(long) (u & 1);
+            }
+        }
+        if (r-> error) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int flac_subframe (FLAC_READER * r, long * x, long blocksize, int bps)
+{
+    int  type;
+    int  wasted = 0;
+    int  order;
+    long i, j;
+
+    if (flac_bits (r, 1) != 0) {
+        return -1;
+    }
+    type = (int) flac_bits (r, 6);
+    if (flac_bits (r, 1)) {
+        wasted = 1 + (int) flac_unary (r);
+        bps -= wasted;
+    }
+    if ((bps < 1) || (bps > 32)) {
+        return -1;
+    }
+
+    if (type == 0) {
+        long value = flac_signed (r, bps);
+        for (i = 0; i < blocksize; i++) {
+            x [i] = value;
+        }
+    } else if (type == 1) {
+        for (i = 0; i < blocksize; i++) {
+            x [i] = flac_signed (r, bps);
+        }
+    } else if ((type >= 8) && (type <= 12)) {
+        order = type - 8;
+        for (i = 0; i < order; i++) {
+            x [i] = flac_signed (r, bps);
+        }
+        if (flac_residual (r, x + order, blocksize, order) != 0) {
+            return -1;
+        }
+        for (i = order; i < blocksize; i++) {
+            switch (order) {
+            case 1: x [i] += x [i-1]; break;
+            case 2: x [i] += 2 * x [i-1] - x [i-2]; break;
+            case 3: x [i] += 3 * x [i-1] - 3 * x [i-2] + x [i-3]; break;
+            case 4: x [i] += 4 * x [i-1] - 6 * x [i-2] + 4 * x [i-3] - x [i-4]; break;
+            }
+        }
+    } else if (type >= 32) {
+        long   coef [FLAC_MAXORDER];
+        int    precision;
+        int    shift;
+        double scale;
+
+        order = type - 31;
+        for (i = 0; i < order; i++) {
+            x [i] = flac_signed (r, bps);
+        }
+        precision = (int) flac_bits (r, 4) + 1;
+        shift = (int) flac_signed (r, 5);
+        if ((precision == 16) || (shift < 0)) {
+            return -1;
+        }
+        for (i = 0; i < order; i++) {
+            coef [i] = flac_signed (r, precision);
+        }
+        if (flac_residual (r, x + order, blocksize, order) != 0) {
+            return -1;
+        }
+        /* the prediction needs more than 32 bits; a double holds it exactly */
+        scale = ldexp (1.0, -shift);
+        for (i = order; i < blocksize; i++) {
+            double sum = 0;
+            for (j = 0; j < order; j++) {
+                sum += (double) coef [j] * x [i - 1 - j];
+            }
+            x [i] += (long) floor (sum * scale);
+        }
+    } else {
+        return -1;
+    }
+
+    if (wasted > 0) {
+        for (i = 0; i < blocksize; i++) {
+            x [i] <<= wasted;
+        }
+    }
+    return r-> error ? -1 : 0;
+}
+
+static long flac_block_size (FLAC_READER * r, int code)
+{
+    if (code == 1) return 192;
+    if ((code >= 2) && (code <= 5)) return 576L << (code - 2);
+    if (code == 6) return (long) flac_bits (r, 8) + 1;
+    if (code == 7) return (long) flac_bits (r, 16) + 1;
+    if (code >= 8) return 256L << (code - 8);
+    return -1;
+}
+
+/* Decodes channel of a FLAC stream held in bytes, or every channel
+   interleaved for FLAC_ALL_CHANNELS. Returns 0 and the samples, their
+   count per channel, rate and the number of channels, or -1 with samples
+   NULL if the stream cannot be decoded. */
+
+/* Reads the metadata blocks in front of the first frame, leaving r at the
+   frame, and returns the STREAMINFO fields the decoder needs; size is 0
+   when the stream does not say how many samples it holds. */
+
+static int flac_metadata (FLAC_READER * r, const unsigned char * bytes, long Nbytes,
+    long * size, long * stream_rate, long * stream_channels, int * stream_bps)
+{
+    int last = 0;
+
+    r-> p = bytes;
+    r-> n = Nbytes;
+    r-> pos = 0;
+    r-> bit = 0;
+    r-> error = 0;
+    *size = 0;
+    *stream_rate = 0;
+    *stream_channels = 0;
+    *stream_bps = 0;
+
+    if ((Nbytes > 10) && (memcmp (bytes, "ID3", 3) == 0)) {
+        r-> pos = 10 + ((bytes [6] & 0x7F) << 21) + ((bytes [7] & 0x7F) << 14) +
+                       ((bytes [8] & 0x7F) << 7) + (bytes [9] & 0x7F);
+    }
+    if ((r-> pos + 4 > Nbytes) || (memcmp (bytes + r-> pos, "fLaC", 4) != 0)) {
+        return -1;
+    }
+    r-> pos += 4;
+
+    while (!last && !r-> error) {
+        int  type;
+        long length;
+
+        last = (int) flac_bits (r, 1);
+        type = (int) flac_bits (r, 7);
+        length = (long) flac_bits (r, 24);
+        if (type == 0) {
+            long start = r-> pos;
+            flac_bits (r, 16);
+            flac_bits (r, 16);
+            flac_bits (r, 24);
+            flac_bits (r, 24);
+            *stream_rate = (long) flac_bits (r, 20);
+            *stream_channels = (long) flac_bits (r, 3) + 1;
+            *stream_bps = (int) flac_bits (r, 5) + 1;
+            flac_bits (r, 4);
+            *size = (long) flac_bits (r, 32);
+            r-> pos = start;
+        }
+        r-> pos += length;
+    }
+    if (r-> error || (r-> pos > Nbytes) || (*stream_channels == 0) || (*stream_bps > 24)) {
+        return -1;
+    }
+    return 0;
+}
+
+/* The length, rate and channel count of a stream from its metadata alone,
+   which need be the only part of it in bytes. Returns -1 when they are not
+   there or the stream does not give its length. */
+
+int flac_info( const unsigned char * bytes, long Nbytes,
+     long * Nsamples, long * sample_rate, long * channels )
+{
+    FLAC_READER r;
+    int         bps;
+
+    if ((flac_metadata (&r, bytes, Nbytes, Nsamples, sample_rate, channels, &bps) != 0) ||
+        ((*Nsamples) == 0)) {
+        return -1;
+    }
+    return 0;
+}
+
+int flac_decode( const unsigned char * bytes, long Nbytes, long channel,
+     float ** samples, long * Nsamples, long * sample_rate, long * channels )
+{
+    static const int sample_size [8] = {0, 8, 12, 0, 16, 20, 24, 32};
+    FLAC_READER r;
+    long       *x [FLAC_MAXCHANNELS];
+    long        size = 0;
+    long        used = 0;
+    float      *out = NULL;
+    long        stream_rate = 0;
+    long        stream_channels = 0;
+    long        Nout;
+    int         stream_bps = 0;
+    int         ch;
+    long        i;
+
+    *samples = NULL;
+    if ((flac_metadata (&r, bytes, Nbytes, &size, &stream_rate, &stream_channels, &stream_bps) != 0) ||
+        (channel >= stream_channels)) {
+        return -1;
+    }
+
+    for (ch = 0; ch < FLAC_MAXCHANNELS; ch++) {
+        x [ch] = (long *) safe_malloc (FLAC_MAXBLOCK * sizeof (long));
+    }
+    size = (size > 0) ? size : FLAC_MAXBLOCK;
+    Nout = (channel == FLAC_ALL_CHANNELS) ? stream_channels : 1;
+    out = (float *) safe_malloc (size * Nout * sizeof (float));
+
+    while ((r. pos + 2 <= Nbytes) && (out != NULL)) {
+        int    block_code, rate_code, assignment, size_code;
+        long   blocksize;
+        long   Nchannels;
+        int    bps;
+        double scale;
+
+        if ((flac_bits (&r, 14) != 0x3FFE) || r. error) {
+            /* anything after the last frame, such as an ID3v1 tag, is ignored */
+            r. error = (used == 0);
+            break;
+        }
+        flac_bits (&r, 2);
+        block_code = (int) flac_bits (&r, 4);
+        rate_code = (int) flac_bits (&r, 4);
+        assignment = (int) flac_bits (&r, 4);
+        size_code = (int) flac_bits (&r, 3);
+        flac_bits (&r, 1);
+
+        i = (long) flac_bits (&r, 8);
+        while (i & 0x80) {
+            if ((i & 0x40) == 0) {
+                break;
+            }
+            flac_bits (&r, 8);
+            i = (i << 1) & 0xFF;
+        }
+
+        blocksize = flac_block_size (&r, block_code);
+        if (rate_code == 12) {
+            flac_bits (&r, 8);
+        } else if ((rate_code == 13) || (rate_code == 14)) {
+            flac_bits (&r, 16);
+        }
+        flac_bits (&r, 8);
+
+        Nchannels = (assignment < 8) ? assignment + 1 : 2;
+        bps = (size_code == 0) ? stream_bps : sample_size [size_code];
+        if ((blocksize < 1) || (blocksize > FLAC_MAXBLOCK) || (assignment > 10) ||
+            (Nchannels != stream_channels) || (bps == 0) || (bps > 24) || r. error) {
+            r. error = 1;
+            break;
+        }
+
+        for (ch = 0; ch < Nchannels; ch++) {
+            int side = ((assignment == 8) && (ch == 1)) || ((assignment == 9) && (ch == 0)) ||
+                       ((assignment == 10) && (ch == 1));
+            if (flac_subframe (&r, x [ch], blocksize, bps + side) != 0) {
+                r. error = 1;
+                break;
+            }
+        }
+        if (r. error) {
+            break;
+        }
+        flac_align (&r);
+        flac_bits (&r, 16);
+
+        for (i = 0; i < blocksize; i++) {
+            long a = x [0][i];
+            long b = (Nchannels > 1) ? x [1][i] : 0;
+            switch (assignment) {
+            case 8:  x [1][i] = a - b; break;
+            case 9:  x [0][i] = a + b; break;
+            case 10:
+                a = (a << 1) | (b & 1);
+                x [0][i] = (a + b) >> 1;
+                x [1][i] = (a - b) >> 1;
+                break;
+            }
+        }
+
+        if (used + blocksize > size) {
+            float *grown;
+            size = max (2 * size, used + blocksize);
+            grown = (float *) safe_malloc (size * Nout * sizeof (float));
+            if (grown != NULL) {
+                memcpy (grown, out, used * Nout * sizeof (float));
+            }
+            safe_free (out);
+            out = grown;
+            if (out == NULL) {
+                break;
+            }
+        }
+        scale = ldexp (1.0, 16 - bps);
+        if (channel == FLAC_ALL_CHANNELS) {
+            for (i = 0; i < blocksize; i++, used++) {
+                for (ch = 0; ch < Nchannels; ch++) {
+                    out [used * Nout + ch] = (float) (x [ch][i] * scale);
+                }
+            }
+        } else {
+            for (i = 0; i < blocksize; i++) {
+                out [used++] = (float) (x [channel][i] * scale);
+            }
+        }
+    }
+
+    for (ch = 0; ch < FLAC_MAXCHANNELS; ch++) {
+        safe_free (x [ch]);
+    }
+    if (r. error || (out == NULL)) {
+        safe_free (out);
+        return -1;
+    }
+
+    *samples = out;
+    *Nsamples = used;
+    *sample_rate = stream_rate;
+    *channels = stream_channels;
+    return 0;
+}
+
+/* END OF FILE */
@@ -0,0 +1,260 @@
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
+the terms Perceptual Evaluation of Speech Quality Algorithm?
+and PESQ Algorithm?refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term PESQ Software?refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "pesq.h"
+#include "dsp.h"
+
+/* Deterministic speech-like test signals for benchmarking and regression
+   runs. A signal is a sequence of talkspurts made of voiced syllables
+   (a gliding harmonic series shaped by two formants) and unvoiced
+   syllables (noise), separated by pauses. The degraded copy is delayed,
+   low-pass filtered, attenuated and noisy, plus the impairment of its
+   kind: a delay step inside the longest talkspurt, bursts of 3 to 8
+   lost 20 ms packets, or long pauses between short talkspurts. */
+
+char * Synth_Kind_Name [SYNTH_KINDS] = {
+    "clean",
+    "delay_jump",
+    "packet_loss",
+    "silence"
+};
+
+#ifndef TWOPI
+  #define TWOPI   6.283185307179586
+#endif
+
+#define SYNTH_PEAK          8000.0
+#define SYNTH_DELAY_MSECS   40
+#define SYNTH_JUMP_MSECS    32
+#define SYNTH_PACKET_MSECS  20
+#define SYNTH_LOSS_RATE     0.03
+#define SYNTH_SNR_DB        30.0
+
+static double synth_uniform (unsigned long * state)
+{
+    *state = (*state * 1664525UL + 1013904223UL) & 0xFFFFFFFFUL;
+    return (double) (*state >> 8) / 16777216.0;
+}
+
+static double synth_noise (unsigned long * state)
+{
+    return synth_uniform (state) + synth_uniform (state) + synth_uniform (state) - 1.5;
+}
+
+static void synth_syllable (float * x, long n, long sample_rate, unsigned long * state)
+{
+    double f0 = 90.0 + 110.0 * synth_uniform (state);
+    double glide = (synth_uniform (state) - 0.5) * 0.4;
+    double F1 = 300.0 + 500.0 * synth_uniform (state);
+    double F2 = 900.0 + 1600.0 * synth_uniform (state);
+    double level = 0.4 + 0.6 * synth_uniform (state);
+    double top = min (3400.0, 0.45 * sample_rate);
+    double phase = 0;
+    int    voiced = synth_uniform (state) > 0.2;
+    long   i;
+
+    for (i = 0; i < n; i++) {
+        double t = (double) i / n;
+        double envelope = level * sin (TWOPI * 0.5 * t);
+        double f = f0 * (1.0 + glide * t);
+        double value = 0;
+
+        if (voiced) {
+            int k;
+            phase += TWOPI * f / sample_rate;
+            if (phase > TWOPI) {
+                phase -= TWOPI;
+            }
+            for (k = 1; k * f < top; k++) {
+                double d1 = (k * f - F1) / 150.0;
+                double d2 = (k * f - F2) / 250.0;
+                value += (1.0 / (1.0 + d1 * d1) + 0.5 / (1.0 + d2 * d2)) * sin (k * phase);
+            }
+        } else {
+            value = 0.8 * synth_noise (state);
+        }
+        x [i] += (float) (SYNTH_PEAK * 0.5 * envelope * value);
+    }
+}
+
+void synth_pair( int kind, long sample_rate, double seconds, unsigned long seed,
+     float ** ref, float ** deg, long * Nref, long * Ndeg )
+{
+    long          n = (long) (seconds * sample_rate);
+    long          delay = SYNTH_DELAY_MSECS * sample_rate / 1000;
+    long          jump = SYNTH_JUMP_MSECS * sample_rate / 1000;
+    long          packet = SYNTH_PACKET_MSECS * sample_rate / 1000;
+    long          jump_at = n;
+    long          longest = 0;
+    long          pos = (long) (0.3 * sample_rate);
+    unsigned long state = seed * 2654435761UL + 1;
+    double        power = 0;
+    double        noise_level;
+    double        smooth = 0;
+    long          i;
+    float        *x = (float *) safe_malloc (n * sizeof (float));
+    float        *y = (float *) safe_malloc (n * sizeof (float));
+
+    for (i = 0; i < n; i++) {
+        x [i] = 0;
+    }
+
+    while (pos < n - (long) (0.6 * sample_rate)) {
+        double spurt = (kind == SYNTH_SILENCE) ? 0.5 + 0.5 * synth_uniform (&state)
+                                               : 1.2 + 1.3 * synth_uniform (&state);
+        double pause = (kind == SYNTH_SILENCE) ? 1.5 + 1.5 * synth_uniform (&state)
+                                               : 0.3 + 0.5 * synth_uniform (&state);
+        long   end = min (n - (long) (0.3 * sample_rate), pos + (long) (spurt * sample_rate));
+        long   start = pos;
+
+        while (pos < end) {
+            long length = (long) ((0.15 + 0.15 * synth_uniform (&state)) * sample_rate);
+            length = min (length, end - pos);
+            synth_syllable (x + pos, length, sample_rate, &state);
+            pos += length;
+        }
+        if (end - start > longest) {
+            longest = end - start;
+            jump_at = start + (end - start) / 2;
+        }
+        pos = end + (long) (pause * sample_rate);
+    }
+
+    for (i = 0; i < n; i++) {
+        power += (double) x [i] * x [i];
+    }
+    noise_level = sqrt (power / n / pow (10.0, SYNTH_SNR_DB / 10.0));
+
+    for (i = 0; i < n; i++) {
+        long d = delay;
+        long j;
+
+        if ((kind == SYNTH_DELAY_JUMP) && (i >= jump_at + delay)) {
+            d += jump;
+        }
+        j = i - d;
+        smooth = 0.7 * ((j >= 0) ? x [j] : 0.0f) + 0.3 * smooth;
+        y [i] = (float) (0.8 * smooth + noise_level * synth_noise (&state));
+    }
+
+    if (kind == SYNTH_PACKET_LOSS) {
+        for (i = 0; i + packet <= n; i += packet) {
+            if (synth_uniform (&state) < SYNTH_LOSS_RATE) {
+                long burst = packet * (3 + (long) (6 * synth_uniform (&state)));
+                long k;
+                for (k = i; (k < i + burst) && (k < n); k++) {
+                    y [k] = 0;
+                }
+                i += burst;
+            }
+        }
+    }
+
+    *ref = x;
+    *deg = y;
+    *Nref = n;
+    *Ndeg = n;
+}
+
+/* END OF FILE */
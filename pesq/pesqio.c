@@ -1,392 +1,1167 @@
-/*****************************************************************************
-
-Perceptual Evaluation of Speech Quality (PESQ)
-ITU-T Recommendation P.862.
-Version 1.2 - 2 August 2002.
-
-              ****************************************
-              PESQ Intellectual Property Rights Notice
-              ****************************************
-
-DEFINITIONS:
-------------
-For the purposes of this Intellectual Property Rights Notice
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
 the terms Perceptual Evaluation of Speech Quality Algorithm?
-and PESQ Algorithm?refer to the objective speech quality
-measurement algorithm defined in ITU-T Recommendation P.862;
-the term PESQ Software?refers to the C-code component of P.862. 
-
-NOTICE:
--------
-All copyright, trade marks, trade names, patents, know-how and
-all or any other intellectual rights subsisting in or used in
-connection with including all algorithms, documents and manuals
-relating to the PESQ Algorithm and or PESQ Software are and remain
-the sole property in law, ownership, regulations, treaties and
-patent rights of the Owners identified below. The user may not
-dispute or question the ownership of the PESQ Algorithm and
-or PESQ Software.
-
-OWNERS ARE:
------------
-
-1.	British Telecommunications plc (BT), all rights assigned
-      to Psytechnics Limited
-2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
-
-RESTRICTIONS:
--------------
-
-The user cannot:
-
-1.	alter, duplicate, modify, adapt, or translate in whole or in
-      part any aspect of the PESQ Algorithm and or PESQ Software
-2.	sell, hire, loan, distribute, dispose or put to any commercial
-      use other than those permitted below in whole or in part any
-      aspect of the PESQ Algorithm and or PESQ Software
-
-PERMITTED USE:
---------------
-
-The user may:
-
-1.	Use the PESQ Software to:
-      i)   understand the PESQ Algorithm; or
-      ii)  evaluate the ability of the PESQ Algorithm to perform
-           its intended function of predicting the speech quality
-           of a system; or
-      iii) evaluate the computational complexity of the PESQ Algorithm,
-           with the limitation that none of said evaluations or its
-           results shall be used for external commercial use.
-
-2.	Use the PESQ Software to test if an implementation of the PESQ
-      Algorithm conforms to ITU-T Recommendation P.862.
-
-3.	With the prior written permission of both Psytechnics Limited
-      and OPTICOM GmbH, use the PESQ Software in accordance with the
-      above Restrictions to perform work that meets all of the following
-      criteria:
-      i)    the work must contribute directly to the maintenance of an
-            existing ITU recommendation or the development of a new ITU
-            recommendation under an approved ITU Study Item; and
-      ii)   the work and its results must be fully described in a
-            written contribution to the ITU that is presented at a formal
-            ITU meeting within one year of the start of the work; and
-      iii)  neither the work nor its results shall be put to any
-            commercial use other than making said contribution to the ITU.
-            Said permission will be provided on a case-by-case basis.
-
-
-ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
-ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
-FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
-
-EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
-IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
-AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
-
-
-***********************************************************************
-*  OPTICOM GmbH                    *  Psytechnics Limited             *
-*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
-*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
-*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
-*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
-*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
-*  www.opticom.de                  *  www.psytechnics.com             *
-***********************************************************************
-
-Further information is also available from www.pesq.org
-
-*****************************************************************************/
-
-#include <stdio.h>
-#include "pesq.h"
-#include "dsp.h"
-
-void make_stereo_file (char *stereo_path_name, SIGNAL_INFO *ref_info, SIGNAL_INFO *deg_info) {
-    make_stereo_file2 (stereo_path_name, ref_info, deg_info-> data);
-}
-
-void make_stereo_file2 (char *stereo_path_name, SIGNAL_INFO *ref_info, float *deg) {
-
-    long            i;
-    long            h;
-    short          *buffer;
-    FILE           *outputFile;
-    long            n;
-
-    n = ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000) - 2 * SEARCHBUFFER * Downsample;     
-
-    buffer = (short *) safe_malloc (2 * n * sizeof (short));
-    
-    if ((outputFile = fopen (stereo_path_name, "wb")) == NULL) {
-        printf ("MakeStereoFile : cannot open output file %s!", stereo_path_name);
-        return;
-    }
-
-    for (i = 0; i < n; i++) {
-        h = (int) ref_info-> data [SEARCHBUFFER * Downsample + i] / 2;
-        if (h < -32767) h = -32767;
-        if (h > 32767)  h = 32767;
-        h = (short) h;
-        buffer [2*i] = (short) h;    
-        h = (int) deg [SEARCHBUFFER * Downsample + i] / 2;
-        if (h < -32767) h = -32767;
-        if (h > 32767)  h = 32767;
-        h = (short) h;
-        buffer [2*i + 1] = (short) h;                
-    }
-
-    fwrite (buffer, sizeof (short) * 2, n, outputFile);
-    
-    fclose (outputFile);
-    safe_free (buffer);
-}
-
-extern float InIIR_Hsos_16k [];
-extern float InIIR_Hsos_8k [];
-extern long InIIR_Nsos;
-
-void select_rate( long sample_rate, long * Error_Flag, char ** Error_Type )
-{
-    if( Fs == sample_rate )
-        return;
-    if( Fs_16k == sample_rate )
-    {
-        Fs = Fs_16k;
-        Downsample = Downsample_16k;
-        InIIR_Hsos = InIIR_Hsos_16k;
-        InIIR_Nsos = InIIR_Nsos_16k;
-        Align_Nfft = Align_Nfft_16k;
-        return;
-    }
-    if( Fs_8k == sample_rate )
-    {
-        Fs = Fs_8k;
-        Downsample = Downsample_8k;
-        InIIR_Hsos = InIIR_Hsos_8k;
-        InIIR_Nsos = InIIR_Nsos_8k;
-        Align_Nfft = Align_Nfft_8k;
-        return;
-    }
-
-    (*Error_Flag) = -1;
-    (*Error_Type) = "Invalid sample rate specified";    
-}
-
-int file_exist( char * fname )
-{
-    FILE * fp = fopen( fname, "rb" );
-    if( fp == NULL )
-        return 0;
-    else
-    {
-        fclose( fp );
-        return 1;
-    }
-}
-
-void load_src( long * Error_Flag, char ** Error_Type,
-         SIGNAL_INFO * sinfo)
-{
-    long name_len;
-    long file_size;
-    long header_size = 0;
-    long Nsamples;
-    long to_read;
-    long read_count;
-    long count;
-
-    float *read_ptr;
-    short *input_data;
-    short *p_input;
-    char s;
-    char *p_byte;
-    FILE *Src_file = fopen( sinfo-> path_name, "rb" );
-
-    input_data = (short *) safe_malloc( 16384 * sizeof(short) );
-    if( input_data == NULL )
-    {
-        *Error_Flag = 1;
-        *Error_Type = "Could not allocate storage for file reading";
-        printf ("%s!\n", *Error_Type);
-        fclose( Src_file );
-        return;
-    }
-
-    if( Src_file == NULL )
-    {
-        *Error_Flag = 1;
-        *Error_Type = "Could not open source file";
-        printf ("%s!\n", *Error_Type);
-        safe_free( input_data );
-        return;
-    }
-
-    if( fseek( Src_file, 0L, SEEK_END ) != 0 )
-    {
-        *Error_Flag = 1;
-        *Error_Type = "Could not reach end of source file";
-        safe_free( input_data );
-        printf ("%s!\n", *Error_Type);
-        fclose( Src_file );
-        return;
-    }
-    file_size = ftell( Src_file );
-    if( file_size < 0L )
-    {
-        *Error_Flag = 1;
-        *Error_Type = "Could not measure length of source file";
-        safe_free( input_data );
-        printf ("%s!\n", *Error_Type);
-        fclose( Src_file );
-        return;
-    }
-    if( fseek( Src_file, 0L, SEEK_SET ) != 0 )
-    {
-        *Error_Flag = 1;
-        *Error_Type = "Could not reach start of source file";
-        safe_free( input_data );
-        printf ("%s!\n", *Error_Type);
-        fclose( Src_file );
-        return;
-    }
-    name_len = strlen( sinfo-> path_name );
-    if( name_len > 4 )
-    {
-        if( strcmp( sinfo-> path_name + name_len - 4, ".wav" ) == 0 )
-            header_size = 22;
-        if( strcmp( sinfo-> path_name + name_len - 4, ".WAV" ) == 0 )
-            header_size = 22;
-        if( strcmp( sinfo-> path_name + name_len - 4, ".raw" ) == 0 )
-            header_size = 0;
-        if( strcmp( sinfo-> path_name + name_len - 4, ".src" ) == 0 )
-            header_size = 0;
-    }
-    if( name_len > 2 )
-    {
-        if( strcmp( sinfo-> path_name + name_len - 2, ".s" ) == 0 )
-            header_size = 0;
-    }
-
-    if( header_size > 0 )
-        fread( input_data, 2, header_size, Src_file );
-
-    Nsamples = (file_size / 2) - header_size;
-    sinfo-> Nsamples = Nsamples + 2 * SEARCHBUFFER * Downsample;
-
-    sinfo-> data =
-        (float *) safe_malloc( (sinfo-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000)) * sizeof(float) );
-    if( sinfo-> data == NULL )
-    {
-        *Error_Flag = 1;
-        *Error_Type = "Failed to allocate memory for source file";
-        safe_free( input_data );
-        printf ("%s!\n", *Error_Type);
-        fclose( Src_file );
-        return;
-    }
-
-    read_ptr = sinfo-> data;
-    for( read_count = SEARCHBUFFER*Downsample; read_count > 0; read_count-- )
-      *(read_ptr++) = 0.0f;
-
-    to_read = Nsamples;
-    while( to_read > 16384 )
-    {
-        read_count = fread( input_data, sizeof(short), 16384, Src_file );
-        if( read_count < 16384 )
-        {
-            *Error_Flag = 1;
-            *Error_Type = "Error reading source file.";
-            printf ("%s!\n", *Error_Type);
-            safe_free( input_data );
-            safe_free( sinfo-> data );
-            sinfo-> data = NULL;
-            fclose( Src_file );
-            return;
-        }
-        if( sinfo-> apply_swap )
-        {
-            p_byte = (char *)input_data;
-            for( count = 0L; count < read_count; count++ )
-            {
-                s = p_byte[count << 1];
-                p_byte[count << 1] = p_byte[(count << 1)+1];
-                p_byte[(count << 1)+1] = s;
-            }
-        }
-        to_read -= read_count;
-        p_input = input_data;
-        while( read_count > 0 )
-        {
-            read_count--;
-            *(read_ptr++) = (float)(*(p_input++));
-        }
-    }
-    read_count = fread( input_data, sizeof(short), to_read, Src_file );
-    if( read_count < to_read )
-    {
-        *Error_Flag = 1;
-        *Error_Type = "Error reading source file";
-        printf ("%s!\n", *Error_Type);
-        safe_free( input_data );
-        safe_free( sinfo-> data );
-        sinfo-> data = NULL;
-        fclose( Src_file );
-        return;
-    }
-    if( sinfo-> apply_swap )
-    {
-        p_byte = (char *)input_data;
-        for( count = 0L; count < read_count; count++ )
-        {
-            s = p_byte[count << 1];
-            p_byte[count << 1] = p_byte[(count << 1)+1];
-            p_byte[(count << 1)+1] = s;
-        }
-    }
-    p_input = input_data;
-    while( read_count > 0 )
-    {
-        read_count--;
-        *(read_ptr++) = (float)(*(p_input++));
-    }
-
-    for( read_count = DATAPADDING_MSECS  * (Fs / 1000) + SEARCHBUFFER * Downsample;
-         read_count > 0; read_count-- )
-      *(read_ptr++) = 0.0f;
-
-    fclose( Src_file );
-    safe_free( input_data );
-
-    sinfo-> VAD = safe_malloc( sinfo-> Nsamples * sizeof(float) / Downsample );
-    sinfo-> logVAD = safe_malloc( sinfo-> Nsamples * sizeof(float) / Downsample );
-    if( (sinfo-> VAD == NULL) || (sinfo-> logVAD == NULL))
-    {
-        *Error_Flag = 1;
-        *Error_Type = "Failed to allocate memory for VAD";
-        printf ("%s!\n", *Error_Type);
-        return;
-    }
-}
-
-void alloc_other( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, 
-        long * Error_Flag, char ** Error_Type, float ** ftmp)
-{
-    *ftmp = (float *)safe_malloc(
-       max( max(
-            (*ref_info).Nsamples + DATAPADDING_MSECS  * (Fs / 1000),
-            (*deg_info).Nsamples + DATAPADDING_MSECS  * (Fs / 1000) ),
-           12 * Align_Nfft) * sizeof(float) );
-    if( (*ftmp) == NULL )
-    {
-        *Error_Flag = 2;
-        *Error_Type = "Failed to allocate memory for temporary storage.";
-        printf ("%s!\n", *Error_Type);
-        return;
-    }
-}
-
-/* END OF FILE */
+and PESQ Algorithm?refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term PESQ Software?refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "pesq.h"
+#include "dsp.h"
+
+#ifndef S_ISREG
+  #define S_ISREG(m)  (((m) & S_IFMT) == S_IFREG)
+#endif
+
+/* the part of the modification time below a second, where stat has it */
+#if defined( _WIN32 )
+  #define ST_MTIME_NSEC(st)  0L
+#elif defined( __APPLE__ )
+  #define ST_MTIME_NSEC(st)  ((long) (st)-> st_mtimespec. tv_nsec)
+#else
+  #define ST_MTIME_NSEC(st)  ((long) (st)-> st_mtim. tv_nsec)
+#endif
+
+void make_stereo_file (char *stereo_path_name, SIGNAL_INFO *ref_info, SIGNAL_INFO *deg_info) {
+    make_stereo_file2 (stereo_path_name, ref_info, deg_info-> data);
+}
+
+void make_stereo_file2 (char *stereo_path_name, SIGNAL_INFO *ref_info, float *deg) {
+
+    long            i;
+    long            h;
+    short          *buffer;
+    FILE           *outputFile;
+    long            n;
+
+    n = ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000) - 2 * SEARCHBUFFER * Downsample;     
+
+    buffer = (short *) safe_malloc (2 * n * sizeof (short));
+    
+    if ((outputFile = fopen (stereo_path_name, "wb")) == NULL) {
+        printf ("MakeStereoFile : cannot open output file %s!", stereo_path_name);
+        return;
+    }
+
+    for (i = 0; i < n; i++) {
+        h = (int) ref_info-> data [SEARCHBUFFER * Downsample + i] / 2;
+        if (h < -32767) h = -32767;
+        if (h > 32767)  h = 32767;
+        h = (short) h;
+        buffer [2*i] = (short) h;    
+        h = (int) deg [SEARCHBUFFER * Downsample + i] / 2;
+        if (h < -32767) h = -32767;
+        if (h > 32767)  h = 32767;
+        h = (short) h;
+        buffer [2*i + 1] = (short) h;                
+    }
+
+    fwrite (buffer, sizeof (short) * 2, n, outputFile);
+    
+    fclose (outputFile);
+    safe_free (buffer);
+}
+
+extern float InIIR_Hsos_16k [];
+extern float InIIR_Hsos_8k [];
+extern long InIIR_Nsos;
+
+void select_rate( long sample_rate, long * Error_Flag, char ** Error_Type )
+{
+    if( Fs == sample_rate )
+        return;
+    if( Fs_16k == sample_rate )
+    {
+        Fs = Fs_16k;
+        Downsample = Downsample_16k;
+        InIIR_Hsos = InIIR_Hsos_16k;
+        InIIR_Nsos = InIIR_Nsos_16k;
+        Align_Nfft = Align_Nfft_16k;
+        return;
+    }
+    if( Fs_8k == sample_rate )
+    {
+        Fs = Fs_8k;
+        Downsample = Downsample_8k;
+        InIIR_Hsos = InIIR_Hsos_8k;
+        InIIR_Nsos = InIIR_Nsos_8k;
+        Align_Nfft = Align_Nfft_8k;
+        return;
+    }
+
+    (*Error_Flag) = -1;
+    (*Error_Type) = "Invalid sample rate specified";    
+}
+
+int file_exist( char * fname )
+{
+    FILE * fp = fopen( fname, "rb" );
+    if( fp == NULL )
+        return 0;
+    else
+    {
+        fclose( fp );
+        return 1;
+    }
+}
+
+/* Decoded sources kept by a long running process. A reference file
+   scored against many degraded files is then read only once, as long
+   as it is the same file, by device and inode, with the same size and
+   modification time to the nanosecond, so that a capture rewritten in
+   place within a second is still read again. */
+#define SRCCACHE 16
+
+typedef struct {
+    char    path_name [512];
+    long    file_size;
+    time_t  file_mtime;
+    long    file_mtime_nsec;
+    dev_t   file_dev;
+    ino_t   file_ino;
+    long    apply_swap;
+    long    input_rate;
+    double  range_start;
+    double  range_end;
+    long    channel;
+    long    Nchannels;
+    long    Fs;
+    long    Nsamples;
+    float * data;
+    long    last_used;
+} SRC_CACHE_ENTRY;
+
+int             Src_Cache_Enabled = 0;
+long            Src_Cache_Clock = 0;
+SRC_CACHE_ENTRY Src_Cache [SRCCACHE];
+
+void src_cache_enable (int enable)
+{
+    long e;
+
+    if (!enable) {
+        for (e = 0; e < SRCCACHE; e++) {
+            if (Src_Cache [e]. data != NULL) {
+                safe_free (Src_Cache [e]. data);
+                Src_Cache [e]. data = NULL;
+            }
+        }
+    }
+    Src_Cache_Enabled = enable;
+}
+
+static SRC_CACHE_ENTRY * src_cache_find (SIGNAL_INFO * sinfo, struct stat * st)
+{
+    long e;
+
+    for (e = 0; e < SRCCACHE; e++) {
+        SRC_CACHE_ENTRY * entry = &Src_Cache [e];
+        if ((entry-> data != NULL) &&
+            (entry-> file_size == (long) st-> st_size) &&
+            (entry-> file_mtime == st-> st_mtime) &&
+            (entry-> file_mtime_nsec == ST_MTIME_NSEC (st)) &&
+            (entry-> file_dev == st-> st_dev) &&
+            (entry-> file_ino == st-> st_ino) &&
+            (entry-> apply_swap == sinfo-> apply_swap) &&
+            (entry-> input_rate == sinfo-> input_rate) &&
+            (entry-> range_start == sinfo-> range_start) &&
+            (entry-> range_end == sinfo-> range_end) &&
+            (entry-> channel == sinfo-> channel) &&
+            (entry-> Fs == Fs) &&
+            (strcmp (entry-> path_name, sinfo-> path_name) == 0)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void src_cache_store (SIGNAL_INFO * sinfo, struct stat * st)
+{
+    long              e;
+    long              length = sinfo-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000);
+    SRC_CACHE_ENTRY * entry = &Src_Cache [0];
+
+    for (e = 1; e < SRCCACHE; e++) {
+        if (entry-> data == NULL) {
+            break;
+        }
+        if ((Src_Cache [e]. data == NULL) || (Src_Cache [e]. last_used < entry-> last_used)) {
+            entry = &Src_Cache [e];
+        }
+    }
+    if (entry-> data != NULL) {
+        safe_free (entry-> data);
+    }
+
+    entry-> data = (float *) safe_malloc (length * sizeof (float));
+    if (entry-> data == NULL) {
+        return;
+    }
+    memcpy (entry-> data, sinfo-> data, length * sizeof (float));
+    strcpy (entry-> path_name, sinfo-> path_name);
+    entry-> file_size = (long) st-> st_size;
+    entry-> file_mtime = st-> st_mtime;
+    entry-> file_mtime_nsec = ST_MTIME_NSEC (st);
+    entry-> file_dev = st-> st_dev;
+    entry-> file_ino = st-> st_ino;
+    entry-> apply_swap = sinfo-> apply_swap;
+    entry-> input_rate = sinfo-> input_rate;
+    entry-> range_start = sinfo-> range_start;
+    entry-> range_end = sinfo-> range_end;
+    entry-> channel = sinfo-> channel;
+    entry-> Nchannels = sinfo-> Nchannels;
+    entry-> Fs = Fs;
+    entry-> Nsamples = sinfo-> Nsamples;
+    entry-> last_used = ++Src_Cache_Clock;
+}
+
+static void alloc_VAD( long * Error_Flag, char ** Error_Type,
+         SIGNAL_INFO * sinfo)
+{
+    sinfo-> VAD = safe_malloc( sinfo-> Nsamples * sizeof(float) / Downsample );
+    sinfo-> logVAD = safe_malloc( sinfo-> Nsamples * sizeof(float) / Downsample );
+    if( (sinfo-> VAD == NULL) || (sinfo-> logVAD == NULL))
+    {
+        *Error_Flag = 1;
+        *Error_Type = "Failed to allocate memory for VAD";
+        printf ("%s!\n", *Error_Type);
+        return;
+    }
+}
+
+/* Allocates sinfo-> data for Nsamples of signal with the search buffer
+   and data padding zeroed, and returns where the signal starts. */
+
+static float * alloc_src( long * Error_Flag, char ** Error_Type,
+         SIGNAL_INFO * sinfo, long Nsamples )
+{
+    long count;
+
+    sinfo-> Nsamples = Nsamples + 2 * SEARCHBUFFER * Downsample;
+    sinfo-> data =
+        (float *) safe_malloc( (sinfo-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000)) * sizeof(float) );
+    sinfo-> VAD = NULL;
+    sinfo-> logVAD = NULL;
+    if( sinfo-> data == NULL )
+    {
+        *Error_Flag = 1;
+        *Error_Type = "Failed to allocate memory for source file";
+        printf ("%s!\n", *Error_Type);
+        return NULL;
+    }
+
+    for( count = 0; count < SEARCHBUFFER * Downsample; count++ )
+        sinfo-> data [count] = 0.0f;
+    for( count = SEARCHBUFFER * Downsample + Nsamples;
+         count < sinfo-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); count++ )
+        sinfo-> data [count] = 0.0f;
+
+    return sinfo-> data + SEARCHBUFFER * Downsample;
+}
+
+/* A source is a file name, '-' for standard input or 'fd:N' for an
+   inherited descriptor. Streams are read to the end into a buffer that
+   starts at the size fstat reports, or SRC_READ_HINT, and doubles as
+   needed, so pipes need no seeking. */
+
+#define SRC_READ_HINT   (1L << 20)
+
+static FILE * open_src( SIGNAL_INFO * sinfo, int * is_stream )
+{
+    *is_stream = 1;
+    if( strcmp( sinfo-> path_name, "-" ) == 0 )
+    {
+#ifdef _WIN32
+        _setmode( _fileno( stdin ), _O_BINARY );
+#endif
+        return stdin;
+    }
+    if( strncmp( sinfo-> path_name, "fd:", 3 ) == 0 )
+        return fdopen( atoi( sinfo-> path_name + 3 ), "rb" );
+
+    *is_stream = 0;
+    return fopen( sinfo-> path_name, "rb" );
+}
+
+/* Asks the system to start reading a named source in the background, so
+   that it is already in memory when load_src gets to it. Returns the size
+   of the source, or 0 for streams, descriptors and files that cannot be
+   opened, and everywhere without posix_fadvise. */
+
+long src_prefetch( const char * path_name )
+{
+#ifdef POSIX_FADV_WILLNEED
+    struct stat src_stat;
+    long        size = 0;
+    int         fd;
+
+    if( (strcmp( path_name, "-" ) == 0) || (strncmp( path_name, "fd:", 3 ) == 0) )
+        return 0;
+    fd = open( path_name, O_RDONLY );
+    if( fd < 0 )
+        return 0;
+    if( (fstat( fd, &src_stat ) == 0) && S_ISREG( src_stat. st_mode ) &&
+        (posix_fadvise( fd, 0, src_stat. st_size, POSIX_FADV_WILLNEED ) == 0) )
+        size = (long) src_stat. st_size;
+    close( fd );
+    return size;
+#else
+    return 0;
+#endif
+}
+
+static char * read_src( FILE * Src_file, long * Nbytes )
+{
+    struct stat src_stat;
+    long   size = SRC_READ_HINT;
+    long   used = 0;
+    char * bytes;
+
+    if( (fstat( fileno( Src_file ), &src_stat ) == 0) &&
+        S_ISREG( src_stat. st_mode ) && (src_stat. st_size > 0) )
+        size = (long) src_stat. st_size + 1;
+
+    bytes = (char *) safe_malloc( size );
+    while( bytes != NULL )
+    {
+        long count = (long) fread( bytes + used, 1, size - used, Src_file );
+        used += count;
+        if( used < size )
+        {
+            if( ferror( Src_file ) )
+            {
+                safe_free( bytes );
+                return NULL;
+            }
+            break;
+        }
+        {
+            char * grown = (char *) safe_malloc( 2 * size );
+            if( grown != NULL )
+                memcpy( grown, bytes, used );
+            safe_free( bytes );
+            bytes = grown;
+            size *= 2;
+        }
+    }
+
+    *Nbytes = used;
+    return bytes;
+}
+
+/* Layout of the samples in a source. Content starting with a RIFF/WAVE
+   header is parsed for its 'fmt ' and 'data' chunks, whatever the name;
+   other named files keep the extension rule of the original reader (44
+   byte header for .wav, none otherwise) and are 16 bit mono at the
+   rate given with the source, or the model rate. */
+
+#define WAVE_FORMAT_PCM         1
+#define WAVE_FORMAT_EXTENSIBLE  0xFFFE
+
+typedef struct {
+    long offset;
+    long length;
+    long channels;
+    long sample_rate;
+    long bits;
+    long format;
+} SRC_FORMAT;
+
+static unsigned long get_le( const unsigned char * p, int n )
+{
+    unsigned long value = 0;
+
+    while( n-- > 0 )
+        value = (value << 8) | p[n];
+    return value;
+}
+
+static void parse_src( SIGNAL_INFO * sinfo, int is_stream,
+         const unsigned char * bytes, long Nbytes, long Ntotal, SRC_FORMAT * fmt )
+{
+    long name_len = strlen( sinfo-> path_name );
+    long header_size = 0;
+    long pos;
+
+    fmt-> channels = 1;
+    fmt-> sample_rate = 0;
+    fmt-> bits = 16;
+    fmt-> format = WAVE_FORMAT_PCM;
+
+    if( (Nbytes >= 12) && (memcmp( bytes, "RIFF", 4 ) == 0) &&
+        (memcmp( bytes + 8, "WAVE", 4 ) == 0) )
+    {
+        fmt-> offset = 44;
+        fmt-> length = Ntotal - 44;
+
+        pos = 12;
+        while( pos + 8 <= Nbytes )
+        {
+            unsigned long chunk_size = get_le( bytes + pos + 4, 4 );
+
+            if( (memcmp( bytes + pos, "fmt ", 4 ) == 0) && (pos + 24 <= Nbytes) )
+            {
+                fmt-> format = get_le( bytes + pos + 8, 2 );
+                fmt-> channels = get_le( bytes + pos + 10, 2 );
+                fmt-> sample_rate = get_le( bytes + pos + 12, 4 );
+                fmt-> bits = get_le( bytes + pos + 22, 2 );
+                if( (fmt-> format == WAVE_FORMAT_EXTENSIBLE) && (pos + 34 <= Nbytes) )
+                    fmt-> format = get_le( bytes + pos + 32, 2 );
+            }
+            if( memcmp( bytes + pos, "data", 4 ) == 0 )
+            {
+                fmt-> offset = pos + 8;
+                fmt-> length = Ntotal - fmt-> offset;
+                if( (chunk_size > 0) && (chunk_size < (unsigned long) fmt-> length) )
+                    fmt-> length = (long) chunk_size;
+                break;
+            }
+            pos += 8 + (long) chunk_size + (chunk_size & 1);
+        }
+        return;
+    }
+
+    if( !is_stream )
+    {
+        if( name_len > 4 )
+        {
+            if( strcmp( sinfo-> path_name + name_len - 4, ".wav" ) == 0 )
+                header_size = 22;
+            if( strcmp( sinfo-> path_name + name_len - 4, ".WAV" ) == 0 )
+                header_size = 22;
+            if( strcmp( sinfo-> path_name + name_len - 4, ".raw" ) == 0 )
+                header_size = 0;
+            if( strcmp( sinfo-> path_name + name_len - 4, ".src" ) == 0 )
+                header_size = 0;
+        }
+        if( name_len > 2 )
+        {
+            if( strcmp( sinfo-> path_name + name_len - 2, ".s" ) == 0 )
+                header_size = 0;
+        }
+    }
+
+    fmt-> offset = min( 2 * header_size, Ntotal );
+    fmt-> length = Ntotal - fmt-> offset;
+    fmt-> sample_rate = sinfo-> input_rate;
+}
+
+#define WAVE_FORMAT_IEEE_FLOAT  3
+
+static int pcm_supported( SRC_FORMAT * fmt )
+{
+    if( fmt-> channels < 1 )
+        return 0;
+    if( fmt-> format == WAVE_FORMAT_PCM )
+        return (fmt-> bits == 8) || (fmt-> bits == 16) || (fmt-> bits == 24) || (fmt-> bits == 32);
+    if( fmt-> format == WAVE_FORMAT_IEEE_FLOAT )
+        return (fmt-> bits == 32) || (fmt-> bits == 64);
+    return 0;
+}
+
+/* Converts channel to float on the 16 bit scale. 16 bit data
+   is read in machine order as before, other widths are little endian as
+   WAV defines them; +swap reverses the bytes of every sample. */
+
+static void decode_pcm( const unsigned char * p, SRC_FORMAT * fmt, long apply_swap,
+         long channel, float * out, long Nsamples )
+{
+    unsigned short one = 1;
+    int   little = *(unsigned char *) &one;
+    long  width = fmt-> bits / 8;
+    long  stride = width * fmt-> channels;
+    long  count;
+    int   k;
+
+    p += width * channel;
+    for( count = 0L; count < Nsamples; count++ )
+    {
+        const unsigned char * s = p + stride * count;
+        unsigned char b [8];
+        unsigned char h [8];
+
+        for( k = 0; k < width; k++ )
+            b[k] = apply_swap ? s[width - 1 - k] : s[k];
+
+        if( fmt-> format == WAVE_FORMAT_IEEE_FLOAT )
+        {
+            for( k = 0; k < width; k++ )
+                h[k] = little ? b[k] : b[width - 1 - k];
+            if( width == 4 )
+            {
+                float value;
+                memcpy( &value, h, 4 );
+                out [count] = value * 32768.0f;
+            }
+            else
+            {
+                double value;
+                memcpy( &value, h, 8 );
+                out [count] = (float) (value * 32768.0);
+            }
+            continue;
+        }
+
+        switch( width )
+        {
+        case 1:
+            out [count] = (float) (((int) b[0] - 128) * 256);
+            break;
+        case 2:
+            {
+                short value;
+                memcpy( &value, b, 2 );
+                out [count] = (float) value;
+            }
+            break;
+        case 3:
+            {
+                long value = (long) (b[0] | (b[1] << 8) | ((unsigned long) b[2] << 16));
+                if( value & 0x800000L )
+                    value -= 0x1000000L;
+                out [count] = (float) (value / 256.0);
+            }
+            break;
+        case 4:
+            {
+                unsigned long u = b[0] | (b[1] << 8) | ((unsigned long) b[2] << 16) | ((unsigned long) b[3] << 24);
+                double value = (u & 0x80000000UL) ? (double) u - 4294967296.0 : (double) u;
+                out [count] = (float) (value / 65536.0);
+            }
+            break;
+        }
+    }
+}
+
+static int is_flac( const unsigned char * bytes, long Nbytes )
+{
+    long pos = 0;
+
+    if( (Nbytes > 10) && (memcmp( bytes, "ID3", 3 ) == 0) )
+        pos = 10 + ((bytes[6] & 0x7F) << 21) + ((bytes[7] & 0x7F) << 14) +
+                   ((bytes[8] & 0x7F) << 7) + (bytes[9] & 0x7F);
+    return (pos + 4 <= Nbytes) && (memcmp( bytes + pos, "fLaC", 4 ) == 0);
+}
+
+/* Parses a +ref-range/+deg-range value 'start:end' in seconds into sinfo;
+   an empty end, or 'start' alone, runs to the end of the source. */
+
+int parse_range( const char * text, SIGNAL_INFO * sinfo )
+{
+    double start = 0;
+    double end = 0;
+    char   tail;
+
+    if( (sscanf( text, "%lf:%lf%c", &start, &end, &tail ) == 2) ||
+        ((sscanf( text, "%lf%c%c", &start, &tail, &tail ) == 2) && (tail == ':')) ||
+        (sscanf( text, "%lf%c", &start, &tail ) == 1) )
+    {
+        if( (start >= 0) && ((end == 0) || (end > start)) )
+        {
+            sinfo-> range_start = start;
+            sinfo-> range_end = end;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Parses a +ref-channel/+deg-channel value, counted from 1, into sinfo. */
+
+int parse_channel( const char * text, SIGNAL_INFO * sinfo )
+{
+    long channel;
+    char tail;
+
+    if( (sscanf( text, "%ld%c", &channel, &tail ) == 1) &&
+        (channel >= 1) && (channel <= MAXCHANNELS) )
+    {
+        sinfo-> channel = channel - 1;
+        return 0;
+    }
+    return -1;
+}
+
+/* First sample and number of samples of the requested window out of
+   Nsamples at rate in_rate. */
+
+static void range_window( SIGNAL_INFO * sinfo, long in_rate, long Nsamples,
+         long * first, long * count )
+{
+    long last = Nsamples;
+
+    *first = min( (long) floor( sinfo-> range_start * in_rate + 0.5 ), Nsamples );
+    if( sinfo-> range_end > 0 )
+        last = min( (long) floor( sinfo-> range_end * in_rate + 0.5 ), Nsamples );
+    *count = max( last - *first, 0 );
+}
+
+#define SRC_PROBE_BYTES     65536
+
+/* Reads only the window of a seekable PCM file: the header is probed for
+   the sample layout and the file positioned straight at the first sample
+   wanted. Returns NULL with *windowed clear, and the file rewound, when
+   the source has to be read whole instead. */
+
+static char * read_src_window( FILE * Src_file, SIGNAL_INFO * sinfo,
+         SRC_FORMAT * fmt, long * Nbytes, int * windowed )
+{
+    struct stat   src_stat;
+    unsigned char probe [SRC_PROBE_BYTES];
+    long          Nprobe;
+    long          block;
+    long          in_rate;
+    long          first, count;
+    char        * bytes;
+
+    *windowed = 0;
+    if( (fstat( fileno( Src_file ), &src_stat ) != 0) || !S_ISREG( src_stat. st_mode ) )
+        return NULL;
+
+    Nprobe = (long) fread( probe, 1, sizeof( probe ), Src_file );
+    parse_src( sinfo, 0, probe, Nprobe, (long) src_stat. st_size, fmt );
+    if( is_flac( probe, Nprobe ) || !pcm_supported( fmt ) )
+    {
+        rewind( Src_file );
+        return NULL;
+    }
+
+    block = fmt-> bits / 8 * fmt-> channels;
+    in_rate = (fmt-> sample_rate > 0) ? fmt-> sample_rate : Fs;
+    range_window( sinfo, in_rate, fmt-> length / block, &first, &count );
+
+    bytes = (char *) safe_malloc( max( count * block, 1 ) );
+    if( bytes == NULL )
+        return NULL;
+    *windowed = 1;
+    if( fseek( Src_file, fmt-> offset + first * block, SEEK_SET ) != 0 )
+    {
+        safe_free( bytes );
+        return NULL;
+    }
+    *Nbytes = (long) fread( bytes, 1, count * block, Src_file );
+    fmt-> offset = 0;
+    fmt-> length = *Nbytes;
+    return bytes;
+}
+
+/* The number of samples load_src would give for sinfo, at the model rate,
+   told from the header of its source without reading the rest. Returns -1
+   for streams, descriptors and sources that do not state their length. */
+
+long src_length( SIGNAL_INFO * sinfo )
+{
+    struct stat   src_stat;
+    unsigned char probe [SRC_PROBE_BYTES];
+    long          Nprobe;
+    long          Nsamples = -1;
+    long          in_rate = 0;
+    long          channels;
+    long          first;
+    SRC_FORMAT    fmt;
+    FILE        * Src_file;
+
+    if( (strcmp( sinfo-> path_name, "-" ) == 0) || (strncmp( sinfo-> path_name, "fd:", 3 ) == 0) )
+        return -1;
+    Src_file = fopen( sinfo-> path_name, "rb" );
+    if( Src_file == NULL )
+        return -1;
+    if( (fstat( fileno( Src_file ), &src_stat ) != 0) || !S_ISREG( src_stat. st_mode ) )
+    {
+        fclose( Src_file );
+        return -1;
+    }
+    Nprobe = (long) fread( probe, 1, sizeof( probe ), Src_file );
+    fclose( Src_file );
+
+    if( is_flac( probe, Nprobe ) )
+    {
+        if( flac_info( probe, Nprobe, &Nsamples, &in_rate, &channels ) != 0 )
+            return -1;
+    }
+    else
+    {
+        parse_src( sinfo, 0, probe, Nprobe, (long) src_stat. st_size, &fmt );
+        if( !pcm_supported( &fmt ) )
+            return -1;
+        Nsamples = fmt. length / (fmt. bits / 8 * fmt. channels);
+        in_rate = fmt. sample_rate;
+    }
+
+    if( in_rate <= 0 )
+        in_rate = Fs;
+    range_window( sinfo, in_rate, Nsamples, &first, &Nsamples );
+    return (long) ((double) Nsamples * Fs / in_rate);
+}
+
+/* Reads the source of sinfo once and loads channel sinfo-> channel into
+   sinfo or, given channel_info, each of the first max_channels channels
+   into a copy of sinfo there. Returns the number of channels loaded. */
+
+static long load_src_of( long * Error_Flag, char ** Error_Type,
+         SIGNAL_INFO * sinfo, SIGNAL_INFO * channel_info, long max_channels )
+{
+    long   Nbytes;
+    long   Nsamples;
+    long   in_rate;
+    long   channels;
+    long   Nloaded;
+    float *interleaved = NULL;
+    SRC_FORMAT fmt;
+    int    is_stream;
+    int    ranged = (sinfo-> range_start > 0) || (sinfo-> range_end > 0);
+    int    windowed = 0;
+    char * bytes;
+    FILE  *Src_file;
+    struct stat src_stat;
+    int    cacheable = 0;
+
+    if( Src_Cache_Enabled && (channel_info == NULL) && (stat( sinfo-> path_name, &src_stat ) == 0) )
+    {
+        SRC_CACHE_ENTRY * entry = src_cache_find( sinfo, &src_stat );
+        long length;
+
+        cacheable = 1;
+        if( entry != NULL )
+        {
+            length = entry-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000);
+            sinfo-> Nsamples = entry-> Nsamples;
+            sinfo-> Nchannels = entry-> Nchannels;
+            sinfo-> data = (float *) safe_malloc( length * sizeof(float) );
+            if( sinfo-> data == NULL )
+            {
+                *Error_Flag = 1;
+                *Error_Type = "Failed to allocate memory for source file";
+                printf ("%s!\n", *Error_Type);
+                return 0;
+            }
+            memcpy( sinfo-> data, entry-> data, length * sizeof(float) );
+            entry-> last_used = ++Src_Cache_Clock;
+            alloc_VAD( Error_Flag, Error_Type, sinfo );
+            return 1;
+        }
+    }
+
+    Src_file = open_src( sinfo, &is_stream );
+    if( Src_file == NULL )
+    {
+        *Error_Flag = 1;
+        *Error_Type = "Could not open source file";
+        printf ("%s!\n", *Error_Type);
+        return 0;
+    }
+
+    bytes = NULL;
+    if( ranged && !is_stream )
+        bytes = read_src_window( Src_file, sinfo, &fmt, &Nbytes, &windowed );
+    if( !windowed )
+        bytes = read_src( Src_file, &Nbytes );
+    if( Src_file != stdin )
+        fclose( Src_file );
+    if( bytes == NULL )
+    {
+        *Error_Flag = 1;
+        *Error_Type = "Error reading source file";
+        printf ("%s!\n", *Error_Type);
+        return 0;
+    }
+
+    if( !windowed && is_flac( (unsigned char *) bytes, Nbytes ) )
+    {
+        long first;
+
+        if( flac_decode( (unsigned char *) bytes, Nbytes, FLAC_ALL_CHANNELS,
+                         &interleaved, &Nsamples, &in_rate, &channels ) != 0 )
+        {
+            *Error_Flag = 1;
+            *Error_Type = "Could not decode FLAC source";
+            printf ("%s!\n", *Error_Type);
+            safe_free( bytes );
+            return 0;
+        }
+        if( in_rate <= 0 )
+            in_rate = Fs;
+        if( ranged )
+        {
+            range_window( sinfo, in_rate, Nsamples, &first, &Nsamples );
+            memmove( interleaved, interleaved + first * channels, Nsamples * channels * sizeof(float) );
+        }
+    }
+    else
+    {
+        if( !windowed )
+            parse_src( sinfo, is_stream, (unsigned char *) bytes, Nbytes, Nbytes, &fmt );
+        if( !pcm_supported( &fmt ) )
+        {
+            *Error_Flag = 1;
+            *Error_Type = "Unsupported WAV sample format";
+            printf ("%s!\n", *Error_Type);
+            safe_free( bytes );
+            return 0;
+        }
+        in_rate = (fmt. sample_rate > 0) ? fmt. sample_rate : Fs;
+        channels = fmt. channels;
+        Nsamples = fmt. length / (fmt. bits / 8 * fmt. channels);
+        if( ranged && !windowed )
+        {
+            long first;
+
+            range_window( sinfo, in_rate, Nsamples, &first, &Nsamples );
+            fmt. offset += first * (fmt. bits / 8 * fmt. channels);
+        }
+    }
+
+    sinfo-> Nchannels = channels;
+    if( (channel_info == NULL) && ((sinfo-> channel < 0) || (sinfo-> channel >= channels)) )
+    {
+        *Error_Flag = 1;
+        *Error_Type = "Channel not present in source file";
+        printf ("%s!\n", *Error_Type);
+    }
+
+    /* every channel is converted straight out of the bytes read */
+    for( Nloaded = 0; (*Error_Flag) == 0; Nloaded++ )
+    {
+        SIGNAL_INFO * target = sinfo;
+        float       * decoded = NULL;
+        float       * samples;
+        long          length;
+        long          count;
+
+        if( channel_info != NULL )
+        {
+            if( (Nloaded >= channels) || (Nloaded >= max_channels) )
+                break;
+            target = &channel_info [Nloaded];
+            *target = *sinfo;
+            target-> channel = Nloaded;
+        }
+        else if( Nloaded == 1 )
+            break;
+
+        if( in_rate == Fs )
+            samples = alloc_src( Error_Flag, Error_Type, target, Nsamples );
+        else
+            samples = decoded = (float *) safe_malloc( max( Nsamples, 1 ) * sizeof(float) );
+        if( samples == NULL )
+        {
+            *Error_Flag = 1;
+            *Error_Type = "Failed to allocate memory for source file";
+            break;
+        }
+
+        if( interleaved != NULL )
+            for( count = 0; count < Nsamples; count++ )
+                samples [count] = interleaved [count * channels + target-> channel];
+        else
+            decode_pcm( (unsigned char *) bytes + fmt. offset, &fmt, sinfo-> apply_swap,
+                        target-> channel, samples, Nsamples );
+
+        if( decoded != NULL )
+        {
+            length = (long) ResampleLength( Nsamples, in_rate, Fs );
+            samples = alloc_src( Error_Flag, Error_Type, target, length );
+            if( samples != NULL )
+                Resample( decoded, Nsamples, in_rate, Fs, samples );
+            safe_free( decoded );
+            if( samples == NULL )
+                break;
+        }
+
+        if( cacheable )
+            src_cache_store( target, &src_stat );
+
+        alloc_VAD( Error_Flag, Error_Type, target );
+    }
+
+    safe_free( interleaved );
+    safe_free( bytes );
+    return Nloaded;
+}
+
+void load_src( long * Error_Flag, char ** Error_Type,
+         SIGNAL_INFO * sinfo)
+{
+    load_src_of( Error_Flag, Error_Type, sinfo, NULL, 0 );
+}
+
+/* Loads up to max_channels channels of the source of sinfo into
+   channel_info, reading and parsing the source only once; sinfo-> Nchannels
+   is set to the number of channels in the source. */
+
+long load_src_channels( long * Error_Flag, char ** Error_Type,
+         SIGNAL_INFO * sinfo, SIGNAL_INFO * channel_info, long max_channels )
+{
+    return load_src_of( Error_Flag, Error_Type, sinfo, channel_info, max_channels );
+}
+
+/* Places Nsamples of signal already in memory into sinfo with the same
+   padding load_src applies to a file. */
+
+void load_samples( long * Error_Flag, char ** Error_Type,
+         SIGNAL_INFO * sinfo, const float * samples, long Nsamples )
+{
+    float * data = alloc_src( Error_Flag, Error_Type, sinfo, Nsamples );
+    long    count;
+
+    if( data == NULL )
+        return;
+
+    sinfo-> Nchannels = 1;
+    for( count = 0; count < Nsamples; count++ )
+        data [count] = samples [count];
+
+    alloc_VAD( Error_Flag, Error_Type, sinfo );
+}
+
+void alloc_other( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, 
+        long * Error_Flag, char ** Error_Type, float ** ftmp)
+{
+    *ftmp = (float *)safe_malloc(
+       max( max(
+            (*ref_info).Nsamples + DATAPADDING_MSECS  * (Fs / 1000),
+            (*deg_info).Nsamples + DATAPADDING_MSECS  * (Fs / 1000) ),
+           12 * Align_Nfft) * sizeof(float) );
+    if( (*ftmp) == NULL )
+    {
+        *Error_Flag = 2;
+        *Error_Type = "Failed to allocate memory for temporary storage.";
+        printf ("%s!\n", *Error_Type);
+        return;
+    }
+}
+
+/* Sources read a piece at a time, for live scoring. A RIFF header is
+   parsed chunk by chunk as it arrives; anything else is 16 bit mono. The
+   samples must already be at the model rate, as there is no resampling
+   state carried between reads. */
+
+struct SRC_STREAM {
+    FILE        * file;
+    SRC_FORMAT    fmt;
+    unsigned char pending [12];
+    long          Npending;
+};
+
+SRC_STREAM * open_src_stream( long * Error_Flag, char ** Error_Type,
+         SIGNAL_INFO * sinfo )
+{
+    SRC_STREAM  * stream = (SRC_STREAM *) safe_malloc( sizeof( SRC_STREAM ) );
+    unsigned char header [8];
+    int           is_stream;
+
+    if( stream == NULL )
+    {
+        *Error_Flag = 1;
+        *Error_Type = "Failed to allocate memory for source stream";
+        return NULL;
+    }
+    stream-> file = open_src( sinfo, &is_stream );
+    if( stream-> file == NULL )
+    {
+        *Error_Flag = 1;
+        *Error_Type = "Could not open source file";
+        safe_free( stream );
+        return NULL;
+    }
+
+    stream-> fmt. channels = 1;
+    stream-> fmt. sample_rate = 0;
+    stream-> fmt. bits = 16;
+    stream-> fmt. format = WAVE_FORMAT_PCM;
+    stream-> Npending = (long) fread( stream-> pending, 1, 12, stream-> file );
+
+    if( (stream-> Npending == 12) && (memcmp( stream-> pending, "RIFF", 4 ) == 0) &&
+        (memcmp( stream-> pending + 8, "WAVE", 4 ) == 0) )
+    {
+        stream-> Npending = 0;
+        while( fread( header, 1, 8, stream-> file ) == 8 )
+        {
+            unsigned long chunk_size = get_le( header + 4, 4 );
+            unsigned char body [40];
+            unsigned long skip = chunk_size + (chunk_size & 1);
+
+            if( memcmp( header, "data", 4 ) == 0 )
+                break;
+            if( (memcmp( header, "fmt ", 4 ) == 0) && (chunk_size >= 16) )
+            {
+                long n = (long) min( chunk_size, sizeof( body ) );
+                if( fread( body, 1, n, stream-> file ) != (size_t) n )
+                    break;
+                skip -= n;
+                stream-> fmt. format = get_le( body, 2 );
+                stream-> fmt. channels = get_le( body + 2, 2 );
+                stream-> fmt. sample_rate = get_le( body + 4, 4 );
+                stream-> fmt. bits = get_le( body + 14, 2 );
+                if( (stream-> fmt. format == WAVE_FORMAT_EXTENSIBLE) && (n >= 26) )
+                    stream-> fmt. format = get_le( body + 24, 2 );
+            }
+            while( skip > 0 )
+            {
+                if( fgetc( stream-> file ) == EOF )
+                    break;
+                skip--;
+            }
+        }
+    }
+    else if( !is_stream )
+        stream-> fmt. sample_rate = sinfo-> input_rate;
+
+    if( !pcm_supported( &stream-> fmt ) ||
+        ((stream-> fmt. sample_rate > 0) && (stream-> fmt. sample_rate != Fs)) )
+    {
+        *Error_Flag = 1;
+        *Error_Type = "Live input must be PCM at the model sample rate";
+        close_src_stream( stream );
+        return NULL;
+    }
+    if( (sinfo-> channel < 0) || (sinfo-> channel >= stream-> fmt. channels) )
+    {
+        *Error_Flag = 1;
+        *Error_Type = "Channel not present in source file";
+        close_src_stream( stream );
+        return NULL;
+    }
+    sinfo-> Nchannels = stream-> fmt. channels;
+    return stream;
+}
+
+/* Reads up to Nsamples of channel sinfo-> channel into samples and returns the
+   number read, 0 at the end of the source. */
+
+long read_src_stream( SRC_STREAM * stream, SIGNAL_INFO * sinfo,
+         float * samples, long Nsamples )
+{
+    long  block = stream-> fmt. bits / 8 * stream-> fmt. channels;
+    long  Nbytes = Nsamples * block;
+    unsigned char * bytes = (unsigned char *) safe_malloc( Nbytes );
+    long  used;
+
+    if( bytes == NULL )
+        return 0;
+    used = min( stream-> Npending, Nbytes );
+    memcpy( bytes, stream-> pending, used );
+    memmove( stream-> pending, stream-> pending + used, stream-> Npending - used );
+    stream-> Npending -= used;
+    used += (long) fread( bytes + used, 1, Nbytes - used, stream-> file );
+
+    Nsamples = used / block;
+    decode_pcm( bytes, &stream-> fmt, sinfo-> apply_swap, sinfo-> channel, samples, Nsamples );
+    safe_free( bytes );
+    return Nsamples;
+}
+
+void close_src_stream( SRC_STREAM * stream )
+{
+    if( (stream-> file != NULL) && (stream-> file != stdin) )
+        fclose( stream-> file );
+    safe_free( stream );
+}
+
+/* END OF FILE */
@@ -0,0 +1,556 @@
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
+the terms Perceptual Evaluation of Speech Quality Algorithm?
+and PESQ Algorithm?refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term PESQ Software?refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+#include <stdio.h>
+#include <math.h>
+#include "pesq.h"
+#include "dsp.h"
+
+/* Live scoring of an ongoing call. Each window is scored as pesq_measure
+   scores it when loaded alone with +ref-range and +deg-range: levelled
+   and IRS filtered, split into utterances and aligned, and scored over
+   the same frames with bad intervals realigned. What the engine keeps as
+   the window slides are the band densities of every frame wholly inside
+   the window, taken from the unscaled signal with the IRS filter applied
+   per FFT bin and scaled by the level of each window; filtering per bin
+   rather than the whole window moves the score by about 0.01. Frames
+   reaching past the window see silence there and are computed afresh.
+   The hop is rounded to whole half frames so that windows share their
+   frames. */
+
+#define LIVE_NO_FRAME       -1L
+
+LIVE_INFO * live_open( double window_seconds, double hop_seconds,
+     long * Error_Flag, char ** Error_Type )
+{
+    LIVE_INFO * live;
+    float     * factor;
+    long        Nwindow = (long) (window_seconds * Fs);
+    long        Nf = Downsample * 8L;
+    long        Nhop = (long) floor (hop_seconds * Fs / (Nf / 2) + 0.5) * (Nf / 2);
+    long        i;
+
+    if ((Nwindow < Fs / 4 + 2 * SEARCHBUFFER * Downsample) || (hop_seconds <= 0)) {
+        *Error_Flag = 1;
+        *Error_Type = "Live window too short or hop not positive";
+        return NULL;
+    }
+
+    live = (LIVE_INFO *) safe_malloc (sizeof (LIVE_INFO));
+    if (live == NULL) {
+        *Error_Flag = 1;
+        *Error_Type = "Failed to allocate memory for live scoring";
+        return NULL;
+    }
+
+    select_model_tables ();
+
+    live-> Nwindow = Nwindow;
+    live-> Nhop = max (Nhop, Nf / 2);
+    live-> Nf = Nf;
+    live-> next = Nwindow;
+    live-> size = Nwindow + 2 * SEARCHBUFFER * Downsample + Nf + live-> Nhop;
+    live-> base = 0;
+    live-> Nref = 0;
+    live-> Ndeg = 0;
+    live-> ended = FALSE;
+    live-> delay = 0;
+    live-> Nslots = Nwindow / (live-> Nf / 2) + 2;
+    live-> Nframes_computed = 0;
+
+    live-> ref = (float *) safe_malloc (live-> size * sizeof (float));
+    live-> deg = (float *) safe_malloc (live-> size * sizeof (float));
+    live-> ref_frame_start = (long *) safe_malloc (live-> Nslots * sizeof (long));
+    live-> deg_frame_start = (long *) safe_malloc (live-> Nslots * sizeof (long));
+    live-> ref_dens = (float *) safe_malloc (live-> Nslots * Nb * sizeof (float));
+    live-> deg_dens = (float *) safe_malloc (live-> Nslots * Nb * sizeof (float));
+    live-> irs_gain = (float *) safe_malloc ((live-> Nf / 2) * sizeof (float));
+    live-> window = (float *) safe_malloc (live-> Nf * sizeof (float));
+    live-> frame = (float *) safe_malloc (live-> Nf * sizeof (float));
+
+    if ((live-> ref == NULL) || (live-> deg == NULL) || (live-> ref_frame_start == NULL) ||
+        (live-> deg_frame_start == NULL) || (live-> ref_dens == NULL) || (live-> deg_dens == NULL) ||
+        (live-> irs_gain == NULL) || (live-> window == NULL) || (live-> frame == NULL)) {
+        live_close (live);
+        *Error_Flag = 1;
+        *Error_Type = "Failed to allocate memory for live scoring";
+        return NULL;
+    }
+
+    for (i = 0; i < live-> Nslots; i++) {
+        live-> ref_frame_start [i] = LIVE_NO_FRAME;
+        live-> deg_frame_start [i] = LIVE_NO_FRAME;
+    }
+    for (i = 0; i < live-> Nf; i++) {
+        live-> window [i] = (float) (0.5 * (1.0 - cos ((TWOPI * i) / live-> Nf)));
+    }
+
+    /* filter_factors gives amplitudes; the densities are powers */
+    factor = filter_factors (live-> Nf, 26, standard_IRS_filter_dB);
+    for (i = 0; i < live-> Nf / 2; i++) {
+        live-> irs_gain [i] = factor [i] * factor [i];
+    }
+    free_filter_factors (factor);
+
+    return live;
+}
+
+void live_close( LIVE_INFO * live )
+{
+    if (live == NULL) {
+        return;
+    }
+    safe_free (live-> ref);
+    safe_free (live-> deg);
+    safe_free (live-> ref_frame_start);
+    safe_free (live-> deg_frame_start);
+    safe_free (live-> ref_dens);
+    safe_free (live-> deg_dens);
+    safe_free (live-> irs_gain);
+    safe_free (live-> window);
+    safe_free (live-> frame);
+    safe_free (live);
+}
+
+/* Makes room for Nmore samples past the furthest of the two signals,
+   dropping only samples older than the next window can use. */
+
+static int live_reserve( LIVE_INFO * live, long Nmore )
+{
+    long keep_from = live-> next - live-> Nwindow - SEARCHBUFFER * Downsample - live-> Nf;
+    long end = max (live-> Nref, live-> Ndeg) + Nmore;
+
+    if (end - live-> base <= live-> size) {
+        return 0;
+    }
+
+    keep_from = max (keep_from, live-> base);
+    if (keep_from > live-> base) {
+        long Nkept = max (live-> Nref, live-> Ndeg) - keep_from;
+        memmove (live-> ref, live-> ref + (keep_from - live-> base), Nkept * sizeof (float));
+        memmove (live-> deg, live-> deg + (keep_from - live-> base), Nkept * sizeof (float));
+        live-> base = keep_from;
+    }
+
+    if (end - live-> base > live-> size) {
+        long   size = 2 * (end - live-> base);
+        float *ref = (float *) safe_malloc (size * sizeof (float));
+        float *deg = (float *) safe_malloc (size * sizeof (float));
+
+        if ((ref == NULL) || (deg == NULL)) {
+            safe_free (ref);
+            safe_free (deg);
+            return -1;
+        }
+        memcpy (ref, live-> ref, live-> size * sizeof (float));
+        memcpy (deg, live-> deg, live-> size * sizeof (float));
+        safe_free (live-> ref);
+        safe_free (live-> deg);
+        live-> ref = ref;
+        live-> deg = deg;
+        live-> size = size;
+    }
+    return 0;
+}
+
+int live_push( LIVE_INFO * live, const float * ref, long Nref,
+     const float * deg, long Ndeg )
+{
+    if (live_reserve (live, max (Nref + live-> Nref, Ndeg + live-> Ndeg) - max (live-> Nref, live-> Ndeg)) != 0) {
+        return -1;
+    }
+    memcpy (live-> ref + (live-> Nref - live-> base), ref, Nref * sizeof (float));
+    memcpy (live-> deg + (live-> Ndeg - live-> base), deg, Ndeg * sizeof (float));
+    live-> Nref += Nref;
+    live-> Ndeg += Ndeg;
+    return 0;
+}
+
+void live_end( LIVE_INFO * live )
+{
+    live-> ended = TRUE;
+}
+
+/* Band densities, before level scaling, of the frame of signal x
+   (retained from live-> base) starting at absolute sample start, with
+   the samples outside the window [first, last) silent, into frame of
+   dens. */
+
+static void live_frame( LIVE_INFO * live, float * x, long first, long last, long start,
+     float * dens, long frame, float * hz_spectrum, float * fft_tmp )
+{
+    SIGNAL_INFO frame_info;
+    long        Nf = live-> Nf;
+    long        k;
+
+    if ((start >= first) && (start + Nf <= last)) {
+        frame_info. data = x;
+        short_term_fft (Nf, &frame_info, live-> window, start - live-> base, hz_spectrum, fft_tmp);
+        live-> Nframes_computed++;
+    } else if ((start + Nf > first) && (start < last)) {
+        for (k = 0; k < Nf; k++) {
+            live-> frame [k] = ((start + k >= first) && (start + k < last)) ? x [start + k - live-> base] : 0.0f;
+        }
+        frame_info. data = live-> frame;
+        short_term_fft (Nf, &frame_info, live-> window, 0, hz_spectrum, fft_tmp);
+        live-> Nframes_computed++;
+    } else {
+        for (k = 0; k < Nf / 2; k++) {
+            hz_spectrum [k] = 0;
+        }
+    }
+    for (k = 0; k < Nf / 2; k++) {
+        hz_spectrum [k] *= live-> irs_gain [k];
+    }
+    freq_warping (Nf / 2, hz_spectrum, Nb, dens, frame);
+}
+
+/* Band densities of the frame of x starting at absolute sample start in
+   the window [first, last), scaled by gain, into frame of dens. A frame
+   wholly in the window is kept in the slot of its start in frame_start
+   and frame_dens for later windows. */
+
+static void live_densities( LIVE_INFO * live, float * x, long * frame_start, float * frame_dens,
+     long first, long last, long start, float gain, float * dens, long frame,
+     float * hz_spectrum, float * fft_tmp )
+{
+    long Nf = live-> Nf;
+    long band;
+
+    if ((start >= first) && (start + Nf <= last)) {
+        long slot = (start / (Nf / 2)) % live-> Nslots;
+
+        if (frame_start [slot] != start) {
+            live_frame (live, x, first, last, start, frame_dens, slot, hz_spectrum, fft_tmp);
+            frame_start [slot] = start;
+        }
+        for (band = 0; band < Nb; band++) {
+            dens [frame * Nb + band] = frame_dens [slot * Nb + band] * gain;
+        }
+    } else {
+        live_frame (live, x, first, last, start, dens, frame, hz_spectrum, fft_tmp);
+        for (band = 0; band < Nb; band++) {
+            dens [frame * Nb + band] *= gain;
+        }
+    }
+}
+
+/* Loads the window [start, end) of x into info as +ref-range loads it,
+   then levels and IRS filters it as pesq_process does. Returns the gain
+   fix_power_level gives it, 1 if it is silent or 0 if memory ran out. */
+
+static float live_load( LIVE_INFO * live, float * x, long start, long end, SIGNAL_INFO * info )
+{
+    long  margin = SEARCHBUFFER * Downsample;
+    long  length = end - start + 2 * margin + DATAPADDING_MSECS * (Fs / 1000);
+    float gain;
+    long  i;
+
+    info-> Nsamples = end - start + 2 * margin;
+    info-> data = (float *) safe_malloc (length * sizeof (float));
+    info-> VAD = (float *) safe_malloc (info-> Nsamples / Downsample * sizeof (float));
+    info-> logVAD = (float *) safe_malloc (info-> Nsamples / Downsample * sizeof (float));
+    if ((info-> data == NULL) || (info-> VAD == NULL) || (info-> logVAD == NULL)) {
+        return 0;
+    }
+    for (i = 0; i < length; i++) {
+        long t = start - margin + i;
+        info-> data [i] = ((t >= start) && (t < end)) ? x [t - live-> base] : 0.0f;
+    }
+
+    gain = power_level_gain (info, info-> Nsamples);
+    if (!(gain < 1E30)) {
+        gain = 1.0f;
+    }
+    for (i = 0; i < info-> Nsamples; i++) {
+        info-> data [i] *= gain;
+    }
+    apply_filter (info-> data, info-> Nsamples, 26, standard_IRS_filter_dB);
+
+    return gain;
+}
+
+/* Scores the next window once both signals cover it. Returns 1 with the
+   MOS and utterances in err_info, 0 if the window is not complete yet or
+   -1 if memory ran out. */
+
+int live_score( LIVE_INFO * live, ERROR_INFO * err_info )
+{
+    long    Nf = live-> Nf;
+    long    margin = SEARCHBUFFER * Downsample;
+    long    padding = DATAPADDING_MSECS * (Fs / 1000);
+    long    end = live-> next;
+    long    start = end - live-> Nwindow;
+    long    Nsamples = live-> Nwindow + 2 * margin;
+    long    start_frame, stop_frame;
+    float * ftmp = NULL;
+    float * hz_spectrum = NULL;
+    float * fft_tmp = NULL;
+    float * pitch_pow_dens_ref = NULL;
+    float * pitch_pow_dens_deg = NULL;
+    int   * silent = NULL;
+    SIGNAL_INFO ref_info;
+    SIGNAL_INFO deg_info;
+    float   ref_gain = 1;
+    float   deg_gain = 1;
+    long    frame;
+    int     result = 1;
+
+    ref_info. data = ref_info. VAD = ref_info. logVAD = NULL;
+    deg_info. data = deg_info. VAD = deg_info. logVAD = NULL;
+
+    if ((live-> Nref < end) || (live-> Ndeg < end)) {
+        return 0;
+    }
+
+    ref_gain = live_load (live, live-> ref, start, end, &ref_info);
+    deg_gain = live_load (live, live-> deg, start, end, &deg_info);
+    ftmp = (float *) safe_malloc (max (Nsamples + padding, 12 * Align_Nfft) * sizeof (float));
+    if ((ref_gain == 0) || (deg_gain == 0) || (ftmp == NULL)) {
+        result = -1;
+    }
+
+    if (result == 1) {
+        align_pair (&ref_info, &deg_info, err_info, ftmp, FALSE);
+        if (err_info-> Nutterances < 1) {
+            err_info-> Nutterances = 1;
+            err_info-> Utt_Start [0] = SEARCHBUFFER;
+            err_info-> Utt_End [0] = Nsamples / Downsample - SEARCHBUFFER;
+            err_info-> Utt_Delay [0] = err_info-> Crude_DelayEst;
+        }
+        live-> delay = err_info-> Utt_Delay [err_info-> Nutterances - 1];
+
+        model_frame_range (&ref_info, Nsamples, &start_frame, &stop_frame);
+
+        hz_spectrum = (float *) safe_malloc ((Nf / 2) * sizeof (float));
+        fft_tmp = (float *) safe_malloc ((Nf + 2) * sizeof (float));
+        pitch_pow_dens_ref = (float *) safe_malloc ((stop_frame + 1) * Nb * sizeof (float));
+        pitch_pow_dens_deg = (float *) safe_malloc ((stop_frame + 1) * Nb * sizeof (float));
+        silent = (int *) safe_malloc ((stop_frame + 1) * sizeof (int));
+        if ((hz_spectrum == NULL) || (fft_tmp == NULL) || (pitch_pow_dens_ref == NULL) ||
+            (pitch_pow_dens_deg == NULL) || (silent == NULL)) {
+            result = -1;
+        }
+    }
+
+    if (result == 1) {
+        profile_start (PROFILE_MODEL);
+
+        /* the frames of pesq_psychoacoustic_model, start_sample_ref and
+           start_sample_deg counting from the start of the loaded window;
+           a degraded frame that does not fit in it is silent */
+        for (frame = 0; frame <= stop_frame; frame++) {
+            long start_sample_ref = margin + frame * (Nf / 2);
+            long start_sample_deg = start_sample_ref + utterance_delay_at (err_info, start_sample_ref);
+            long band;
+
+            live_densities (live, live-> ref, live-> ref_frame_start, live-> ref_dens, start, end,
+                            start - margin + start_sample_ref, ref_gain * ref_gain,
+                            pitch_pow_dens_ref, frame, hz_spectrum, fft_tmp);
+            if ((start_sample_deg > 0) && (start_sample_deg + Nf < Nsamples + padding)) {
+                live_densities (live, live-> deg, live-> deg_frame_start, live-> deg_dens, start, end,
+                                start - margin + start_sample_deg, deg_gain * deg_gain,
+                                pitch_pow_dens_deg, frame, hz_spectrum, fft_tmp);
+            } else {
+                for (band = 0; band < Nb; band++) {
+                    pitch_pow_dens_deg [frame * Nb + band] = 0;
+                }
+            }
+            silent [frame] = (total_audible (frame, pitch_pow_dens_ref, 1E2) < 1E7);
+        }
+
+        pesq_score_frames (&ref_info, &deg_info, err_info, start_frame, stop_frame,
+                           live-> window, silent, pitch_pow_dens_ref, pitch_pow_dens_deg, FALSE);
+
+        live-> next += live-> Nhop;
+    }
+
+    safe_free (ftmp);
+    safe_free (hz_spectrum);
+    safe_free (fft_tmp);
+    safe_free (pitch_pow_dens_ref);
+    safe_free (pitch_pow_dens_deg);
+    safe_free (silent);
+    safe_free (ref_info. data);
+    safe_free (ref_info. VAD);
+    safe_free (ref_info. logVAD);
+    safe_free (deg_info. data);
+    safe_free (deg_info. VAD);
+    safe_free (deg_info. logVAD);
+
+    return result;
+}
+
+/* Scores ref_info and deg_info as they are read, a window every hop. Each
+   score is printed and written to the result files as a pair of its own. */
+
+void live_measure( SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     double window_seconds, double hop_seconds, RESULT_SINK * sink,
+     long * Error_Flag, char ** Error_Type )
+{
+    SRC_STREAM * ref_stream = NULL;
+    SRC_STREAM * deg_stream = NULL;
+    LIVE_INFO  * live;
+    ERROR_INFO   err_info;
+    long         chunk = max ((long) (hop_seconds * Fs), 1);
+    float      * ref = (float *) safe_malloc (chunk * sizeof (float));
+    float      * deg = (float *) safe_malloc (chunk * sizeof (float));
+    double       start_time = wall_clock ();
+
+    live = live_open (window_seconds, hop_seconds, Error_Flag, Error_Type);
+    if ((*Error_Flag) == 0) {
+        ref_stream = open_src_stream (Error_Flag, Error_Type, ref_info);
+    }
+    if ((*Error_Flag) == 0) {
+        deg_stream = open_src_stream (Error_Flag, Error_Type, deg_info);
+    }
+    if (((*Error_Flag) == 0) && ((ref == NULL) || (deg == NULL))) {
+        *Error_Flag = 1;
+        *Error_Type = "Failed to allocate memory for live scoring";
+    }
+
+    err_info. subj_mos = 0;
+    err_info. cond_nr = 0;
+
+    while ((*Error_Flag) == 0) {
+        long Nref = read_src_stream (ref_stream, ref_info, ref, chunk);
+        long Ndeg = read_src_stream (deg_stream, deg_info, deg, chunk);
+        int  scored;
+
+        if ((Nref == 0) && (Ndeg == 0)) {
+            live_end (live);
+        } else if (live_push (live, ref, Nref, deg, Ndeg) != 0) {
+            *Error_Flag = 1;
+            *Error_Type = "Failed to allocate memory for live scoring";
+            break;
+        }
+        while ((scored = live_score (live, &err_info)) == 1) {
+            printf ("Live : %.2f s PESQ_MOS = %.3f delay = %.4f s\n",
+                    (double) (live-> next - live-> Nhop) / Fs,
+                    (double) err_info. pesq_mos, (double) live-> delay / Fs);
+            write_results (sink, ref_info, deg_info, &err_info, wall_clock () - start_time);
+            start_time = wall_clock ();
+        }
+        if (scored < 0) {
+            *Error_Flag = 1;
+            *Error_Type = "Failed to allocate memory for live scoring";
+        }
+        if (live-> ended) {
+            break;
+        }
+    }
+
+    if (live != NULL) {
+        printf ("Live scoring: %ld frames analysed.\n", live-> Nframes_computed);
+    }
+
+    if (ref_stream != NULL) {
+        close_src_stream (ref_stream);
+    }
+    if (deg_stream != NULL) {
+        close_src_stream (deg_stream);
+    }
+    live_close (live);
+    safe_free (ref);
+    safe_free (deg);
+}
+
+/* END OF FILE */
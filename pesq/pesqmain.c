@@ -1,610 +1,944 @@
-/*****************************************************************************
-
-Perceptual Evaluation of Speech Quality (PESQ)
-ITU-T Recommendation P.862.
-Version 1.2 - 2 August 2002.
-
-              ****************************************
-              PESQ Intellectual Property Rights Notice
-              ****************************************
-
-DEFINITIONS:
-------------
-For the purposes of this Intellectual Property Rights Notice
-the terms 'Perceptual Evaluation of Speech Quality Algorithm'
-and 'PESQ Algorithm' refer to the objective speech quality
-measurement algorithm defined in ITU-T Recommendation P.862;
-the term 'PESQ Software' refers to the C-code component of P.862. 
-
-NOTICE:
--------
-All copyright, trade marks, trade names, patents, know-how and
-all or any other intellectual rights subsisting in or used in
-connection with including all algorithms, documents and manuals
-relating to the PESQ Algorithm and or PESQ Software are and remain
-the sole property in law, ownership, regulations, treaties and
-patent rights of the Owners identified below. The user may not
-dispute or question the ownership of the PESQ Algorithm and
-or PESQ Software.
-
-OWNERS ARE:
------------
-
-1.	British Telecommunications plc (BT), all rights assigned
-      to Psytechnics Limited
-2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
-
-RESTRICTIONS:
--------------
-
-The user cannot:
-
-1.	alter, duplicate, modify, adapt, or translate in whole or in
-      part any aspect of the PESQ Algorithm and or PESQ Software
-2.	sell, hire, loan, distribute, dispose or put to any commercial
-      use other than those permitted below in whole or in part any
-      aspect of the PESQ Algorithm and or PESQ Software
-
-PERMITTED USE:
---------------
-
-The user may:
-
-1.	Use the PESQ Software to:
-      i)   understand the PESQ Algorithm; or
-      ii)  evaluate the ability of the PESQ Algorithm to perform
-           its intended function of predicting the speech quality
-           of a system; or
-      iii) evaluate the computational complexity of the PESQ Algorithm,
-           with the limitation that none of said evaluations or its
-           results shall be used for external commercial use.
-
-2.	Use the PESQ Software to test if an implementation of the PESQ
-      Algorithm conforms to ITU-T Recommendation P.862.
-
-3.	With the prior written permission of both Psytechnics Limited
-      and OPTICOM GmbH, use the PESQ Software in accordance with the
-      above Restrictions to perform work that meets all of the following
-      criteria:
-      i)    the work must contribute directly to the maintenance of an
-            existing ITU recommendation or the development of a new ITU
-            recommendation under an approved ITU Study Item; and
-      ii)   the work and its results must be fully described in a
-            written contribution to the ITU that is presented at a formal
-            ITU meeting within one year of the start of the work; and
-      iii)  neither the work nor its results shall be put to any
-            commercial use other than making said contribution to the ITU.
-            Said permission will be provided on a case-by-case basis.
-
-
-ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
-ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
-FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
-
-EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
-IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
-AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
-
-
-***********************************************************************
-*  OPTICOM GmbH                    *  Psytechnics Limited             *
-*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
-*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
-*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
-*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
-*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
-*  www.opticom.de                  *  www.psytechnics.com             *
-***********************************************************************
-
-Further information is also available from www.pesq.org
-
-*****************************************************************************/
-
-#include <stdio.h>
-#include <math.h>
-#include "pesq.h"
-#include "dsp.h"
-
-#define ITU_RESULTS_FILE          "_pesq_itu_results.txt"
-#define SIMPLE_RESULTS_FILE       "_pesq_results.txt"
-
-
-int main (int argc, const char *argv []);
-void usage (void);
-void pesq_measure (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
-    ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type);
-
-void usage (void) {
-    printf ("Usage:\n");
-    printf (" PESQ HELP               Displays this text\n");
-    printf (" PESQ [options] ref deg [smos] [cond]\n");
-    printf (" Run model on reference ref and degraded deg\n");
-    printf ("\n");
-    printf ("Options: +8000 +16000 +swap\n");
-    printf (" Sample rate - No default. Must select either +8000 or +16000.\n");
-    printf (" Swap byte order - machine native format by default. Select +swap for byteswap.\n");
-    printf ("\n");
-    printf (" [smos] is an optional number copied to %s\n", ITU_RESULTS_FILE);
-    printf (" [cond] is an optional condition number copied to %s\n", ITU_RESULTS_FILE);
-    printf (" smos must always precede cond. However, both may be omitted.");
-    printf ("\n");
-    printf ("File names, smos, cond may not begin with a + character.\n");
-    printf ("\n");
-    printf ("Files with names ending .wav or .WAV are assumed to have a 44-byte header, which");
-    printf (" is automatically skipped.  All other file types are assumed to have no header.\n");
-}
-
-int main (int argc, const char *argv []) {
-    int  arg;
-    int  names = 0;
-    long sample_rate = -1;
-    
-    SIGNAL_INFO ref_info;
-    SIGNAL_INFO deg_info;
-    ERROR_INFO err_info;
-
-    long Error_Flag = 0;
-    char * Error_Type = "Unknown error type.";
-
-    if (Error_Flag == 0) {
-        printf("Perceptual Evaluation of Speech Quality (PESQ) - ITU-T Recommendation P.862.\n");
-        printf("Version 1.2 - 2 August 2002.\n");
-        printf("\n");
-        printf("PESQ Intellectual Property Rights Notice.\n");
-        printf("\n");
-        printf("DEFINITIONS:\n");
-        printf("For the purposes of this Intellectual Property Rights Notice the terms\n");
-        printf("'Perceptual Evaluation of Speech Quality Algorithm' and 'PESQ Algorithm'\n");
-        printf("refer to the objective speech quality measurement algorithm defined in ITU-T\n");
-        printf("Recommendation P.862; the term 'PESQ Software' refers to the C-code component\n");
-        printf("of P.862.\n");
-        printf("\n");
-        printf("NOTICE:\n");
-        printf("All copyright, trade marks, trade names, patents, know-how and all or any other\n");
-        printf("intellectual rights subsisting in or used in connection with including all\n");
-        printf("algorithms, documents and manuals relating to the PESQ Algorithm and or PESQ\n");
-        printf("Software are and remain the sole property in law, ownership, regulations,\n");
-        printf("treaties and patent rights of the Owners identified below. The user may not\n");
-        printf("dispute or question the ownership of the PESQ Algorithm and or PESQ Software.\n");
-        printf("\n");
-        printf("OWNERS ARE:\n");
-        printf("1.	British Telecommunications plc (BT), all rights assigned\n");
-        printf("      to Psytechnics Limited\n");
-        printf("2.	Royal KPN NV, all rights assigned to OPTICOM GmbH\n");
-        printf("\n");
-        printf("RESTRICTIONS:\n");
-        printf("The user cannot:\n");
-        printf("1.	alter, duplicate, modify, adapt, or translate in whole or in\n");
-        printf("      part any aspect of the PESQ Algorithm and or PESQ Software\n");
-        printf("2.	sell, hire, loan, distribute, dispose or put to any commercial\n");
-        printf("      use other than those permitted below in whole or in part any\n");
-        printf("      aspect of the PESQ Algorithm and or PESQ Software\n");
-        printf("\n");
-        printf("PERMITTED USE:\n");
-        printf("The user may:\n");
-        printf("1.	Use the PESQ Software to:\n");
-        printf("      i)   understand the PESQ Algorithm; or\n");
-        printf("      ii)  evaluate the ability of the PESQ Algorithm to perform its intended\n");
-        printf("           function of predicting the speech quality of a system; or\n");
-        printf("      iii) evaluate the computational complexity of the PESQ Algorithm,\n");
-        printf("           with the limitation that none of said evaluations or its\n");
-        printf("           results shall be used for external commercial use.\n");
-        printf("2.	Use the PESQ Software to test if an implementation of the PESQ\n");
-        printf("      Algorithm conforms to ITU-T Recommendation P.862.\n");
-        printf("3.	With the prior written permission of both Psytechnics Limited and\n");
-        printf("      OPTICOM GmbH, use the PESQ Software in accordance with the above\n");
-        printf("      Restrictions to perform work that meets all of the following criteria:\n");
-        printf("      i)    the work must contribute directly to the maintenance of an\n");
-        printf("            existing ITU recommendation or the development of a new ITU\n");
-        printf("            recommendation under an approved ITU Study Item; and\n");
-        printf("      ii)   the work and its results must be fully described in a\n");
-        printf("            written contribution to the ITU that is presented at a formal\n");
-        printf("            ITU meeting within one year of the start of the work; and\n");
-        printf("      iii)  neither the work nor its results shall be put to any\n");
-        printf("            commercial use other than making said contribution to the ITU.\n");
-        printf("            Said permission will be provided on a case-by-case basis.\n");
-        printf("\n");
-        printf("ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ ALGORITHM\n");
-        printf("WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED FROM EITHER\n");
-        printf("OPTICOM GMBH OR PSYTECHNICS LIMITED. \n");
-        printf("\n");
-        printf("EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM\n");
-        printf("IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE\n");
-        printf("AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.\n");
-        printf("\n");
-        printf("***********************************************************************\n");
-        printf("*  OPTICOM GmbH                    *  Psytechnics Limited             *\n");
-        printf("*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *\n");
-        printf("*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *\n");
-        printf("*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *\n");
-        printf("*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *\n");
-        printf("*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *\n");
-        printf("*  www.opticom.de                  *  www.psytechnics.com             *\n");
-        printf("***********************************************************************\n");
-        printf("\n");
-
-        if (argc < 3){
-            usage ();
-            return 0;                                                                  
-        } else {
-
-            strcpy (ref_info.path_name, "");
-            ref_info.apply_swap = 0;
-            strcpy (deg_info.path_name, "");
-            deg_info.apply_swap = 0;
-            err_info. subj_mos = 0;
-            err_info. cond_nr = 0;
-
-            for (arg = 1; arg < argc; arg++) {
-                if (argv [arg] [0] == '+') {
-                    if (strcmp (argv [arg], "+swap") == 0) {
-                        ref_info.apply_swap = 1;
-                        deg_info.apply_swap = 1;
-                    } else {
-                        if (strcmp (argv [arg], "+16000") == 0) {
-                            sample_rate = 16000L;
-                        } else {
-                            if (strcmp (argv [arg], "+8000") == 0) {
-                                sample_rate = 8000L;
-                            } else {
-                                usage ();
-                                fprintf (stderr, "Invalid parameter '%s'.\n", argv [arg]);
-                                return 1;
-                            }
-                        }
-                    }
-                } else {
-                    switch (names) {
-                        case 0: 
-                            strcpy (ref_info.path_name, argv [arg]); 
-                            break;
-                        case 1: 
-                            strcpy (deg_info.path_name, argv [arg]); 
-                            break;
-                        case 2: 
-                            sscanf (argv [arg], "%f", &(err_info. subj_mos)); 
-                            break;
-                        case 3: 
-                            sscanf (argv [arg], "%d", &(err_info. cond_nr)); 
-                            break;
-                        default:
-                            usage ();
-                            fprintf (stderr, "Invalid parameter '%s'.\n", argv [arg]);
-                            return 1;
-                    }
-                    names++;
-                }
-            }
-
-            if (sample_rate == -1) {
-                printf ("PESQ Error. Must specify either +8000 or +16000 sample frequency option!\n");
-                exit (1);
-            }
-            
-            strcpy (ref_info. file_name, ref_info. path_name);
-            if (strrchr (ref_info. file_name, '\\') != NULL) {
-                strcpy (ref_info. file_name, 1 + strrchr (ref_info. file_name, '\\'));
-            }
-            if (strrchr (ref_info. file_name, '/') != NULL) {
-                strcpy (ref_info. file_name, 1 + strrchr (ref_info. file_name, '/'));
-            }                
-
-            strcpy (deg_info. file_name, deg_info. path_name);
-            if (strrchr (deg_info. file_name, '\\') != NULL) {
-                strcpy (deg_info. file_name, 1 + strrchr (deg_info. file_name, '\\'));
-            }
-            if (strrchr (deg_info. file_name, '/') != NULL) {
-                strcpy (deg_info. file_name, 1 + strrchr (deg_info. file_name, '/'));
-            }                
-
-            select_rate (sample_rate, &Error_Flag, &Error_Type);
-            pesq_measure (&ref_info, &deg_info, &err_info, &Error_Flag, &Error_Type);
-        }
-    }
-
-    if (Error_Flag == 0) {
-        printf ("\nPrediction : PESQ_MOS = %.3f\n", (double) err_info.pesq_mos);
-        return 0;
-    } else {
-        printf ("An error of type %d ", Error_Flag);
-        if (Error_Type != NULL) {
-            printf (" (%s) occurred during processing.\n", Error_Type);
-        } else {
-            printf ("occurred during processing.\n");
-        }
-
-        return 0;
-    }
-}
-
-double align_filter_dB [26] [2] = {{0.,-500},
-                                 {50., -500},
-                                 {100., -500},
-                                 {125., -500},
-                                 {160., -500},
-                                 {200., -500},
-                                 {250., -500},
-                                 {300., -500},
-                                 {350.,  0},
-                                 {400.,  0},
-                                 {500.,  0},
-                                 {600.,  0},
-                                 {630.,  0},
-                                 {800.,  0},
-                                 {1000., 0},
-                                 {1250., 0},
-                                 {1600., 0},
-                                 {2000., 0},
-                                 {2500., 0},
-                                 {3000., 0},
-                                 {3250., 0},
-                                 {3500., -500},
-                                 {4000., -500},
-                                 {5000., -500},
-                                 {6300., -500},
-                                 {8000., -500}}; 
-
-
-double standard_IRS_filter_dB [26] [2] = {{  0., -200},
-                                         { 50., -40}, 
-                                         {100., -20},
-                                         {125., -12},
-                                         {160.,  -6},
-                                         {200.,   0},
-                                         {250.,   4},
-                                         {300.,   6},
-                                         {350.,   8},
-                                         {400.,  10},
-                                         {500.,  11},
-                                         {600.,  12},
-                                         {700.,  12},
-                                         {800.,  12},
-                                         {1000., 12},
-                                         {1300., 12},
-                                         {1600., 12},
-                                         {2000., 12},
-                                         {2500., 12},
-                                         {3000., 12},
-                                         {3250., 12},
-                                         {3500., 4},
-                                         {4000., -200},
-                                         {5000., -200},
-                                         {6300., -200},
-                                         {8000., -200}}; 
-
-
-#define TARGET_AVG_POWER    1E7
-
-void fix_power_level (SIGNAL_INFO *info, char *name, long maxNsamples) 
-{
-    long   n = info-> Nsamples;
-    long   i;
-    float *align_filtered = (float *) safe_malloc ((n + DATAPADDING_MSECS  * (Fs / 1000)) * sizeof (float));    
-    float  global_scale;
-    float  power_above_300Hz;
-
-    for (i = 0; i < n + DATAPADDING_MSECS  * (Fs / 1000); i++) {
-        align_filtered [i] = info-> data [i];
-    }
-    apply_filter (align_filtered, info-> Nsamples, 26, align_filter_dB);
-
-    power_above_300Hz = (float) pow_of (align_filtered, 
-                                        SEARCHBUFFER * Downsample, 
-                                        n - SEARCHBUFFER * Downsample + DATAPADDING_MSECS  * (Fs / 1000),
-                                        maxNsamples - 2 * SEARCHBUFFER * Downsample + DATAPADDING_MSECS  * (Fs / 1000));
-
-    global_scale = (float) sqrt (TARGET_AVG_POWER / power_above_300Hz); 
-
-    for (i = 0; i < n; i++) {
-        info-> data [i] *= global_scale;    
-    }
-
-    safe_free (align_filtered);
-}
-
-       
-void pesq_measure (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
-    ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type)
-{
-    float * ftmp = NULL;
-
-    ref_info-> data = NULL;
-    ref_info-> VAD = NULL;
-    ref_info-> logVAD = NULL;
-    
-    deg_info-> data = NULL;
-    deg_info-> VAD = NULL;
-    deg_info-> logVAD = NULL;
-        
-    if ((*Error_Flag) == 0)
-    {
-        printf ("Reading reference file %s...", ref_info-> path_name);
-
-       load_src (Error_Flag, Error_Type, ref_info);
-       if ((*Error_Flag) == 0)
-           printf ("done.\n");
-    }
-    if ((*Error_Flag) == 0)
-    {
-        printf ("Reading degraded file %s...", deg_info-> path_name);
-
-       load_src (Error_Flag, Error_Type, deg_info);
-       if ((*Error_Flag) == 0)
-           printf ("done.\n");
-    }
-
-    if (((ref_info-> Nsamples - 2 * SEARCHBUFFER * Downsample < Fs / 4) ||
-         (deg_info-> Nsamples - 2 * SEARCHBUFFER * Downsample < Fs / 4)) &&
-        ((*Error_Flag) == 0))
-    {
-        (*Error_Flag) = 2;
-        (*Error_Type) = "Reference or Degraded below 1/4 second - processing stopped ";
-    }
-
-    if ((*Error_Flag) == 0)
-    {
-        alloc_other (ref_info, deg_info, Error_Flag, Error_Type, &ftmp);
-    }
-
-    if ((*Error_Flag) == 0)
-    {   
-        int     maxNsamples = max (ref_info-> Nsamples, deg_info-> Nsamples);
-        float * model_ref; 
-        float * model_deg; 
-        long    i;
-        FILE *resultsFile;
-
-        printf (" Level normalization...\n");            
-        fix_power_level (ref_info, "reference", maxNsamples);
-        fix_power_level (deg_info, "degraded", maxNsamples);
-
-        printf (" IRS filtering...\n"); 
-        apply_filter (ref_info-> data, ref_info-> Nsamples, 26, standard_IRS_filter_dB);
-        apply_filter (deg_info-> data, deg_info-> Nsamples, 26, standard_IRS_filter_dB);
-
-        model_ref = (float *) safe_malloc ((ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000)) * sizeof (float));
-        model_deg = (float *) safe_malloc ((deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000)) * sizeof (float));
-
-        for (i = 0; i < ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
-            model_ref [i] = ref_info-> data [i];
-        }
-    
-        for (i = 0; i < deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
-            model_deg [i] = deg_info-> data [i];
-        }
-    
-        input_filter( ref_info, deg_info, ftmp );
-
-        printf (" Variable delay compensation...\n");            
-        calc_VAD (ref_info);
-        calc_VAD (deg_info);
-        
-        crude_align (ref_info, deg_info, err_info, WHOLE_SIGNAL, ftmp);
-
-        utterance_locate (ref_info, deg_info, err_info, ftmp);
-    
-        for (i = 0; i < ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
-            ref_info-> data [i] = model_ref [i];
-        }
-    
-        for (i = 0; i < deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
-            deg_info-> data [i] = model_deg [i];
-        }
-
-        safe_free (model_ref);
-        safe_free (model_deg); 
-    
-        if ((*Error_Flag) == 0) {
-            if (ref_info-> Nsamples < deg_info-> Nsamples) {
-                float *new_ref = (float *) safe_malloc((deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000)) * sizeof(float));
-                long  i;
-                for (i = 0; i < ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
-                    new_ref [i] = ref_info-> data [i];
-                }
-                for (i = ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); 
-                     i < deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
-                    new_ref [i] = 0.0f;
-                }
-                safe_free (ref_info-> data);
-                ref_info-> data = new_ref;
-                new_ref = NULL;
-            } else {
-                if (ref_info-> Nsamples > deg_info-> Nsamples) {
-                    float *new_deg = (float *) safe_malloc((ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000)) * sizeof(float));
-                    long  i;
-                    for (i = 0; i < deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
-                        new_deg [i] = deg_info-> data [i];
-                    }
-                    for (i = deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); 
-                         i < ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
-                        new_deg [i] = 0.0f;
-                    }
-                    safe_free (deg_info-> data);
-                    deg_info-> data = new_deg;
-                    new_deg = NULL;
-                }
-            }
-        }        
-
-        printf (" Acoustic model processing...\n");    
-        pesq_psychoacoustic_model (ref_info, deg_info, err_info, ftmp);
-    
-        safe_free (ref_info-> data);
-        safe_free (ref_info-> VAD);
-        safe_free (ref_info-> logVAD);
-        safe_free (deg_info-> data);
-        safe_free (deg_info-> VAD);
-        safe_free (deg_info-> logVAD);
-        safe_free (ftmp);
-
-        resultsFile = fopen (ITU_RESULTS_FILE, "at");
-
-        if (resultsFile != NULL) {
-            long start, end;
-
-            if (0 != fseek (resultsFile, 0, SEEK_SET)) {
-                printf ("Could not move to start of results file %s!\n", ITU_RESULTS_FILE);
-                exit (1);
-            }
-            start = ftell (resultsFile);
-
-            if (0 != fseek (resultsFile, 0, SEEK_END)) {
-                printf ("Could not move to end of results file %s!\n", ITU_RESULTS_FILE);
-                exit (1);
-            }
-            end = ftell (resultsFile);
-
-            if (start == end) {
-                fprintf (resultsFile, "REFERENCE\t DEGRADED\t PESQMOS\t PESQMOS\t SUBJMOS\t COND\t SAMPLE_FREQ\t CRUDE_DELAY\n");
-                fflush (resultsFile);
-            }
-
-            fprintf (resultsFile, "%s\t ", ref_info-> path_name);
-            fprintf (resultsFile, "%s\t ", deg_info-> path_name);
-            fprintf (resultsFile, "SQValue=%.3f\t ", err_info->pesq_mos);
-            fprintf (resultsFile, "%.3f\t ", err_info->pesq_mos);
-            fprintf (resultsFile, "%.3f\t ", err_info->subj_mos);
-            fprintf (resultsFile, "%d\t ", err_info->cond_nr);
-            fprintf (resultsFile, "%d\t", Fs);
-            fprintf (resultsFile, "%.4f\n ", (float) err_info-> Crude_DelayEst / (float) Fs); 
-            
-            fclose (resultsFile);
-        }
-
-        resultsFile = fopen (SIMPLE_RESULTS_FILE, "at");
-
-        if (resultsFile != NULL) {
-            long start, end;
-
-            if (0 != fseek (resultsFile, 0, SEEK_SET)) {
-                printf ("Could not move to start of results file %s!\n", SIMPLE_RESULTS_FILE);
-                exit (1);
-            }
-            start = ftell (resultsFile);
-
-            if (0 != fseek (resultsFile, 0, SEEK_END)) {
-                printf ("Could not move to end of results file %s!\n", SIMPLE_RESULTS_FILE);
-                exit (1);
-            }
-            end = ftell (resultsFile);
-
-            if (start == end) {
-                fprintf (resultsFile, "DEGRADED\t PESQMOS\t SUBJMOS\t COND\t SAMPLE_FREQ\t CRUDE_DELAY\n");
-                fflush (resultsFile);
-            }
-
-            fprintf (resultsFile, "%s\t ", deg_info-> file_name);
-            fprintf (resultsFile, "%.3f\t ", err_info->pesq_mos);
-            fprintf (resultsFile, "%.3f\t ", err_info->subj_mos);
-            fprintf (resultsFile, "%d\t ", err_info->cond_nr);
-            fprintf (resultsFile, "%d\t", Fs);
-            fprintf (resultsFile, "%.4f\n ", (float) err_info-> Crude_DelayEst / (float) Fs); 
-            
-            fclose (resultsFile);
-        }
-    }
-
-    return;
-}
-
-/* END OF FILE */
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
+the terms 'Perceptual Evaluation of Speech Quality Algorithm'
+and 'PESQ Algorithm' refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term 'PESQ Software' refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "pesq.h"
+#include "dsp.h"
+
+#define ITU_RESULTS_FILE          "_pesq_itu_results.txt"
+#define SIMPLE_RESULTS_FILE       "_pesq_results.txt"
+#define CSV_RESULTS_FILE          "_pesq_results.csv"
+#define JSON_RESULTS_FILE         "_pesq_results.json"
+#define PROFILE_RESULTS_FILE      "_pesq_profile.json"
+
+
+int main (int argc, const char *argv []);
+void usage (void);
+void usage (void) {
+    printf ("Usage:\n");
+    printf (" PESQ HELP               Displays this text\n");
+    printf (" PESQ [options] ref deg [smos] [cond]\n");
+    printf (" Run model on reference ref and degraded deg\n");
+    printf (" Either may be '-' for standard input or 'fd:N' for an inherited descriptor,\n");
+    printf (" but not both the same stream; a RIFF header on such a stream is detected\n");
+    printf (" from its content\n");
+    printf ("\n");
+    printf (" PESQ [options] +serve[=socket]\n");
+    printf (" Keep the model loaded and score one 'ref deg [smos] [cond]' job per line,\n");
+    printf (" replying with one JSON line, on stdin/stdout or on a Unix domain socket.\n");
+    printf (" A socket takes up to 16 connections at once and serves their lines as they\n");
+    printf (" arrive; jobs are scored one at a time, so each waits for those before it\n");
+    printf ("\n");
+    printf (" PESQ [options] +live=window[:hop] ref deg\n");
+    printf (" Score a call as it is read, one MOS every hop seconds (1 by default, rounded\n");
+    printf (" to 16 ms) over the trailing window seconds, as +ref-range and +deg-range\n");
+    printf (" would score that window; ref and deg must be PCM at the model rate\n");
+    printf ("\n");
+    printf (" PESQ [options] +batch=list\n");
+    printf (" Run model on every line 'ref deg [smos] [cond]' of the file list; while a\n");
+    printf (" pair is scored, the files of the next are read ahead, +prefetch=MB at most\n");
+    printf (" (64 by default, 0 to disable). +shard=i/n scores every n-th pair from the i-th\n");
+    printf (" (counted from 1). Progress is kept in list.ckpt (list.i-of-n.ckpt for a shard)\n");
+    printf (" until the batch completes; +resume carries on from it after an interruption.\n");
+    printf (" +jobs=n scores up to n pairs at once, each in a process of its own; with\n");
+    printf (" +memlimit=MB a pair only starts while the peak memory of those running, as\n");
+    printf (" estimated from the lengths in their file headers, stays within MB, and\n");
+    printf (" smaller pairs further on go ahead of one that does not fit\n");
+    printf ("\n");
+    printf (" PESQ +merge=out results...\n");
+    printf (" Join result files, e.g. of the shards of a batch, into out with one header,\n");
+    printf (" dropping records of a pair already seen\n");
+    printf ("\n");
+    printf ("Options: +8000 +16000 +inrate=N +swap +triage[=mos] +csv[=file] +json[=file]\n");
+    printf ("         +profile[=file] +ref-range=s:e +deg-range=s:e +channel=n|all\n");
+    printf ("         +ref-channel=n +deg-channel=n +cache=file +trace=file\n");
+    printf (" Sample rate - No default. Must select either +8000 or +16000.\n");
+    printf (" Input rate - WAV files are converted from the rate in their header; +inrate\n");
+    printf (" gives the rate of headerless input, the model rate by default.\n");
+    printf (" Swap byte order - machine native format by default. Select +swap for byteswap.\n");
+    printf (" Ranges - +ref-range=start:end and +deg-range=start:end score only that window\n");
+    printf (" of each file, in seconds; the end may be left out. Seekable PCM files are\n");
+    printf (" read from the first sample wanted, without loading the rest.\n");
+    printf (" Channels - +channel=n scores channel n (from 1) of both files, +ref-channel\n");
+    printf (" and +deg-channel select them separately. +channel=all reads each file once and\n");
+    printf (" scores every channel pair concurrently, a mono side against each channel of\n");
+    printf (" the other; results name the channel as file#n.\n");
+    printf (" Triage - +triage gives a quick estimate with an error bar from crude alignment\n");
+    printf (" and decimated frames only; +triage=mos rescores in full when mos lies within\n");
+    printf (" the error bar, e.g. +triage=3.0 for an alert threshold of 3.0.\n");
+    printf (" Cache - +cache=file keeps results on disk keyed by the content of both files,\n");
+    printf (" the sample rate and the software version, and reuses them for pairs seen before.\n");
+    printf (" Structured results - +csv and +json append one record per pair, including the\n");
+    printf (" utterance delays and processing time, to %s or %s.\n", CSV_RESULTS_FILE, JSON_RESULTS_FILE);
+    printf (" Profile - +profile appends per-stage times, FFT calls by size, utterance and\n");
+    printf (" bad interval counts and peak heap use as one JSON line per pair to %s.\n", PROFILE_RESULTS_FILE);
+    printf (" Trace - +trace=file appends the utterance alignment, per-frame disturbances,\n");
+    printf (" bad intervals and their delay correlation of every pair as binary records;\n");
+    printf (" only in builds compiled with -DPESQ_TRACE.\n");
+    printf ("\n");
+    printf (" [smos] is an optional number copied to %s\n", ITU_RESULTS_FILE);
+    printf (" [cond] is an optional condition number copied to %s\n", ITU_RESULTS_FILE);
+    printf (" smos must always precede cond. However, both may be omitted.");
+    printf ("\n");
+    printf ("File names, smos, cond may not begin with a + character.\n");
+    printf ("\n");
+    printf ("WAV files are read by parsing their RIFF chunks for the format and the data;\n");
+    printf ("without a RIFF header, .wav files are assumed to have a 44-byte header to skip\n");
+    printf ("and all other files to have none.\n");
+    printf ("WAV data may be 8, 16, 24 or 32 bit PCM or 32 or 64 bit float; FLAC files (up to\n");
+    printf ("24 bit) are decoded directly. The first channel of multichannel input is used\n");
+    printf ("unless another is selected with +channel.\n");
+}
+
+static void print_outcome (ERROR_INFO * err_info, long Error_Flag, char * Error_Type)
+{
+    if ((Error_Flag == 0) && (err_info->pesq_mos_error > 0)) {
+        printf ("\nTriage estimate : PESQ_MOS = %.3f +/- %.3f\n",
+                (double) err_info->pesq_mos, (double) err_info->pesq_mos_error);
+    } else if (Error_Flag == 0) {
+        printf ("\nPrediction : PESQ_MOS = %.3f\n", (double) err_info->pesq_mos);
+    } else {
+        printf ("An error of type %d ", Error_Flag);
+        if (Error_Type != NULL) {
+            printf (" (%s) occurred during processing.\n", Error_Type);
+        } else {
+            printf ("occurred during processing.\n");
+        }
+    }
+}
+
+/* Batch lines read ahead of the pair being scored, with the bytes of
+   their sources the system has been asked to read in the meantime and,
+   under a memory limit, the estimated peak heap of scoring them. */
+#define BATCH_AHEAD             256
+#define BATCH_PREFETCH_BYTES    (64L * 1024 * 1024)
+#define CHECKPOINT_NAME         520
+
+#define LINE_WAITING            0
+#define LINE_RUNNING            1
+#define LINE_DONE               2
+
+typedef struct {
+    char line [2048];
+    long bytes;
+    long footprint;
+    long job;
+    long Error_Flag;
+    int  mine;
+    int  scored;
+    int  state;
+} BATCH_LINE;
+
+/* How a batch is run: the look-ahead, the shard of the pairs this process
+   scores (pair k belongs to shard k % Nshards, counted from 0), whether to
+   carry on from the checkpoint of an interrupted run, and how many pairs
+   may be scored at once within how many bytes of memory (0 for no limit). */
+typedef struct {
+    long prefetch_bytes;
+    long shard;
+    long Nshards;
+    int  resume;
+    long Njobs;
+    long mem_limit;
+} BATCH_PLAN;
+
+/* The descriptor a '-' or 'fd:N' source is read from, or -1 for a file. */
+
+static int stream_fd (const char * path_name)
+{
+    if (strcmp (path_name, "-") == 0) {
+        return 0;
+    }
+    if (strncmp (path_name, "fd:", 3) == 0) {
+        return atoi (path_name + 3);
+    }
+    return -1;
+}
+
+static int is_pair_line (const char * line)
+{
+    const char * text = line + strspn (line, " \t\r\n");
+    return (*text != '\0') && (*text != '#');
+}
+
+/* The checkpoint of a batch run records how many lines of the batch file
+   have been dealt with and the counts so far. It is replaced whole, and
+   only after the results of those lines have been written out, so a run
+   stopped at any point resumes with no pair lost. The name is returned
+   in CHECKPOINT_NAME bytes, or -1 if it does not fit. */
+
+static int checkpoint_name (char * name, const char * batch_name, BATCH_PLAN * plan)
+{
+    int length;
+
+    if (plan-> Nshards > 1) {
+        length = snprintf (name, CHECKPOINT_NAME, "%s.%ld-of-%ld.ckpt", batch_name,
+                           plan-> shard + 1, plan-> Nshards);
+    } else {
+        length = snprintf (name, CHECKPOINT_NAME, "%s.ckpt", batch_name);
+    }
+    return ((length < 0) || (length >= CHECKPOINT_NAME)) ? -1 : 0;
+}
+
+static int write_checkpoint (const char * name, long Nlines, long Npairs, long Nfailed)
+{
+    char  temp_name [CHECKPOINT_NAME + 4];
+    FILE *checkpoint;
+    int   result;
+    int   length = snprintf (temp_name, sizeof (temp_name), "%s.tmp", name);
+
+    if ((length < 0) || (length >= (int) sizeof (temp_name))) {
+        return -1;
+    }
+    checkpoint = fopen (temp_name, "wt");
+    if (checkpoint == NULL) {
+        return -1;
+    }
+    fprintf (checkpoint, "%ld %ld %ld\n", Nlines, Npairs, Nfailed);
+    result = fclose (checkpoint);
+#ifdef _WIN32
+    remove (name);
+#endif
+    if ((result != 0) || (rename (temp_name, name) != 0)) {
+        return -1;
+    }
+    return 0;
+}
+
+static long prefetch_line (const char * line)
+{
+    char  copy [2048];
+    char *ref_name;
+    char *deg_name;
+
+    strcpy (copy, line);
+    ref_name = strtok (copy, " \t\r\n");
+    deg_name = strtok (NULL, " \t\r\n");
+    if ((ref_name == NULL) || (ref_name [0] == '#') || (deg_name == NULL)) {
+        return 0;
+    }
+    return src_prefetch (ref_name) + src_prefetch (deg_name);
+}
+
+/* Fills ref_info and deg_info, and smos and cond in err_info, from the
+   fields of a pair line and returns how many of them there are. */
+
+static int parse_pair_line (const char * line, SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info)
+{
+    char  copy [2048];
+    char *token [4];
+    int   Ntokens = 0;
+    char *p;
+
+    strcpy (copy, line);
+    p = strtok (copy, " \t\r\n");
+
+    while ((p != NULL) && (Ntokens < 4)) {
+        token [Ntokens++] = p;
+        p = strtok (NULL, " \t\r\n");
+    }
+
+    if (Ntokens > 0) {
+        strcpy (ref_info-> path_name, "");
+        strncat (ref_info-> path_name, token [0], sizeof (ref_info-> path_name) - 1);
+    }
+    if (Ntokens > 1) {
+        strcpy (deg_info-> path_name, "");
+        strncat (deg_info-> path_name, token [1], sizeof (deg_info-> path_name) - 1);
+    }
+    err_info-> subj_mos = 0;
+    err_info-> cond_nr = 0;
+    if (Ntokens > 2) {
+        sscanf (token [2], "%f", &(err_info-> subj_mos));
+    }
+    if (Ntokens > 3) {
+        sscanf (token [3], "%d", &(err_info-> cond_nr));
+    }
+    return Ntokens;
+}
+
+/* The estimated peak heap of scoring a pair line. A pair that cannot be
+   sized from its headers is taken to need all of limit, so that it is
+   only ever scored alone. */
+
+static long line_footprint (const char * line, SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    long limit)
+{
+    SIGNAL_INFO ref = *ref_info;
+    SIGNAL_INFO deg = *deg_info;
+    ERROR_INFO  err_info;
+    long        footprint = -1;
+
+    if (parse_pair_line (line, &ref, &deg, &err_info) >= 2) {
+        footprint = pair_footprint (&ref, &deg);
+    }
+    return (footprint < 0) ? limit : footprint;
+}
+
+/* Scores the pairs of a batch file that belong to the shard of plan.
+   While one pair is scored the sources of the following lines, up to
+   plan-> prefetch_bytes of them, are already being read in by the system,
+   so that loading the next pair seldom waits on the disk; 0 reads each
+   pair only when it is due. Progress is checkpointed after every pair and
+   the checkpoint removed once the batch is complete.
+
+   With plan-> Njobs above 1 that many pairs are scored at once, each in a
+   process of its own. Under plan-> mem_limit a pair is only started while
+   the estimated peak heap of those running, its own included, stays within
+   the limit, and a later pair that fits goes ahead of one that does not;
+   a pair too big for the limit on its own is scored once nothing else
+   runs. Lines are checkpointed in order, as far as every pair before them
+   is done, so a resumed run may score again, and record twice, a pair
+   that finished ahead of an earlier one; +merge drops such repeats. */
+
+static void measure_batch (const char * batch_name, SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    RESULT_SINK * sink, int triage, float triage_threshold, BATCH_PLAN * plan,
+    long * Error_Flag, char ** Error_Type)
+{
+    static BATCH_LINE ahead [BATCH_AHEAD];
+    char       checkpoint [CHECKPOINT_NAME];
+    ERROR_INFO err_info;
+    long       Npairs = 0;
+    long       Nfailed = 0;
+    long       Nlines = 0;
+    long       Nread = 0;
+    long       Npair_lines = 0;
+    long       first = 0;
+    long       Nahead = 0;
+    long       Nwaiting = 0;
+    long       Nrunning = 0;
+    long       in_flight = 0;
+    long       in_use = 0;
+    long       k;
+    int        at_end = 0;
+    FILE      *batchFile = fopen (batch_name, "rt");
+
+    if (batchFile == NULL) {
+        (*Error_Flag) = 1;
+        (*Error_Type) = "Could not open batch file";
+        return;
+    }
+
+    if (checkpoint_name (checkpoint, batch_name, plan) != 0) {
+        fclose (batchFile);
+        (*Error_Flag) = 1;
+        (*Error_Type) = "Batch file name too long for its checkpoint";
+        return;
+    }
+    if (plan-> resume) {
+        FILE * previous = fopen (checkpoint, "rt");
+        if ((previous != NULL) && (fscanf (previous, "%ld %ld %ld", &Nlines, &Npairs, &Nfailed) == 3)) {
+            printf ("Resuming %s after line %ld, %ld pairs processed, %ld failed.\n",
+                    batch_name, Nlines, Npairs, Nfailed);
+        } else {
+            Nlines = Npairs = Nfailed = 0;
+        }
+        if (previous != NULL) {
+            fclose (previous);
+        }
+    }
+
+    for (;;) {
+        int started = 0;
+        int retired = 0;
+
+        while (!at_end && (Nahead < BATCH_AHEAD) &&
+               ((Nahead == 0) || (in_flight < plan-> prefetch_bytes) ||
+                ((plan-> Njobs > 1) && (Nwaiting < 2 * plan-> Njobs)))) {
+            BATCH_LINE * next = &ahead [(first + Nahead) % BATCH_AHEAD];
+            if (fgets (next-> line, sizeof (next-> line), batchFile) == NULL) {
+                at_end = 1;
+                break;
+            }
+            next-> mine = 0;
+            if (is_pair_line (next-> line)) {
+                next-> mine = ((Npair_lines++ % plan-> Nshards) == plan-> shard);
+            }
+            if (Nread++ < Nlines) {
+                continue;
+            }
+            next-> bytes = ((plan-> prefetch_bytes > 0) && next-> mine) ? prefetch_line (next-> line) : 0;
+            next-> footprint = 0;
+            if ((plan-> mem_limit > 0) && next-> mine) {
+                next-> footprint = line_footprint (next-> line, ref_info, deg_info, plan-> mem_limit);
+            }
+            next-> job = 0;
+            next-> Error_Flag = 0;
+            next-> scored = 0;
+            next-> state = next-> mine ? LINE_WAITING : LINE_DONE;
+            Nwaiting += next-> mine;
+            in_flight += next-> bytes;
+            Nahead++;
+        }
+
+        /* lines are done with in order, whenever their pairs finish */
+        while ((Nahead > 0) && (ahead [first]. state == LINE_DONE)) {
+            if (ahead [first]. mine) {
+                Npairs += ahead [first]. scored;
+                Nfailed += (ahead [first]. Error_Flag != 0);
+                retired = 1;
+            }
+            first = (first + 1) % BATCH_AHEAD;
+            Nahead--;
+            Nlines++;
+        }
+        if (retired && ((flush_results (sink) != 0) || (write_checkpoint (checkpoint, Nlines, Npairs, Nfailed) != 0))) {
+            printf ("Could not record progress in %s!\n", checkpoint);
+        }
+        if (Nahead == 0) {
+            if (at_end) {
+                break;
+            }
+            continue;
+        }
+
+        for (k = 0; (k < Nahead) && (Nrunning < plan-> Njobs); k++) {
+            BATCH_LINE * entry = &ahead [(first + k) % BATCH_AHEAD];
+
+            if (entry-> state != LINE_WAITING) {
+                continue;
+            }
+            if ((plan-> mem_limit > 0) && (Nrunning > 0) && (in_use + entry-> footprint > plan-> mem_limit)) {
+                continue;
+            }
+            Nwaiting--;
+            in_flight -= entry-> bytes;
+            entry-> bytes = 0;
+            started = 1;
+
+            if (parse_pair_line (entry-> line, ref_info, deg_info, &err_info) < 2) {
+                printf ("Skipping incomplete batch line '%s'.\n", ref_info-> path_name);
+                entry-> Error_Flag = 1;
+                entry-> state = LINE_DONE;
+                continue;
+            }
+            entry-> scored = 1;
+
+            if (plan-> Njobs > 1) {
+                entry-> job = start_pair_job (ref_info, deg_info, &err_info, sink, triage, triage_threshold);
+                if (entry-> job != 0) {
+                    entry-> state = LINE_RUNNING;
+                    in_use += entry-> footprint;
+                    Nrunning++;
+                    continue;
+                }
+            }
+
+            (*Error_Flag) = 0;
+            (*Error_Type) = "Unknown error type.";
+            if (triage) {
+                triage_pair (ref_info, deg_info, &err_info, sink, triage_threshold, Error_Flag, Error_Type);
+            } else {
+                measure_pair (ref_info, deg_info, &err_info, sink, Error_Flag, Error_Type);
+            }
+            print_outcome (&err_info, *Error_Flag, *Error_Type);
+            entry-> Error_Flag = *Error_Flag;
+            entry-> state = LINE_DONE;
+            /* retire and checkpoint a pair scored here before the next */
+            break;
+        }
+
+        if (!started && (Nrunning > 0)) {
+            ERROR_INFO line_info;
+            long       job = wait_pair_job (&err_info, Error_Flag, Error_Type);
+
+            for (k = 0; k < Nahead; k++) {
+                BATCH_LINE * entry = &ahead [(first + k) % BATCH_AHEAD];
+
+                if ((entry-> state == LINE_RUNNING) && (entry-> job == job)) {
+                    parse_pair_line (entry-> line, ref_info, deg_info, &line_info);
+                    printf ("\n%s against %s:\n", ref_info-> path_name, deg_info-> path_name);
+                    print_outcome (&err_info, *Error_Flag, *Error_Type);
+                    entry-> Error_Flag = *Error_Flag;
+                    entry-> state = LINE_DONE;
+                    in_use -= entry-> footprint;
+                    Nrunning--;
+                    break;
+                }
+            }
+        }
+    }
+
+    fclose (batchFile);
+    remove (checkpoint);
+
+    printf ("\nBatch complete: %ld pairs processed, %ld failed.\n", Npairs, Nfailed);
+    (*Error_Flag) = 0;
+}
+
+int main (int argc, const char *argv []) {
+    int  arg;
+    int  names = 0;
+    long sample_rate = -1;
+    
+    SIGNAL_INFO ref_info;
+    SIGNAL_INFO deg_info;
+    ERROR_INFO err_info;
+    RESULT_SINK sink;
+    const char * batch_name = NULL;
+    const char * csv_name = NULL;
+    const char * json_name = NULL;
+    const char * profile_name = NULL;
+    const char * serve_name = NULL;
+    const char * cache_name = NULL;
+    FILE * serve_reply = NULL;
+    int    serve = 0;
+    int    triage = 0;
+    float  triage_threshold = -1;
+    int    all_channels = 0;
+    BATCH_PLAN plan;
+    double live_window = 0;
+    double live_hop = 1;
+
+    long Error_Flag = 0;
+    char * Error_Type = "Unknown error type.";
+
+    for (arg = 1; arg < argc; arg++) {
+        if (strcmp (argv [arg], "+serve") == 0) {
+            serve_reply = serve_redirect_stdout ();
+            if (serve_reply == NULL) {
+                fprintf (stderr, "Could not redirect standard output for serving.\n");
+                return 1;
+            }
+        }
+    }
+
+    if (Error_Flag == 0) {
+        printf("Perceptual Evaluation of Speech Quality (PESQ) - ITU-T Recommendation P.862.\n");
+        printf("Version 1.2 - 2 August 2002.\n");
+        printf("\n");
+        printf("PESQ Intellectual Property Rights Notice.\n");
+        printf("\n");
+        printf("DEFINITIONS:\n");
+        printf("For the purposes of this Intellectual Property Rights Notice the terms\n");
+        printf("'Perceptual Evaluation of Speech Quality Algorithm' and 'PESQ Algorithm'\n");
+        printf("refer to the objective speech quality measurement algorithm defined in ITU-T\n");
+        printf("Recommendation P.862; the term 'PESQ Software' refers to the C-code component\n");
+        printf("of P.862.\n");
+        printf("\n");
+        printf("NOTICE:\n");
+        printf("All copyright, trade marks, trade names, patents, know-how and all or any other\n");
+        printf("intellectual rights subsisting in or used in connection with including all\n");
+        printf("algorithms, documents and manuals relating to the PESQ Algorithm and or PESQ\n");
+        printf("Software are and remain the sole property in law, ownership, regulations,\n");
+        printf("treaties and patent rights of the Owners identified below. The user may not\n");
+        printf("dispute or question the ownership of the PESQ Algorithm and or PESQ Software.\n");
+        printf("\n");
+        printf("OWNERS ARE:\n");
+        printf("1.	British Telecommunications plc (BT), all rights assigned\n");
+        printf("      to Psytechnics Limited\n");
+        printf("2.	Royal KPN NV, all rights assigned to OPTICOM GmbH\n");
+        printf("\n");
+        printf("RESTRICTIONS:\n");
+        printf("The user cannot:\n");
+        printf("1.	alter, duplicate, modify, adapt, or translate in whole or in\n");
+        printf("      part any aspect of the PESQ Algorithm and or PESQ Software\n");
+        printf("2.	sell, hire, loan, distribute, dispose or put to any commercial\n");
+        printf("      use other than those permitted below in whole or in part any\n");
+        printf("      aspect of the PESQ Algorithm and or PESQ Software\n");
+        printf("\n");
+        printf("PERMITTED USE:\n");
+        printf("The user may:\n");
+        printf("1.	Use the PESQ Software to:\n");
+        printf("      i)   understand the PESQ Algorithm; or\n");
+        printf("      ii)  evaluate the ability of the PESQ Algorithm to perform its intended\n");
+        printf("           function of predicting the speech quality of a system; or\n");
+        printf("      iii) evaluate the computational complexity of the PESQ Algorithm,\n");
+        printf("           with the limitation that none of said evaluations or its\n");
+        printf("           results shall be used for external commercial use.\n");
+        printf("2.	Use the PESQ Software to test if an implementation of the PESQ\n");
+        printf("      Algorithm conforms to ITU-T Recommendation P.862.\n");
+        printf("3.	With the prior written permission of both Psytechnics Limited and\n");
+        printf("      OPTICOM GmbH, use the PESQ Software in accordance with the above\n");
+        printf("      Restrictions to perform work that meets all of the following criteria:\n");
+        printf("      i)    the work must contribute directly to the maintenance of an\n");
+        printf("            existing ITU recommendation or the development of a new ITU\n");
+        printf("            recommendation under an approved ITU Study Item; and\n");
+        printf("      ii)   the work and its results must be fully described in a\n");
+        printf("            written contribution to the ITU that is presented at a formal\n");
+        printf("            ITU meeting within one year of the start of the work; and\n");
+        printf("      iii)  neither the work nor its results shall be put to any\n");
+        printf("            commercial use other than making said contribution to the ITU.\n");
+        printf("            Said permission will be provided on a case-by-case basis.\n");
+        printf("\n");
+        printf("ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ ALGORITHM\n");
+        printf("WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED FROM EITHER\n");
+        printf("OPTICOM GMBH OR PSYTECHNICS LIMITED. \n");
+        printf("\n");
+        printf("EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM\n");
+        printf("IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE\n");
+        printf("AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.\n");
+        printf("\n");
+        printf("***********************************************************************\n");
+        printf("*  OPTICOM GmbH                    *  Psytechnics Limited             *\n");
+        printf("*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *\n");
+        printf("*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *\n");
+        printf("*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *\n");
+        printf("*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *\n");
+        printf("*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *\n");
+        printf("*  www.opticom.de                  *  www.psytechnics.com             *\n");
+        printf("***********************************************************************\n");
+        printf("\n");
+
+        for (arg = 1; arg < argc; arg++) {
+            if (strncmp (argv [arg], "+merge=", 7) == 0) {
+                const char * merge_inputs [256];
+                long         Nmerge = 0;
+                int          other;
+
+                for (other = 1; other < argc; other++) {
+                    if ((argv [other][0] != '+') && (Nmerge < 256)) {
+                        merge_inputs [Nmerge++] = argv [other];
+                    }
+                }
+                return (merge_results (argv [arg] + 7, merge_inputs, Nmerge) < 0) ? 1 : 0;
+            }
+        }
+
+        if (argc < 3){
+            usage ();
+            return 0;                                                                  
+        } else {
+
+            strcpy (ref_info.path_name, "");
+            ref_info.apply_swap = 0;
+            ref_info.input_rate = 0;
+            ref_info.range_start = 0;
+            ref_info.range_end = 0;
+            ref_info.channel = 0;
+            ref_info.Nchannels = 1;
+            strcpy (deg_info.path_name, "");
+            deg_info.apply_swap = 0;
+            deg_info.input_rate = 0;
+            deg_info.range_start = 0;
+            deg_info.range_end = 0;
+            deg_info.channel = 0;
+            deg_info.Nchannels = 1;
+            err_info. subj_mos = 0;
+            err_info. cond_nr = 0;
+            plan. prefetch_bytes = BATCH_PREFETCH_BYTES;
+            plan. shard = 0;
+            plan. Nshards = 1;
+            plan. resume = 0;
+            plan. Njobs = 1;
+            plan. mem_limit = 0;
+
+            for (arg = 1; arg < argc; arg++) {
+                if (argv [arg] [0] == '+') {
+                    if (strcmp (argv [arg], "+swap") == 0) {
+                        ref_info.apply_swap = 1;
+                        deg_info.apply_swap = 1;
+                    } else {
+                        if (strcmp (argv [arg], "+16000") == 0) {
+                            sample_rate = 16000L;
+                        } else {
+                            if (strcmp (argv [arg], "+8000") == 0) {
+                                sample_rate = 8000L;
+                            } else if (strncmp (argv [arg], "+inrate=", 8) == 0) {
+                                ref_info.input_rate = atol (argv [arg] + 8);
+                                deg_info.input_rate = ref_info.input_rate;
+                            } else if ((strncmp (argv [arg], "+ref-range=", 11) == 0) ||
+                                       (strncmp (argv [arg], "+deg-range=", 11) == 0)) {
+                                if (parse_range (argv [arg] + 11, (argv [arg][1] == 'r') ? &ref_info : &deg_info) != 0) {
+                                    usage ();
+                                    fprintf (stderr, "Invalid range '%s'.\n", argv [arg]);
+                                    return 1;
+                                }
+                            } else if (strcmp (argv [arg], "+channel=all") == 0) {
+                                all_channels = 1;
+                            } else if ((strncmp (argv [arg], "+channel=", 9) == 0) ||
+                                       (strncmp (argv [arg], "+ref-channel=", 13) == 0) ||
+                                       (strncmp (argv [arg], "+deg-channel=", 13) == 0)) {
+                                const char * value = strchr (argv [arg], '=') + 1;
+                                if (((argv [arg][1] != 'd') && (parse_channel (value, &ref_info) != 0)) ||
+                                    ((argv [arg][1] != 'r') && (parse_channel (value, &deg_info) != 0))) {
+                                    usage ();
+                                    fprintf (stderr, "Invalid channel '%s'.\n", argv [arg]);
+                                    return 1;
+                                }
+                            } else if (strcmp (argv [arg], "+serve") == 0) {
+                                serve = 1;
+                            } else if (strncmp (argv [arg], "+serve=", 7) == 0) {
+                                serve = 1;
+                                serve_name = argv [arg] + 7;
+                            } else if (strcmp (argv [arg], "+profile") == 0) {
+                                profile_name = PROFILE_RESULTS_FILE;
+                            } else if (strncmp (argv [arg], "+profile=", 9) == 0) {
+                                profile_name = argv [arg] + 9;
+                            } else if (strcmp (argv [arg], "+triage") == 0) {
+                                triage = 1;
+                            } else if (strncmp (argv [arg], "+triage=", 8) == 0) {
+                                triage = 1;
+                                triage_threshold = (float) atof (argv [arg] + 8);
+                            } else if (strncmp (argv [arg], "+live=", 6) == 0) {
+                                if ((sscanf (argv [arg] + 6, "%lf:%lf", &live_window, &live_hop) < 1) ||
+                                    (live_window <= 0) || (live_hop <= 0)) {
+                                    usage ();
+                                    fprintf (stderr, "Invalid live window '%s'.\n", argv [arg]);
+                                    return 1;
+                                }
+                            } else if (strncmp (argv [arg], "+trace=", 7) == 0) {
+#ifdef PESQ_TRACE
+                                if (trace_open (argv [arg] + 7) != 0) {
+                                    fprintf (stderr, "Could not open trace file %s.\n", argv [arg] + 7);
+                                    return 1;
+                                }
+#else
+                                fprintf (stderr, "Tracing is not built in; compile with -DPESQ_TRACE.\n");
+                                return 1;
+#endif
+                            } else if (strncmp (argv [arg], "+cache=", 7) == 0) {
+                                cache_name = argv [arg] + 7;
+                            } else if (strncmp (argv [arg], "+prefetch=", 10) == 0) {
+                                plan. prefetch_bytes = (long) (atof (argv [arg] + 10) * 1024 * 1024);
+                            } else if (strncmp (argv [arg], "+shard=", 7) == 0) {
+                                if ((sscanf (argv [arg] + 7, "%ld/%ld", &plan. shard, &plan. Nshards) != 2) ||
+                                    (plan. Nshards < 1) || (plan. shard < 1) || (plan. shard > plan. Nshards)) {
+                                    usage ();
+                                    fprintf (stderr, "Invalid shard '%s'.\n", argv [arg]);
+                                    return 1;
+                                }
+                                plan. shard--;
+                            } else if (strcmp (argv [arg], "+resume") == 0) {
+                                plan. resume = 1;
+                            } else if (strncmp (argv [arg], "+jobs=", 6) == 0) {
+                                plan. Njobs = atol (argv [arg] + 6);
+                                if ((plan. Njobs < 1) || (plan. Njobs > MAXJOBS)) {
+                                    usage ();
+                                    fprintf (stderr, "Invalid number of jobs '%s'.\n", argv [arg]);
+                                    return 1;
+                                }
+                            } else if (strncmp (argv [arg], "+memlimit=", 10) == 0) {
+                                plan. mem_limit = (long) (atof (argv [arg] + 10) * 1024 * 1024);
+                            } else if (strncmp (argv [arg], "+batch=", 7) == 0) {
+                                batch_name = argv [arg] + 7;
+                            } else if (strcmp (argv [arg], "+csv") == 0) {
+                                csv_name = CSV_RESULTS_FILE;
+                            } else if (strncmp (argv [arg], "+csv=", 5) == 0) {
+                                csv_name = argv [arg] + 5;
+                            } else if (strcmp (argv [arg], "+json") == 0) {
+                                json_name = JSON_RESULTS_FILE;
+                            } else if (strncmp (argv [arg], "+json=", 6) == 0) {
+                                json_name = argv [arg] + 6;
+                            } else {
+                                usage ();
+                                fprintf (stderr, "Invalid parameter '%s'.\n", argv [arg]);
+                                return 1;
+                            }
+                        }
+                    }
+                } else {
+                    switch (names) {
+                        case 0: 
+                            strcpy (ref_info.path_name, argv [arg]); 
+                            break;
+                        case 1: 
+                            strcpy (deg_info.path_name, argv [arg]); 
+                            break;
+                        case 2: 
+                            sscanf (argv [arg], "%f", &(err_info. subj_mos)); 
+                            break;
+                        case 3: 
+                            sscanf (argv [arg], "%d", &(err_info. cond_nr)); 
+                            break;
+                        default:
+                            usage ();
+                            fprintf (stderr, "Invalid parameter '%s'.\n", argv [arg]);
+                            return 1;
+                    }
+                    names++;
+                }
+            }
+
+            if (sample_rate == -1) {
+                printf ("PESQ Error. Must specify either +8000 or +16000 sample frequency option!\n");
+                exit (1);
+            }
+
+            if ((names >= 2) && (stream_fd (ref_info.path_name) >= 0) &&
+                (stream_fd (ref_info.path_name) == stream_fd (deg_info.path_name))) {
+                printf ("PESQ Error. Reference and degraded cannot both be read from the same stream!\n");
+                exit (1);
+            }
+            
+            open_results (&sink);
+            add_results_file (&sink, ITU_RESULTS_FILE, RESULTS_ITU);
+            add_results_file (&sink, SIMPLE_RESULTS_FILE, RESULTS_SIMPLE);
+            if (csv_name != NULL) {
+                add_results_file (&sink, csv_name, RESULTS_CSV);
+            }
+            if (json_name != NULL) {
+                add_results_file (&sink, json_name, RESULTS_JSON);
+            }
+            if (profile_name != NULL) {
+                add_results_file (&sink, profile_name, RESULTS_PROFILE);
+            }
+
+            select_rate (sample_rate, &Error_Flag, &Error_Type);
+
+            if ((cache_name != NULL) && (result_cache_open (cache_name) != 0)) {
+                printf ("PESQ Error. Could not open result cache %s!\n", cache_name);
+                exit (1);
+            }
+
+            if ((Error_Flag == 0) && serve) {
+                FFTRetainPlans (1);
+                retain_filter_factors (1);
+                src_cache_enable (1);
+                if (serve_name == NULL) {
+                    serve_stream (stdin, serve_reply, &sink, sample_rate, ref_info.apply_swap, ref_info.input_rate);
+                    fclose (serve_reply);
+                } else if (serve_socket (serve_name, &sink, sample_rate, ref_info.apply_swap, ref_info.input_rate) != 0) {
+                    Error_Flag = 1;
+                    Error_Type = "Could not serve on socket";
+                }
+                src_cache_enable (0);
+                retain_filter_factors (0);
+                FFTRetainPlans (0);
+                close_results (&sink);
+                if (Error_Flag != 0) {
+                    print_outcome (&err_info, Error_Flag, Error_Type);
+                }
+                return 0;
+            }
+
+            if (Error_Flag == 0) {
+                if ((batch_name == NULL) && all_channels) {
+                    measure_channels (&ref_info, &deg_info, &err_info, &sink, &Error_Flag, &Error_Type);
+                    close_results (&sink);
+                    if (Error_Flag != 0) {
+                        print_outcome (&err_info, Error_Flag, Error_Type);
+                    }
+                    return 0;
+                } else if ((batch_name == NULL) && (live_window > 0)) {
+                    live_measure (&ref_info, &deg_info, live_window, live_hop, &sink, &Error_Flag, &Error_Type);
+                    close_results (&sink);
+                    if (Error_Flag != 0) {
+                        print_outcome (&err_info, Error_Flag, Error_Type);
+                    }
+                    return 0;
+                } else if ((batch_name == NULL) && triage) {
+                    triage_pair (&ref_info, &deg_info, &err_info, &sink, triage_threshold, &Error_Flag, &Error_Type);
+                } else if (batch_name == NULL) {
+                    measure_pair (&ref_info, &deg_info, &err_info, &sink, &Error_Flag, &Error_Type);
+                } else {
+                    measure_batch (batch_name, &ref_info, &deg_info, &sink, triage, triage_threshold,
+                                   &plan, &Error_Flag, &Error_Type);
+                    close_results (&sink);
+                    if (Error_Flag != 0) {
+                        print_outcome (&err_info, Error_Flag, Error_Type);
+                    }
+                    return 0;
+                }
+            }
+
+            close_results (&sink);
+        }
+    }
+
+    print_outcome (&err_info, Error_Flag, Error_Type);
+    return 0;
+}
+
+/* END OF FILE */
@@ -0,0 +1,891 @@
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
+the terms Perceptual Evaluation of Speech Quality Algorithm?
+and PESQ Algorithm?refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term PESQ Software?refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+#include "pesq.h"
+#include "dsp.h"
+
+double align_filter_dB [26] [2] = {{0.,-500},
+                                 {50., -500},
+                                 {100., -500},
+                                 {125., -500},
+                                 {160., -500},
+                                 {200., -500},
+                                 {250., -500},
+                                 {300., -500},
+                                 {350.,  0},
+                                 {400.,  0},
+                                 {500.,  0},
+                                 {600.,  0},
+                                 {630.,  0},
+                                 {800.,  0},
+                                 {1000., 0},
+                                 {1250., 0},
+                                 {1600., 0},
+                                 {2000., 0},
+                                 {2500., 0},
+                                 {3000., 0},
+                                 {3250., 0},
+                                 {3500., -500},
+                                 {4000., -500},
+                                 {5000., -500},
+                                 {6300., -500},
+                                 {8000., -500}}; 
+
+
+double standard_IRS_filter_dB [26] [2] = {{  0., -200},
+                                         { 50., -40}, 
+                                         {100., -20},
+                                         {125., -12},
+                                         {160.,  -6},
+                                         {200.,   0},
+                                         {250.,   4},
+                                         {300.,   6},
+                                         {350.,   8},
+                                         {400.,  10},
+                                         {500.,  11},
+                                         {600.,  12},
+                                         {700.,  12},
+                                         {800.,  12},
+                                         {1000., 12},
+                                         {1300., 12},
+                                         {1600., 12},
+                                         {2000., 12},
+                                         {2500., 12},
+                                         {3000., 12},
+                                         {3250., 12},
+                                         {3500., 4},
+                                         {4000., -200},
+                                         {5000., -200},
+                                         {6300., -200},
+                                         {8000., -200}}; 
+
+
+#define TARGET_AVG_POWER    1E7
+
+/* The gain that brings the power of info above 300 Hz to TARGET_AVG_POWER. */
+
+float power_level_gain (SIGNAL_INFO *info, long maxNsamples) 
+{
+    long   n = info-> Nsamples;
+    long   i;
+    float *align_filtered = (float *) safe_malloc ((n + DATAPADDING_MSECS  * (Fs / 1000)) * sizeof (float));    
+    float  power_above_300Hz;
+
+    for (i = 0; i < n + DATAPADDING_MSECS  * (Fs / 1000); i++) {
+        align_filtered [i] = info-> data [i];
+    }
+    apply_filter (align_filtered, info-> Nsamples, 26, align_filter_dB);
+
+    power_above_300Hz = (float) pow_of (align_filtered, 
+                                        SEARCHBUFFER * Downsample, 
+                                        n - SEARCHBUFFER * Downsample + DATAPADDING_MSECS  * (Fs / 1000),
+                                        maxNsamples - 2 * SEARCHBUFFER * Downsample + DATAPADDING_MSECS  * (Fs / 1000));
+
+    safe_free (align_filtered);
+
+    return (float) sqrt (TARGET_AVG_POWER / power_above_300Hz); 
+}
+
+void fix_power_level (SIGNAL_INFO *info, char *name, long maxNsamples) 
+{
+    long   n = info-> Nsamples;
+    long   i;
+    float  global_scale = power_level_gain (info, maxNsamples);
+
+    for (i = 0; i < n; i++) {
+        info-> data [i] *= global_scale;    
+    }
+}
+
+       
+static void load_pair (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    long * Error_Flag, char ** Error_Type)
+{
+    ref_info-> data = NULL;
+    ref_info-> VAD = NULL;
+    ref_info-> logVAD = NULL;
+    
+    deg_info-> data = NULL;
+    deg_info-> VAD = NULL;
+    deg_info-> logVAD = NULL;
+        
+    if ((*Error_Flag) == 0)
+    {
+        printf ("Reading reference file %s...", ref_info-> path_name);
+
+       profile_start (PROFILE_LOAD);
+       load_src (Error_Flag, Error_Type, ref_info);
+       profile_stop (PROFILE_LOAD);
+       if ((*Error_Flag) == 0)
+           printf ("done.\n");
+    }
+    if ((*Error_Flag) == 0)
+    {
+        printf ("Reading degraded file %s...", deg_info-> path_name);
+
+       profile_start (PROFILE_LOAD);
+       load_src (Error_Flag, Error_Type, deg_info);
+       profile_stop (PROFILE_LOAD);
+       if ((*Error_Flag) == 0)
+           printf ("done.\n");
+    }
+}
+
+static void process_pair (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type, int triage);
+
+/* Loads and scores a pair, unless the result cache already holds the
+   result for the samples loaded. */
+
+static void measure_cached (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type, int triage)
+{
+    CACHE_WORD key [2];
+    int        cached = 0;
+
+    load_pair (ref_info, deg_info, Error_Flag, Error_Type);
+
+    if (((*Error_Flag) == 0) && result_cache_enabled ()) {
+        result_cache_key (ref_info, deg_info, triage, key);
+        cached = result_cache_find (key, err_info);
+    }
+
+    if (cached) {
+        printf ("Result found in cache.\n");
+        safe_free (ref_info-> data);
+        safe_free (ref_info-> VAD);
+        safe_free (ref_info-> logVAD);
+        safe_free (deg_info-> data);
+        safe_free (deg_info-> VAD);
+        safe_free (deg_info-> logVAD);
+        return;
+    }
+
+    process_pair (ref_info, deg_info, err_info, Error_Flag, Error_Type, triage);
+
+    if (((*Error_Flag) == 0) && result_cache_enabled ()) {
+        result_cache_store (key, err_info);
+    }
+}
+
+void pesq_measure (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type)
+{
+    measure_cached (ref_info, deg_info, err_info, Error_Flag, Error_Type, FALSE);
+}
+
+void pesq_triage (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type)
+{
+    measure_cached (ref_info, deg_info, err_info, Error_Flag, Error_Type, TRUE);
+}
+
+/* Finds the utterances of a levelled and IRS filtered pair and their
+   delays. The alignment filters copies; the signals are left as they
+   were for the model. */
+
+void align_pair (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, float * ftmp, int triage)
+{
+    float * model_ref; 
+    float * model_deg; 
+    long    i;
+
+    model_ref = (float *) safe_malloc ((ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000)) * sizeof (float));
+    model_deg = (float *) safe_malloc ((deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000)) * sizeof (float));
+
+    for (i = 0; i < ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
+        model_ref [i] = ref_info-> data [i];
+    }
+
+    for (i = 0; i < deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
+        model_deg [i] = deg_info-> data [i];
+    }
+
+    profile_start (PROFILE_INPUT_FILTER);
+    input_filter( ref_info, deg_info, ftmp );
+    profile_stop (PROFILE_INPUT_FILTER);
+
+    profile_start (PROFILE_CALC_VAD);
+    calc_VAD (ref_info);
+    calc_VAD (deg_info);
+    profile_stop (PROFILE_CALC_VAD);
+    
+    profile_start (PROFILE_CRUDE_ALIGN);
+    crude_align (ref_info, deg_info, err_info, WHOLE_SIGNAL, ftmp);
+    profile_stop (PROFILE_CRUDE_ALIGN);
+    TRACE (trace_values (TRACE_CRUDE_DELAY, 0, 2, (double) err_info-> Crude_DelayEst,
+                         (double) err_info-> Crude_DelayConf));
+
+    if (triage) {
+        err_info-> Nutterances = 1;
+        err_info-> Utt_Start [0] = SEARCHBUFFER;
+        err_info-> Utt_End [0] = ref_info-> Nsamples / Downsample - SEARCHBUFFER;
+        err_info-> Utt_Delay [0] = err_info-> Crude_DelayEst;
+        err_info-> Utt_DelayEst [0] = err_info-> Crude_DelayEst;
+        err_info-> Utt_DelayConf [0] = err_info-> Crude_DelayConf;
+    } else {
+        profile_start (PROFILE_UTTERANCE_LOCATE);
+        utterance_locate (ref_info, deg_info, err_info, ftmp);
+        profile_stop (PROFILE_UTTERANCE_LOCATE);
+    }
+    Profile. Nutterances = err_info-> Nutterances;
+    TRACE (trace_utterances (err_info));
+
+    for (i = 0; i < ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
+        ref_info-> data [i] = model_ref [i];
+    }
+
+    for (i = 0; i < deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
+        deg_info-> data [i] = model_deg [i];
+    }
+
+    safe_free (model_ref);
+    safe_free (model_deg); 
+}
+
+static void process_pair (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type, int triage)
+{
+    float * ftmp = NULL;
+
+    if (((ref_info-> Nsamples - 2 * SEARCHBUFFER * Downsample < Fs / 4) ||
+         (deg_info-> Nsamples - 2 * SEARCHBUFFER * Downsample < Fs / 4)) &&
+        ((*Error_Flag) == 0))
+    {
+        (*Error_Flag) = 2;
+        (*Error_Type) = "Reference or Degraded below 1/4 second - processing stopped ";
+    }
+
+    if ((*Error_Flag) == 0)
+    {
+        alloc_other (ref_info, deg_info, Error_Flag, Error_Type, &ftmp);
+    }
+
+    if ((*Error_Flag) == 0)
+    {   
+        int     maxNsamples = max (ref_info-> Nsamples, deg_info-> Nsamples);
+
+        TRACE (trace_values (TRACE_PAIR, 0, 4, (double) Fs, (double) ref_info-> Nsamples,
+                             (double) deg_info-> Nsamples, (double) triage));
+
+        printf (" Level normalization...\n");            
+        profile_start (PROFILE_FIX_POWER_LEVEL);
+        fix_power_level (ref_info, "reference", maxNsamples);
+        fix_power_level (deg_info, "degraded", maxNsamples);
+        profile_stop (PROFILE_FIX_POWER_LEVEL);
+
+        printf (" IRS filtering...\n"); 
+        profile_start (PROFILE_APPLY_FILTER);
+        apply_filter (ref_info-> data, ref_info-> Nsamples, 26, standard_IRS_filter_dB);
+        apply_filter (deg_info-> data, deg_info-> Nsamples, 26, standard_IRS_filter_dB);
+        profile_stop (PROFILE_APPLY_FILTER);
+
+        printf (" Variable delay compensation...\n");            
+        align_pair (ref_info, deg_info, err_info, ftmp, triage);
+    
+        if ((*Error_Flag) == 0) {
+            if (ref_info-> Nsamples < deg_info-> Nsamples) {
+                float *new_ref = (float *) safe_malloc((deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000)) * sizeof(float));
+                long  i;
+                for (i = 0; i < ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
+                    new_ref [i] = ref_info-> data [i];
+                }
+                for (i = ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); 
+                     i < deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
+                    new_ref [i] = 0.0f;
+                }
+                safe_free (ref_info-> data);
+                ref_info-> data = new_ref;
+                new_ref = NULL;
+            } else {
+                if (ref_info-> Nsamples > deg_info-> Nsamples) {
+                    float *new_deg = (float *) safe_malloc((ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000)) * sizeof(float));
+                    long  i;
+                    for (i = 0; i < deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
+                        new_deg [i] = deg_info-> data [i];
+                    }
+                    for (i = deg_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); 
+                         i < ref_info-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000); i++) {
+                        new_deg [i] = 0.0f;
+                    }
+                    safe_free (deg_info-> data);
+                    deg_info-> data = new_deg;
+                    new_deg = NULL;
+                }
+            }
+        }        
+
+        printf (" Acoustic model processing...\n");    
+        pesq_psychoacoustic_model (ref_info, deg_info, err_info, ftmp, triage);
+        TRACE (trace_flush ());
+    
+        safe_free (ref_info-> data);
+        safe_free (ref_info-> VAD);
+        safe_free (ref_info-> logVAD);
+        safe_free (deg_info-> data);
+        safe_free (deg_info-> VAD);
+        safe_free (deg_info-> logVAD);
+        safe_free (ftmp);
+    } else {
+        if (ref_info-> data != NULL) safe_free (ref_info-> data);
+        if (ref_info-> VAD != NULL) safe_free (ref_info-> VAD);
+        if (ref_info-> logVAD != NULL) safe_free (ref_info-> logVAD);
+        if (deg_info-> data != NULL) safe_free (deg_info-> data);
+        if (deg_info-> VAD != NULL) safe_free (deg_info-> VAD);
+        if (deg_info-> logVAD != NULL) safe_free (deg_info-> logVAD);
+        if (ftmp != NULL) safe_free (ftmp);
+    }
+
+    return;
+}
+
+/* Scores a pair whose data, VAD and logVAD have been set up as load_src
+   does; the buffers are released whether or not processing succeeds. */
+
+void pesq_process (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type)
+{
+    process_pair (ref_info, deg_info, err_info, Error_Flag, Error_Type, FALSE);
+}
+
+/* As pesq_process, but with the reduced triage pipeline: the whole signal
+   crude alignment stands in for utterance_locate, the model analyses
+   decimated frames and nothing is realigned. err_info-> pesq_mos_error
+   holds the error bar of the estimate. */
+
+void pesq_triage_process (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type)
+{
+    process_pair (ref_info, deg_info, err_info, Error_Flag, Error_Type, TRUE);
+}
+
+/* The name of the file without its directory, cut to fit file_name. */
+
+static void set_file_name (SIGNAL_INFO * info)
+{
+    const char * base = info-> path_name;
+
+    if (strrchr (base, '\\') != NULL) {
+        base = 1 + strrchr (base, '\\');
+    }
+    if (strrchr (base, '/') != NULL) {
+        base = 1 + strrchr (base, '/');
+    }
+    snprintf (info-> file_name, sizeof (info-> file_name), "%.*s", (int) sizeof (info-> file_name) - 1, base);
+}
+
+void measure_pair (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, RESULT_SINK * sink, long * Error_Flag, char ** Error_Type)
+{
+    double start_time = wall_clock ();
+
+    profile_reset ();
+
+    set_file_name (ref_info);
+    set_file_name (deg_info);
+
+    pesq_measure (ref_info, deg_info, err_info, Error_Flag, Error_Type);
+
+    if ((*Error_Flag) == 0) {
+        write_results (sink, ref_info, deg_info, err_info, wall_clock () - start_time);
+    }
+}
+
+/* Triage scoring of a pair. A non-negative threshold escalates to the full
+   pesq_measure when the threshold lies within the error bar of the estimate,
+   so that only the full score decides on which side of it the pair falls. */
+
+void triage_pair (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, RESULT_SINK * sink, float threshold,
+    long * Error_Flag, char ** Error_Type)
+{
+    double start_time = wall_clock ();
+
+    profile_reset ();
+
+    set_file_name (ref_info);
+    set_file_name (deg_info);
+
+    pesq_triage (ref_info, deg_info, err_info, Error_Flag, Error_Type);
+
+    if (((*Error_Flag) == 0) && (threshold >= 0) &&
+        (fabs (err_info-> pesq_mos - threshold) <= err_info-> pesq_mos_error)) {
+        printf ("Estimate %.3f +/- %.3f is near %.3f, escalating to full scoring.\n",
+                err_info-> pesq_mos, err_info-> pesq_mos_error, threshold);
+        pesq_measure (ref_info, deg_info, err_info, Error_Flag, Error_Type);
+    }
+
+    if ((*Error_Flag) == 0) {
+        write_results (sink, ref_info, deg_info, err_info, wall_clock () - start_time);
+    }
+}
+
+/* What scoring one channel pair produced, passed back whole from the
+   process that scored it along with the profile of the run. */
+
+typedef struct {
+    ERROR_INFO    err_info;
+    long          Error_Flag;
+    char          Error_Text [128];
+    double        elapsed;
+    PROFILE_INFO  profile;
+    unsigned long fft_calls [FFTSIZES];
+    long          heap_peak;
+} CHANNEL_OUTCOME;
+
+static void score_channel (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, CHANNEL_OUTCOME * outcome)
+{
+    char  * Error_Type = "Unknown error type.";
+    double  start_time = wall_clock ();
+
+    profile_reset ();
+    reset_counters ();
+
+    outcome-> err_info = *err_info;
+    outcome-> Error_Flag = 0;
+    pesq_process (ref_info, deg_info, &outcome-> err_info, &outcome-> Error_Flag, &Error_Type);
+
+    outcome-> elapsed = wall_clock () - start_time;
+    strcpy (outcome-> Error_Text, "");
+    strncat (outcome-> Error_Text, Error_Type, sizeof (outcome-> Error_Text) - 1);
+    outcome-> profile = Profile;
+    memcpy (outcome-> fft_calls, FFTCalls, sizeof (FFTCalls));
+    outcome-> heap_peak = heap_peak;
+}
+
+/* Gives a mono source one copy per channel of the other side of the pair. */
+
+static int copy_channel (SIGNAL_INFO * to, SIGNAL_INFO * from)
+{
+    long length = from-> Nsamples + DATAPADDING_MSECS  * (Fs / 1000);
+
+    *to = *from;
+    to-> data = (float *) safe_malloc (length * sizeof (float));
+    to-> VAD = (float *) safe_malloc (from-> Nsamples / Downsample * sizeof (float));
+    to-> logVAD = (float *) safe_malloc (from-> Nsamples / Downsample * sizeof (float));
+    if ((to-> data == NULL) || (to-> VAD == NULL) || (to-> logVAD == NULL)) {
+        return -1;
+    }
+    memcpy (to-> data, from-> data, length * sizeof (float));
+    return 0;
+}
+
+/* Scores a pair in this process; pesq_process releases its buffers. */
+
+static void score_channel_here (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, CHANNEL_OUTCOME * outcome)
+{
+    score_channel (ref_info, deg_info, err_info, outcome);
+    ref_info-> data = NULL;
+    ref_info-> VAD = NULL;
+    ref_info-> logVAD = NULL;
+    deg_info-> data = NULL;
+    deg_info-> VAD = NULL;
+    deg_info-> logVAD = NULL;
+}
+
+/* Scores channel k of ref_info against channel k of deg_info for every
+   channel, or a mono side against each channel of the other. Each file
+   is read once and the channel pairs are scored concurrently, one process
+   per pair, with results written in channel order. */
+
+void measure_channels (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, RESULT_SINK * sink, long * Error_Flag, char ** Error_Type)
+{
+    static char     channel_error [160];
+    SIGNAL_INFO     ref_channel [MAXCHANNELS];
+    SIGNAL_INFO     deg_channel [MAXCHANNELS];
+    CHANNEL_OUTCOME outcome [MAXCHANNELS];
+    long            Nref = 0;
+    long            Ndeg = 0;
+    long            Npairs = 0;
+    long            k;
+#ifndef _WIN32
+    int             result_fd [MAXCHANNELS];
+    pid_t           child [MAXCHANNELS];
+#endif
+
+    profile_reset ();
+
+    set_file_name (ref_info);
+    set_file_name (deg_info);
+
+    printf ("Reading reference file %s...", ref_info-> path_name);
+    Nref = load_src_channels (Error_Flag, Error_Type, ref_info, ref_channel, MAXCHANNELS);
+    if ((*Error_Flag) == 0) {
+        printf ("done, %ld channel(s).\n", Nref);
+        printf ("Reading degraded file %s...", deg_info-> path_name);
+        Ndeg = load_src_channels (Error_Flag, Error_Type, deg_info, deg_channel, MAXCHANNELS);
+    }
+    if ((*Error_Flag) == 0) {
+        printf ("done, %ld channel(s).\n", Ndeg);
+        Npairs = max (Nref, Ndeg);
+        if ((Nref != Ndeg) && (Nref != 1) && (Ndeg != 1)) {
+            *Error_Flag = 1;
+            *Error_Type = "Reference and degraded channel counts differ";
+        }
+    }
+    for (k = 1; ((*Error_Flag) == 0) && (k < Npairs); k++) {
+        int failed = 0;
+        if (Nref == 1) {
+            failed = copy_channel (&ref_channel [k], &ref_channel [0]);
+            Nref = k + 1;
+        } else if (Ndeg == 1) {
+            failed = copy_channel (&deg_channel [k], &deg_channel [0]);
+            Ndeg = k + 1;
+        }
+        if (failed) {
+            *Error_Flag = 1;
+            *Error_Type = "Failed to allocate memory for channel copy";
+        }
+    }
+
+    if ((*Error_Flag) == 0) {
+#ifdef _WIN32
+        for (k = 0; k < Npairs; k++) {
+            score_channel_here (&ref_channel [k], &deg_channel [k], err_info, &outcome [k]);
+        }
+#else
+        fflush (stdout);
+        for (k = 0; k < Npairs; k++) {
+            int pipe_fd [2];
+
+            child [k] = -1;
+            result_fd [k] = -1;
+            if (pipe (pipe_fd) != 0) {
+                continue;
+            }
+            child [k] = fork ();
+            if (child [k] == 0) {
+                /* the child's copy of the signals is its own; its
+                   progress output would only interleave with the others */
+                close (pipe_fd [0]);
+                freopen ("/dev/null", "w", stdout);
+                score_channel (&ref_channel [k], &deg_channel [k], err_info, &outcome [k]);
+                if (write (pipe_fd [1], &outcome [k], sizeof (CHANNEL_OUTCOME)) != sizeof (CHANNEL_OUTCOME)) {
+                    _exit (1);
+                }
+                _exit (0);
+            }
+            close (pipe_fd [1]);
+            if (child [k] < 0) {
+                close (pipe_fd [0]);
+                continue;
+            }
+            result_fd [k] = pipe_fd [0];
+        }
+
+        for (k = 0; k < Npairs; k++) {
+            long got = 0;
+
+            if (result_fd [k] >= 0) {
+                while (got < (long) sizeof (CHANNEL_OUTCOME)) {
+                    long n = (long) read (result_fd [k], (char *) &outcome [k] + got,
+                                          sizeof (CHANNEL_OUTCOME) - got);
+                    if (n <= 0) {
+                        break;
+                    }
+                    got += n;
+                }
+                close (result_fd [k]);
+            }
+            if (child [k] > 0) {
+                waitpid (child [k], NULL, 0);
+            }
+            if (got < (long) sizeof (CHANNEL_OUTCOME)) {
+                /* no process could be started for the pair, or it died */
+                score_channel_here (&ref_channel [k], &deg_channel [k], err_info, &outcome [k]);
+            }
+        }
+#endif
+
+        for (k = 0; k < Npairs; k++) {
+            Profile = outcome [k]. profile;
+            memcpy (FFTCalls, outcome [k]. fft_calls, sizeof (FFTCalls));
+            heap_peak = outcome [k]. heap_peak;
+
+            if (outcome [k]. Error_Flag == 0) {
+                printf ("Channel %ld : PESQ_MOS = %.3f\n", k + 1, (double) outcome [k]. err_info. pesq_mos);
+                write_results (sink, &ref_channel [k], &deg_channel [k], &outcome [k]. err_info, outcome [k]. elapsed);
+                *err_info = outcome [k]. err_info;
+            } else {
+                printf ("Channel %ld : error %ld (%s)\n", k + 1, outcome [k]. Error_Flag, outcome [k]. Error_Text);
+                if ((*Error_Flag) == 0) {
+                    strcpy (channel_error, outcome [k]. Error_Text);
+                    *Error_Flag = outcome [k]. Error_Flag;
+                    *Error_Type = channel_error;
+                }
+            }
+        }
+    }
+
+    /* pairs scored in child processes, or not at all, still hold their buffers */
+    for (k = 0; k < max (Nref, Ndeg); k++) {
+        if (k < Nref) {
+            safe_free (ref_channel [k]. data);
+            safe_free (ref_channel [k]. VAD);
+            safe_free (ref_channel [k]. logVAD);
+        }
+        if (k < Ndeg) {
+            safe_free (deg_channel [k]. data);
+            safe_free (deg_channel [k]. VAD);
+            safe_free (deg_channel [k]. logVAD);
+        }
+    }
+}
+
+/* Peak heap of scoring a pair, as profiled: the signals, their filtered
+   and aligned copies and the per-frame arrays come to about 48 bytes per
+   sample of the longer source, the shorter being padded to its length,
+   on top of a part that grows with the sample rate. Returns -1 when a
+   source cannot be sized from its header. */
+
+#define FOOTPRINT_PER_SAMPLE    48
+#define FOOTPRINT_PER_HZ        300
+
+long pair_footprint (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info)
+{
+    long Nref = src_length (ref_info);
+    long Ndeg = src_length (deg_info);
+
+    if ((Nref < 0) || (Ndeg < 0)) {
+        return -1;
+    }
+    return FOOTPRINT_PER_SAMPLE * max (Nref, Ndeg) + FOOTPRINT_PER_HZ * Fs;
+}
+
+/* Batch pairs scored in processes of their own, several at a time. A
+   worker writes its results itself, the result files being locked for
+   every flush, and passes back only what the batch reports on. */
+
+typedef struct {
+    ERROR_INFO    err_info;
+    long          Error_Flag;
+    char          Error_Text [128];
+} PAIR_OUTCOME;
+
+#ifndef _WIN32
+static pid_t Job_Process [MAXJOBS];
+static int   Job_Result [MAXJOBS];
+static long  Njobs = 0;
+#endif
+
+/* Starts scoring a pair in a new process and returns its job number, or
+   0 when no process could be started and the pair is the caller's. */
+
+long start_pair_job (SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+    ERROR_INFO * err_info, RESULT_SINK * sink, int triage, float threshold)
+{
+#ifdef _WIN32
+    return 0;
+#else
+    int   pipe_fd [2];
+    pid_t child;
+
+    if ((Njobs >= MAXJOBS) || (pipe (pipe_fd) != 0)) {
+        return 0;
+    }
+    /* nothing buffered may be written twice, once by each process */
+    flush_results (sink);
+    fflush (NULL);
+
+    child = fork ();
+    if (child == 0) {
+        PAIR_OUTCOME outcome;
+        char       * Error_Type = "Unknown error type.";
+
+        close (pipe_fd [0]);
+        freopen ("/dev/null", "w", stdout);
+        result_cache_share ();
+
+        outcome. err_info = *err_info;
+        outcome. Error_Flag = 0;
+        if (triage) {
+            triage_pair (ref_info, deg_info, &outcome. err_info, sink, threshold, &outcome. Error_Flag, &Error_Type);
+        } else {
+            measure_pair (ref_info, deg_info, &outcome. err_info, sink, &outcome. Error_Flag, &Error_Type);
+        }
+        if ((flush_results (sink) != 0) && (outcome. Error_Flag == 0)) {
+            outcome. Error_Flag = 1;
+            Error_Type = "Could not write results";
+        }
+        strcpy (outcome. Error_Text, "");
+        strncat (outcome. Error_Text, Error_Type, sizeof (outcome. Error_Text) - 1);
+        if (write (pipe_fd [1], &outcome, sizeof (outcome)) != sizeof (outcome)) {
+            _exit (1);
+        }
+        _exit (0);
+    }
+    close (pipe_fd [1]);
+    if (child < 0) {
+        close (pipe_fd [0]);
+        return 0;
+    }
+    Job_Process [Njobs] = child;
+    Job_Result [Njobs] = pipe_fd [0];
+    Njobs++;
+    return (long) child;
+#endif
+}
+
+/* Waits for whichever job finishes first and returns its number with its
+   outcome, or 0 when none is running. A worker that died, for instance
+   killed for want of memory, counts as a failed pair. */
+
+long wait_pair_job (ERROR_INFO * err_info, long * Error_Flag, char ** Error_Type)
+{
+#ifdef _WIN32
+    return 0;
+#else
+    static char  job_error [128];
+    PAIR_OUTCOME outcome;
+    pid_t        child;
+    long         got = 0;
+    long         k;
+
+    if (Njobs == 0) {
+        return 0;
+    }
+    child = waitpid (-1, NULL, 0);
+    for (k = 0; (k < Njobs) && (Job_Process [k] != child); k++) {
+    }
+    if (k == Njobs) {
+        k = 0;
+        child = Job_Process [0];
+        waitpid (child, NULL, 0);
+    }
+
+    while (got < (long) sizeof (outcome)) {
+        long n = (long) read (Job_Result [k], (char *) &outcome + got, sizeof (outcome) - got);
+        if (n <= 0) {
+            break;
+        }
+        got += n;
+    }
+    close (Job_Result [k]);
+    Njobs--;
+    Job_Process [k] = Job_Process [Njobs];
+    Job_Result [k] = Job_Result [Njobs];
+
+    if (got < (long) sizeof (outcome)) {
+        *Error_Flag = 1;
+        *Error_Type = "Worker process scoring the pair failed";
+    } else {
+        *err_info = outcome. err_info;
+        *Error_Flag = outcome. Error_Flag;
+        strcpy (job_error, outcome. Error_Text);
+        *Error_Type = job_error;
+    }
+    result_cache_sync ();
+    return (long) child;
+#endif
+}
+
+/* END OF FILE */
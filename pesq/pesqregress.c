@@ -0,0 +1,626 @@
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
+the terms Perceptual Evaluation of Speech Quality Algorithm?
+and PESQ Algorithm?refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term PESQ Software?refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "pesq.h"
+#include "dsp.h"
+
+/* Regression check: scores the fixed synthetic corpus of pesqgen.c and
+   compares each pair against stored golden values. A failing pair is
+   reported with the first stage whose output moved, in processing
+   order: crude delay, utterance delays, front end spectra, frame
+   disturbances, bad-interval realignment and finally the MOS. The live
+   engine is checked to give a window the same MOS whatever the hop it
+   was reached by. Build from every source file except pesqmain.c. */
+
+#define REGRESS_GOLDEN_FILE "pesqregress.txt"
+#define REGRESS_LINE        4096
+
+typedef struct {
+    char   name [32];
+    long   sample_rate;
+    double seconds;
+    double pesq_mos;
+    long   Crude_DelayEst;
+    double checksum [PROFILE_CHECKSUMS];
+    long   Nutterances;
+    long   Utt_Delay [MAXNUTTERANCES];
+} REGRESS_CASE;
+
+static long   Regress_Rates [] = {8000L, 16000L};
+static double Regress_Seconds [] = {4, 10};
+
+#define REGRESS_LIVE_SECONDS 11
+#define REGRESS_LIVE_WINDOW  4
+
+/* live hops are whole half frames of 16 ms, and both hops end windows at
+   each of the ends */
+static double Regress_Live_Hops [] = {1.024, 3.072};
+static double Regress_Live_Ends [] = {7.072, 10.144};
+
+/* windows scored live must agree this closely with pesq_process on the
+   same window */
+#define REGRESS_LIVE_RANGED_HOP       1
+#define REGRESS_LIVE_RANGED_TOLERANCE 0.02
+
+static char * Checksum_Stage [PROFILE_CHECKSUMS] = {
+    "front end (pitch_pow_dens_ref)",
+    "front end (pitch_pow_dens_deg)",
+    "frame_disturbance",
+    "frame_disturbance_asym_add",
+    "bad-interval realignment (frame_disturbance)",
+    "bad-interval realignment (frame_disturbance_asym_add)"
+};
+
+void usage (void) {
+    printf ("Usage:\n");
+    printf (" PESQREGRESS [options] [golden]\n");
+    printf (" Score the synthetic regression corpus and compare with the golden file,\n");
+    printf (" %s by default.\n", REGRESS_GOLDEN_FILE);
+    printf ("\n");
+    printf ("Options: +update +tolerance=x +checksum-tolerance=x +delay-tolerance=n\n");
+    printf (" Update - rewrite the golden file from this build instead of comparing.\n");
+    printf (" Tolerance - largest accepted PESQ_MOS difference, 0.001 by default.\n");
+    printf (" Checksum tolerance - largest relative change of a stage checksum, 1e-6 by default.\n");
+    printf (" Delay tolerance - largest accepted delay difference in samples, 0 by default.\n");
+}
+
+static int regress_score (REGRESS_CASE * c, long * Error_Flag, char ** Error_Type)
+{
+    SIGNAL_INFO ref_info;
+    SIGNAL_INFO deg_info;
+    ERROR_INFO  err_info;
+    long        Nref, Ndeg;
+    float      *ref, *deg;
+    int         kind;
+    long        i;
+
+    for (kind = 0; kind < SYNTH_KINDS; kind++) {
+        if (strcmp (c-> name, Synth_Kind_Name [kind]) == 0) {
+            break;
+        }
+    }
+    if (kind == SYNTH_KINDS) {
+        (*Error_Flag) = 1;
+        (*Error_Type) = "Unknown corpus signal";
+        return -1;
+    }
+
+    select_rate (c-> sample_rate, Error_Flag, Error_Type);
+    if ((*Error_Flag) != 0) {
+        return -1;
+    }
+    synth_pair (kind, c-> sample_rate, c-> seconds, (unsigned long) (kind * 1000 + c-> seconds * 10),
+                &ref, &deg, &Nref, &Ndeg);
+
+    sprintf (ref_info. path_name, "synth:%s:%.0f:ref", c-> name, c-> seconds);
+    sprintf (deg_info. path_name, "synth:%s:%.0f:deg", c-> name, c-> seconds);
+    err_info. subj_mos = 0;
+    err_info. cond_nr = 0;
+
+    profile_reset ();
+    load_samples (Error_Flag, Error_Type, &ref_info, ref, Nref);
+    if ((*Error_Flag) == 0) {
+        load_samples (Error_Flag, Error_Type, &deg_info, deg, Ndeg);
+    }
+    if ((*Error_Flag) == 0) {
+        pesq_process (&ref_info, &deg_info, &err_info, Error_Flag, Error_Type);
+    }
+    safe_free (ref);
+    safe_free (deg);
+    if ((*Error_Flag) != 0) {
+        return -1;
+    }
+
+    c-> pesq_mos = err_info. pesq_mos;
+    c-> Crude_DelayEst = err_info. Crude_DelayEst;
+    for (i = 0; i < PROFILE_CHECKSUMS; i++) {
+        c-> checksum [i] = Profile. checksum [i];
+    }
+    c-> Nutterances = err_info. Nutterances;
+    for (i = 0; i < err_info. Nutterances; i++) {
+        c-> Utt_Delay [i] = err_info. Utt_Delay [i];
+    }
+    return 0;
+}
+
+/* Scores the clean pair live, pushed a hop at a time, and returns in mos
+   the score of the window ending at window_end seconds. */
+
+static int regress_live (long sample_rate, double hop, double window_end, double * mos,
+     long * Error_Flag, char ** Error_Type)
+{
+    LIVE_INFO  *live;
+    ERROR_INFO  err_info;
+    long        Nref, Ndeg;
+    float      *ref, *deg;
+    long        chunk = (long) (hop * sample_rate);
+    long        pos = 0;
+    int         scored = 0;
+
+    select_rate (sample_rate, Error_Flag, Error_Type);
+    if ((*Error_Flag) != 0) {
+        return -1;
+    }
+    live = live_open (REGRESS_LIVE_WINDOW, hop, Error_Flag, Error_Type);
+    if (live == NULL) {
+        return -1;
+    }
+    synth_pair (SYNTH_CLEAN, sample_rate, REGRESS_LIVE_SECONDS, 1, &ref, &deg, &Nref, &Ndeg);
+
+    *mos = -1;
+    while (!live-> ended) {
+        long Nref_chunk = max (min (chunk, Nref - pos), 0);
+        long Ndeg_chunk = max (min (chunk, Ndeg - pos), 0);
+
+        if ((Nref_chunk == 0) && (Ndeg_chunk == 0)) {
+            live_end (live);
+        } else if (live_push (live, ref + pos, Nref_chunk, deg + pos, Ndeg_chunk) != 0) {
+            scored = -1;
+            break;
+        }
+        pos += chunk;
+        while ((scored = live_score (live, &err_info)) == 1) {
+            if (live-> next - live-> Nhop == (long) floor (window_end * sample_rate + 0.5)) {
+                *mos = err_info. pesq_mos;
+            }
+        }
+        if (scored < 0) {
+            break;
+        }
+    }
+
+    live_close (live);
+    safe_free (ref);
+    safe_free (deg);
+    if (scored < 0) {
+        (*Error_Flag) = 1;
+        (*Error_Type) = "Failed to allocate memory for live scoring";
+        return -1;
+    }
+    return 0;
+}
+
+/* Scores the clean pair live a hop at a time and each window again with
+   pesq_process on that window alone, as +ref-range and +deg-range would
+   load it. Returns in worst the largest difference of the two and in
+   worst_end the end of its window in seconds. */
+
+static int regress_live_ranged (long sample_rate, double * worst, double * worst_end,
+     long * Error_Flag, char ** Error_Type)
+{
+    LIVE_INFO  *live;
+    ERROR_INFO  err_info;
+    SIGNAL_INFO ref_info;
+    SIGNAL_INFO deg_info;
+    long        Nref, Ndeg;
+    float      *ref, *deg;
+    long        chunk = (long) (REGRESS_LIVE_RANGED_HOP * sample_rate);
+    long        pos = 0;
+    int         scored = 0;
+
+    select_rate (sample_rate, Error_Flag, Error_Type);
+    if ((*Error_Flag) != 0) {
+        return -1;
+    }
+    live = live_open (REGRESS_LIVE_WINDOW, REGRESS_LIVE_RANGED_HOP, Error_Flag, Error_Type);
+    if (live == NULL) {
+        return -1;
+    }
+    synth_pair (SYNTH_CLEAN, sample_rate, REGRESS_LIVE_SECONDS, 1, &ref, &deg, &Nref, &Ndeg);
+    strcpy (ref_info. path_name, "synth:clean:ranged:ref");
+    strcpy (deg_info. path_name, "synth:clean:ranged:deg");
+
+    *worst = -1;
+    *worst_end = 0;
+    while (!live-> ended && ((*Error_Flag) == 0)) {
+        long Nref_chunk = max (min (chunk, Nref - pos), 0);
+        long Ndeg_chunk = max (min (chunk, Ndeg - pos), 0);
+
+        if ((Nref_chunk == 0) && (Ndeg_chunk == 0)) {
+            live_end (live);
+        } else if (live_push (live, ref + pos, Nref_chunk, deg + pos, Ndeg_chunk) != 0) {
+            scored = -1;
+            break;
+        }
+        pos += chunk;
+        while (((*Error_Flag) == 0) && ((scored = live_score (live, &err_info)) == 1)) {
+            double live_mos = err_info. pesq_mos;
+            long   end = live-> next - live-> Nhop;
+
+            load_samples (Error_Flag, Error_Type, &ref_info, ref + end - live-> Nwindow, live-> Nwindow);
+            if ((*Error_Flag) == 0) {
+                load_samples (Error_Flag, Error_Type, &deg_info, deg + end - live-> Nwindow, live-> Nwindow);
+            }
+            if ((*Error_Flag) == 0) {
+                pesq_process (&ref_info, &deg_info, &err_info, Error_Flag, Error_Type);
+            }
+            if (((*Error_Flag) == 0) && (fabs (live_mos - err_info. pesq_mos) > *worst)) {
+                *worst = fabs (live_mos - err_info. pesq_mos);
+                *worst_end = (double) end / sample_rate;
+            }
+        }
+        if (scored < 0) {
+            break;
+        }
+    }
+
+    live_close (live);
+    safe_free (ref);
+    safe_free (deg);
+    if (scored < 0) {
+        (*Error_Flag) = 1;
+        (*Error_Type) = "Failed to allocate memory for live scoring";
+    }
+    return ((*Error_Flag) == 0) ? 0 : -1;
+}
+
+static void regress_write (FILE * golden, REGRESS_CASE * c)
+{
+    long i;
+
+    fprintf (golden, "%s %ld %.1f %.6f %ld", c-> name, c-> sample_rate, c-> seconds,
+             c-> pesq_mos, c-> Crude_DelayEst);
+    for (i = 0; i < PROFILE_CHECKSUMS; i++) {
+        fprintf (golden, " %.17g", c-> checksum [i]);
+    }
+    fprintf (golden, " %ld", c-> Nutterances);
+    for (i = 0; i < c-> Nutterances; i++) {
+        fprintf (golden, " %ld", c-> Utt_Delay [i]);
+    }
+    fprintf (golden, "\n");
+}
+
+static int regress_read (char * line, REGRESS_CASE * c)
+{
+    char *p = strtok (line, " \t\r\n");
+    long  i;
+
+    if ((p == NULL) || (p [0] == '#')) {
+        return 0;
+    }
+    strcpy (c-> name, "");
+    strncat (c-> name, p, sizeof (c-> name) - 1);
+
+#define REGRESS_FIELD(conv) \
+    if ((p = strtok (NULL, " \t\r\n")) == NULL) return -1; \
+    conv;
+
+    REGRESS_FIELD (c-> sample_rate = atol (p))
+    REGRESS_FIELD (c-> seconds = atof (p))
+    REGRESS_FIELD (c-> pesq_mos = atof (p))
+    REGRESS_FIELD (c-> Crude_DelayEst = atol (p))
+    for (i = 0; i < PROFILE_CHECKSUMS; i++) {
+        REGRESS_FIELD (c-> checksum [i] = atof (p))
+    }
+    REGRESS_FIELD (c-> Nutterances = atol (p))
+    if ((c-> Nutterances < 0) || (c-> Nutterances > MAXNUTTERANCES)) {
+        return -1;
+    }
+    for (i = 0; i < c-> Nutterances; i++) {
+        REGRESS_FIELD (c-> Utt_Delay [i] = atol (p))
+    }
+    return 1;
+}
+
+static double relative_change (double value, double golden)
+{
+    return fabs (value - golden) / max (1.0, fabs (golden));
+}
+
+/* Returns NULL when the pair matches, otherwise the first stage that does
+   not; detail receives the values that differ. */
+
+static char * regress_compare (REGRESS_CASE * got, REGRESS_CASE * want, double mos_tolerance,
+    double checksum_tolerance, long delay_tolerance, char * detail)
+{
+    long i;
+
+    if (labs (got-> Crude_DelayEst - want-> Crude_DelayEst) > delay_tolerance) {
+        sprintf (detail, "Crude_DelayEst %ld, golden %ld", got-> Crude_DelayEst, want-> Crude_DelayEst);
+        return "crude_align";
+    }
+    if (got-> Nutterances != want-> Nutterances) {
+        sprintf (detail, "Nutterances %ld, golden %ld", got-> Nutterances, want-> Nutterances);
+        return "utterance_locate";
+    }
+    for (i = 0; i < want-> Nutterances; i++) {
+        if (labs (got-> Utt_Delay [i] - want-> Utt_Delay [i]) > delay_tolerance) {
+            sprintf (detail, "Utt_Delay [%ld] %ld, golden %ld", i, got-> Utt_Delay [i], want-> Utt_Delay [i]);
+            return "utterance_locate";
+        }
+    }
+    for (i = 0; i < PROFILE_CHECKSUMS; i++) {
+        if (relative_change (got-> checksum [i], want-> checksum [i]) > checksum_tolerance) {
+            sprintf (detail, "checksum %.17g, golden %.17g", got-> checksum [i], want-> checksum [i]);
+            return Checksum_Stage [i];
+        }
+    }
+    if (fabs (got-> pesq_mos - want-> pesq_mos) > mos_tolerance) {
+        sprintf (detail, "PESQ_MOS %.6f, golden %.6f", got-> pesq_mos, want-> pesq_mos);
+        return "Lpq";
+    }
+    return NULL;
+}
+
+int main (int argc, const char *argv []) {
+    const char   *golden_name = REGRESS_GOLDEN_FILE;
+    double        mos_tolerance = 0.001;
+    double        checksum_tolerance = 1E-6;
+    long          delay_tolerance = 0;
+    int           update = 0;
+    long          Npassed = 0;
+    long          Nfailed = 0;
+    FILE         *golden;
+    FILE         *report;
+    char          line [REGRESS_LINE];
+    REGRESS_CASE  want;
+    REGRESS_CASE  got;
+    int           arg;
+
+    for (arg = 1; arg < argc; arg++) {
+        if (strcmp (argv [arg], "+update") == 0) {
+            update = 1;
+        } else if (strncmp (argv [arg], "+tolerance=", 11) == 0) {
+            mos_tolerance = atof (argv [arg] + 11);
+        } else if (strncmp (argv [arg], "+checksum-tolerance=", 20) == 0) {
+            checksum_tolerance = atof (argv [arg] + 20);
+        } else if (strncmp (argv [arg], "+delay-tolerance=", 17) == 0) {
+            delay_tolerance = atol (argv [arg] + 17);
+        } else if ((argv [arg][0] == '+') || (strcmp (argv [arg], "HELP") == 0)) {
+            usage ();
+            return 2;
+        } else {
+            golden_name = argv [arg];
+        }
+    }
+
+    report = serve_redirect_stdout ();
+    if (report == NULL) {
+        fprintf (stderr, "Could not redirect standard output.\n");
+        return 2;
+    }
+
+    if (update) {
+        int  kind;
+        long r, s;
+
+        golden = fopen (golden_name, "wt");
+        if (golden == NULL) {
+            fprintf (report, "Could not write golden file %s.\n", golden_name);
+            return 2;
+        }
+        fprintf (golden, "# PESQ regression golden values, written by pesqregress +update.\n");
+        fprintf (golden, "# signal sample_freq seconds pesq_mos Crude_DelayEst");
+        for (arg = 0; arg < PROFILE_CHECKSUMS; arg++) {
+            fprintf (golden, " checksum%d", arg);
+        }
+        fprintf (golden, " Nutterances Utt_Delay...\n");
+
+        for (r = 0; r < sizeof (Regress_Rates) / sizeof (Regress_Rates [0]); r++) {
+            for (kind = 0; kind < SYNTH_KINDS; kind++) {
+                for (s = 0; s < sizeof (Regress_Seconds) / sizeof (Regress_Seconds [0]); s++) {
+                    long  Error_Flag = 0;
+                    char *Error_Type = "Unknown error type.";
+
+                    strcpy (got. name, Synth_Kind_Name [kind]);
+                    got. sample_rate = Regress_Rates [r];
+                    got. seconds = Regress_Seconds [s];
+                    if (regress_score (&got, &Error_Flag, &Error_Type) != 0) {
+                        fprintf (report, "ERROR %s %ld %.1f: %s\n", got. name, got. sample_rate,
+                                 got. seconds, Error_Type);
+                        fclose (golden);
+                        return 2;
+                    }
+                    regress_write (golden, &got);
+                    fprintf (report, "WROTE %s %ld %.1f: PESQ_MOS %.6f\n", got. name,
+                             got. sample_rate, got. seconds, got. pesq_mos);
+                }
+            }
+        }
+        fclose (golden);
+        fclose (report);
+        return 0;
+    }
+
+    golden = fopen (golden_name, "rt");
+    if (golden == NULL) {
+        fprintf (report, "Could not open golden file %s.\n", golden_name);
+        return 2;
+    }
+
+    while (fgets (line, sizeof (line), golden) != NULL) {
+        long  Error_Flag = 0;
+        char *Error_Type = "Unknown error type.";
+        char  detail [128];
+        char *stage;
+        int   status = regress_read (line, &want);
+
+        if (status == 0) {
+            continue;
+        }
+        if (status < 0) {
+            fprintf (report, "ERROR malformed golden line for %s\n", want. name);
+            Nfailed++;
+            continue;
+        }
+
+        got = want;
+        if (regress_score (&got, &Error_Flag, &Error_Type) != 0) {
+            fprintf (report, "FAIL %s %ld %.1f: %s\n", want. name, want. sample_rate,
+                     want. seconds, Error_Type);
+            Nfailed++;
+            continue;
+        }
+
+        stage = regress_compare (&got, &want, mos_tolerance, checksum_tolerance, delay_tolerance, detail);
+        if (stage == NULL) {
+            fprintf (report, "PASS %s %ld %.1f: PESQ_MOS %.6f\n", want. name, want. sample_rate,
+                     want. seconds, got. pesq_mos);
+            Npassed++;
+        } else {
+            fprintf (report, "FAIL %s %ld %.1f: first divergence in %s (%s), PESQ_MOS %.6f, golden %.6f\n",
+                     want. name, want. sample_rate, want. seconds, stage, detail,
+                     got. pesq_mos, want. pesq_mos);
+            Nfailed++;
+        }
+    }
+    fclose (golden);
+
+    for (arg = 0; arg < sizeof (Regress_Rates) / sizeof (Regress_Rates [0]); arg++) {
+        long e;
+
+        for (e = 0; e < sizeof (Regress_Live_Ends) / sizeof (Regress_Live_Ends [0]); e++) {
+            long   Error_Flag = 0;
+            char  *Error_Type = "Unknown error type.";
+            double mos [2];
+            long   h;
+
+            for (h = 0; (h < 2) && (Error_Flag == 0); h++) {
+                regress_live (Regress_Rates [arg], Regress_Live_Hops [h], Regress_Live_Ends [e],
+                              &mos [h], &Error_Flag, &Error_Type);
+            }
+            if (Error_Flag != 0) {
+                fprintf (report, "FAIL live %ld %.3f: %s\n", Regress_Rates [arg],
+                         Regress_Live_Ends [e], Error_Type);
+                Nfailed++;
+            } else if ((mos [0] < 0) || (mos [0] != mos [1])) {
+                fprintf (report, "FAIL live %ld %.3f: PESQ_MOS %.6f at a %.3f s hop, %.6f at %.3f s\n",
+                         Regress_Rates [arg], Regress_Live_Ends [e], mos [0], Regress_Live_Hops [0],
+                         mos [1], Regress_Live_Hops [1]);
+                Nfailed++;
+            } else {
+                fprintf (report, "PASS live %ld %.3f: PESQ_MOS %.6f at %.3f and %.3f s hops\n",
+                         Regress_Rates [arg], Regress_Live_Ends [e], mos [0],
+                         Regress_Live_Hops [0], Regress_Live_Hops [1]);
+                Npassed++;
+            }
+        }
+    }
+
+    for (arg = 0; arg < sizeof (Regress_Rates) / sizeof (Regress_Rates [0]); arg++) {
+        long   Error_Flag = 0;
+        char  *Error_Type = "Unknown error type.";
+        double worst, worst_end;
+
+        if (regress_live_ranged (Regress_Rates [arg], &worst, &worst_end, &Error_Flag, &Error_Type) != 0) {
+            fprintf (report, "FAIL live ranged %ld: %s\n", Regress_Rates [arg], Error_Type);
+            Nfailed++;
+        } else if ((worst < 0) || (worst > REGRESS_LIVE_RANGED_TOLERANCE)) {
+            fprintf (report, "FAIL live ranged %ld: PESQ_MOS differs by %.6f from the window ending at %.3f s\n",
+                     Regress_Rates [arg], worst, worst_end);
+            Nfailed++;
+        } else {
+            fprintf (report, "PASS live ranged %ld: PESQ_MOS within %.6f of every window\n",
+                     Regress_Rates [arg], worst);
+            Npassed++;
+        }
+    }
+
+    fprintf (report, "%ld passed, %ld failed.\n", Npassed, Nfailed);
+    fclose (report);
+
+    return (Nfailed == 0) ? 0 : 1;
+}
+
+/* END OF FILE */
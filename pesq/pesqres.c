@@ -0,0 +1,631 @@
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
+the terms Perceptual Evaluation of Speech Quality Algorithm?
+and PESQ Algorithm?refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term PESQ Software?refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "pesq.h"
+#include "dsp.h"
+
+#ifdef _WIN32
+  #define open   _open
+  #define write  _write
+  #define close  _close
+  #define fstat  _fstat
+  #define stat   _stat
+  #define O_APPEND   _O_APPEND
+  #define O_CREAT    _O_CREAT
+  #define O_WRONLY   _O_WRONLY
+#endif
+
+static char * result_header [] = {
+    "REFERENCE\t DEGRADED\t PESQMOS\t PESQMOS\t SUBJMOS\t COND\t SAMPLE_FREQ\t CRUDE_DELAY\n",
+    "DEGRADED\t PESQMOS\t SUBJMOS\t COND\t SAMPLE_FREQ\t CRUDE_DELAY\n",
+    "REFERENCE,DEGRADED,PESQMOS,SUBJMOS,COND,SAMPLE_FREQ,CRUDE_DELAY,NUTTERANCES,UTT_DELAYS,TIME\n",
+    "",
+    ""
+};
+
+static int lock_results_file (int fd, int lock)
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct flock fl;
+
+    fl.l_type = lock ? F_WRLCK : F_UNLCK;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = 0;
+    fl.l_len = 0;
+
+    while (fcntl (fd, F_SETLKW, &fl) != 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    return 0;
+#endif
+}
+
+static int write_all (int fd, const char * data, long n)
+{
+    while (n > 0) {
+        long done = (long) write (fd, data, n);
+        if (done <= 0) {
+            return -1;
+        }
+        data += done;
+        n -= done;
+    }
+    return 0;
+}
+
+/* quote selects the escaping rules of a format; RESULTS_ITU copies text verbatim */
+
+static long put_text (char * buffer, long size, long pos, const char * text, int quote)
+{
+    if (quote == RESULTS_CSV) {
+        if (pos < size) buffer [pos] = '"';
+        pos++;
+    }
+    if (quote == RESULTS_JSON) {
+        if (pos < size) buffer [pos] = '"';
+        pos++;
+    }
+
+    while (*text != '\0') {
+        char c = *(text++);
+
+        if ((quote == RESULTS_CSV) && (c == '"')) {
+            if (pos < size) buffer [pos] = '"';
+            pos++;
+        }
+        if ((quote == RESULTS_JSON) && ((c == '"') || (c == '\\'))) {
+            if (pos < size) buffer [pos] = '\\';
+            pos++;
+        }
+        if ((quote == RESULTS_JSON) && ((unsigned char) c < 0x20)) {
+            c = ' ';
+        }
+        if (pos < size) buffer [pos] = c;
+        pos++;
+    }
+
+    if (quote == RESULTS_CSV || quote == RESULTS_JSON) {
+        if (pos < size) buffer [pos] = '"';
+        pos++;
+    }
+    return pos;
+}
+
+/* The name of a source, with the channel scored appended as '#n' when
+   the source has more than one. */
+
+static long put_source (char * buffer, long size, long pos, SIGNAL_INFO * info,
+     int file_name, int quote)
+{
+    char text [sizeof (info-> path_name) + 16];
+
+    strcpy (text, file_name ? info-> file_name : info-> path_name);
+    if (info-> Nchannels > 1) {
+        sprintf (text + strlen (text), "#%ld", info-> channel + 1);
+    }
+    return put_text (buffer, size, pos, text, quote);
+}
+
+static long put_format (char * buffer, long size, long pos, const char * format, double value)
+{
+    char text [64];
+
+    sprintf (text, format, value);
+    return put_text (buffer, size, pos, text, RESULTS_ITU);
+}
+
+long format_result( char * buffer, long size, int format,
+     SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, ERROR_INFO * err_info,
+     double elapsed )
+{
+    long pos = 0;
+    long utt;
+    int  first;
+    char text [64];
+
+    switch (format) {
+    case RESULTS_ITU:
+        pos = put_source (buffer, size, pos, ref_info, 0, RESULTS_ITU);
+        pos = put_text (buffer, size, pos, "\t ", RESULTS_ITU);
+        pos = put_source (buffer, size, pos, deg_info, 0, RESULTS_ITU);
+        pos = put_text (buffer, size, pos, "\t ", RESULTS_ITU);
+        pos = put_format (buffer, size, pos, "SQValue=%.3f\t ", err_info-> pesq_mos);
+        pos = put_format (buffer, size, pos, "%.3f\t ", err_info-> pesq_mos);
+        pos = put_format (buffer, size, pos, "%.3f\t ", err_info-> subj_mos);
+        pos = put_format (buffer, size, pos, "%.0f\t ", err_info-> cond_nr);
+        pos = put_format (buffer, size, pos, "%.0f\t", Fs);
+        pos = put_format (buffer, size, pos, "%.4f\n ", (float) err_info-> Crude_DelayEst / (float) Fs);
+        break;
+
+    case RESULTS_SIMPLE:
+        pos = put_source (buffer, size, pos, deg_info, 1, RESULTS_ITU);
+        pos = put_text (buffer, size, pos, "\t ", RESULTS_ITU);
+        pos = put_format (buffer, size, pos, "%.3f\t ", err_info-> pesq_mos);
+        pos = put_format (buffer, size, pos, "%.3f\t ", err_info-> subj_mos);
+        pos = put_format (buffer, size, pos, "%.0f\t ", err_info-> cond_nr);
+        pos = put_format (buffer, size, pos, "%.0f\t", Fs);
+        pos = put_format (buffer, size, pos, "%.4f\n ", (float) err_info-> Crude_DelayEst / (float) Fs);
+        break;
+
+    case RESULTS_CSV:
+        pos = put_source (buffer, size, pos, ref_info, 0, RESULTS_CSV);
+        pos = put_text (buffer, size, pos, ",", RESULTS_ITU);
+        pos = put_source (buffer, size, pos, deg_info, 0, RESULTS_CSV);
+        pos = put_format (buffer, size, pos, ",%.3f", err_info-> pesq_mos);
+        pos = put_format (buffer, size, pos, ",%.3f", err_info-> subj_mos);
+        pos = put_format (buffer, size, pos, ",%.0f", err_info-> cond_nr);
+        pos = put_format (buffer, size, pos, ",%.0f", Fs);
+        pos = put_format (buffer, size, pos, ",%.4f", (float) err_info-> Crude_DelayEst / (float) Fs);
+        pos = put_format (buffer, size, pos, ",%.0f,", err_info-> Nutterances);
+        for (utt = 0; utt < err_info-> Nutterances; utt++) {
+            pos = put_format (buffer, size, pos, (utt == 0) ? "%.4f" : ";%.4f",
+                              (float) err_info-> Utt_Delay [utt] / (float) Fs);
+        }
+        pos = put_format (buffer, size, pos, ",%.6f\n", elapsed);
+        break;
+
+    case RESULTS_JSON:
+        pos = put_text (buffer, size, pos, "{\"reference\":", RESULTS_ITU);
+        pos = put_source (buffer, size, pos, ref_info, 0, RESULTS_JSON);
+        pos = put_text (buffer, size, pos, ",\"degraded\":", RESULTS_ITU);
+        pos = put_source (buffer, size, pos, deg_info, 0, RESULTS_JSON);
+        pos = put_format (buffer, size, pos, ",\"pesq_mos\":%.3f", err_info-> pesq_mos);
+        if (err_info-> pesq_mos_error > 0) {
+            pos = put_format (buffer, size, pos, ",\"pesq_mos_error\":%.3f", err_info-> pesq_mos_error);
+        }
+        pos = put_format (buffer, size, pos, ",\"subj_mos\":%.3f", err_info-> subj_mos);
+        pos = put_format (buffer, size, pos, ",\"cond\":%.0f", err_info-> cond_nr);
+        pos = put_format (buffer, size, pos, ",\"sample_freq\":%.0f", Fs);
+        pos = put_format (buffer, size, pos, ",\"crude_delay\":%.4f", (float) err_info-> Crude_DelayEst / (float) Fs);
+        pos = put_text (buffer, size, pos, ",\"utt_delays\":[", RESULTS_ITU);
+        for (utt = 0; utt < err_info-> Nutterances; utt++) {
+            pos = put_format (buffer, size, pos, (utt == 0) ? "%.4f" : ",%.4f",
+                              (float) err_info-> Utt_Delay [utt] / (float) Fs);
+        }
+        pos = put_format (buffer, size, pos, "],\"time\":%.6f}\n", elapsed);
+        break;
+
+    case RESULTS_PROFILE:
+        pos = put_text (buffer, size, pos, "{\"reference\":", RESULTS_ITU);
+        pos = put_source (buffer, size, pos, ref_info, 0, RESULTS_JSON);
+        pos = put_text (buffer, size, pos, ",\"degraded\":", RESULTS_ITU);
+        pos = put_source (buffer, size, pos, deg_info, 0, RESULTS_JSON);
+        pos = put_format (buffer, size, pos, ",\"sample_freq\":%.0f", Fs);
+        pos = put_format (buffer, size, pos, ",\"time\":%.6f,\"stages\":{", elapsed);
+        for (utt = 0; utt < PROFILE_STAGES; utt++) {
+            pos = put_text (buffer, size, pos, (utt == 0) ? "" : ",", RESULTS_ITU);
+            pos = put_text (buffer, size, pos, Profile_Stage_Name [utt], RESULTS_JSON);
+            pos = put_format (buffer, size, pos, ":{\"time\":%.6f", Profile. stage_time [utt]);
+            pos = put_format (buffer, size, pos, ",\"calls\":%.0f}", Profile. stage_calls [utt]);
+        }
+        pos = put_text (buffer, size, pos, "},\"fft_calls\":{", RESULTS_ITU);
+        for (utt = 0, first = 1; utt < FFTSIZES; utt++) {
+            if (FFTCalls [utt] > 0) {
+                sprintf (text, "%s\"%lu\":%lu", first ? "" : ",", 1UL << utt, FFTCalls [utt]);
+                pos = put_text (buffer, size, pos, text, RESULTS_ITU);
+                first = 0;
+            }
+        }
+        pos = put_format (buffer, size, pos, "},\"utterances\":%.0f", Profile. Nutterances);
+        pos = put_format (buffer, size, pos, ",\"bad_intervals\":%.0f", Profile. Nbad_intervals);
+        pos = put_format (buffer, size, pos, ",\"frames\":%.0f", Profile. Nframes);
+        pos = put_format (buffer, size, pos, ",\"peak_heap\":%.0f}\n", heap_peak);
+        break;
+    }
+
+    if (size > 0) {
+        buffer [min (pos, size - 1)] = '\0';
+    }
+    return pos;
+}
+
+long format_error( char * buffer, long size,
+     SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info,
+     long Error_Flag, char * Error_Type )
+{
+    long pos = 0;
+
+    pos = put_text (buffer, size, pos, "{\"reference\":", RESULTS_ITU);
+    pos = put_text (buffer, size, pos, ref_info-> path_name, RESULTS_JSON);
+    pos = put_text (buffer, size, pos, ",\"degraded\":", RESULTS_ITU);
+    pos = put_text (buffer, size, pos, deg_info-> path_name, RESULTS_JSON);
+    pos = put_format (buffer, size, pos, ",\"error\":%.0f,\"message\":", Error_Flag);
+    pos = put_text (buffer, size, pos, (Error_Type != NULL) ? Error_Type : "", RESULTS_JSON);
+    pos = put_text (buffer, size, pos, "}\n", RESULTS_ITU);
+
+    if (size > 0) {
+        buffer [min (pos, size - 1)] = '\0';
+    }
+    return pos;
+}
+
+void open_results( RESULT_SINK * sink )
+{
+    sink-> Nfiles = 0;
+}
+
+int add_results_file( RESULT_SINK * sink, const char * path_name, int format )
+{
+    RESULT_FILE * file;
+
+    if (sink-> Nfiles >= MAXRESULTFILES) {
+        return -1;
+    }
+
+    file = &(sink-> file [sink-> Nfiles]);
+    strncpy (file-> path_name, path_name, sizeof (file-> path_name) - 1);
+    file-> path_name [sizeof (file-> path_name) - 1] = '\0';
+    file-> format = format;
+    file-> used = 0;
+
+    file-> fd = open (file-> path_name, O_WRONLY | O_CREAT | O_APPEND, 0666);
+    if (file-> fd < 0) {
+        printf ("Could not open results file %s!\n", file-> path_name);
+        return -1;
+    }
+
+    file-> buffer = (char *) safe_malloc (RESULTBUFFER);
+    if (file-> buffer == NULL) {
+        close (file-> fd);
+        return -1;
+    }
+
+    sink-> Nfiles++;
+    return 0;
+}
+
+static int flush_results_file (RESULT_FILE * file)
+{
+    struct stat st;
+    int result = 0;
+
+    if (file-> used == 0) {
+        return 0;
+    }
+
+    if (lock_results_file (file-> fd, 1) != 0) {
+        printf ("Could not lock results file %s!\n", file-> path_name);
+        return -1;
+    }
+
+    if ((fstat (file-> fd, &st) == 0) && (st.st_size == 0)) {
+        result = write_all (file-> fd, result_header [file-> format],
+                            (long) strlen (result_header [file-> format]));
+    }
+    if (result == 0) {
+        result = write_all (file-> fd, file-> buffer, file-> used);
+    }
+
+    lock_results_file (file-> fd, 0);
+
+    if (result != 0) {
+        printf ("Could not write results file %s!\n", file-> path_name);
+    }
+    file-> used = 0;
+    return result;
+}
+
+void write_results( RESULT_SINK * sink,
+     SIGNAL_INFO * ref_info, SIGNAL_INFO * deg_info, ERROR_INFO * err_info,
+     double elapsed )
+{
+    char record [4096];
+    long i;
+
+    for (i = 0; i < sink-> Nfiles; i++) {
+        RESULT_FILE * file = &(sink-> file [i]);
+        long n = format_result (record, sizeof (record), file-> format,
+                                ref_info, deg_info, err_info, elapsed);
+
+        if (n >= (long) sizeof (record)) {
+            n = (long) sizeof (record) - 1;
+        }
+        if (file-> used + n > RESULTBUFFER) {
+            flush_results_file (file);
+        }
+        memcpy (file-> buffer + file-> used, record, n);
+        file-> used += n;
+    }
+}
+
+int flush_results( RESULT_SINK * sink )
+{
+    long i;
+    int  result = 0;
+
+    for (i = 0; i < sink-> Nfiles; i++) {
+        if (flush_results_file (&(sink-> file [i])) != 0) {
+            result = -1;
+        }
+    }
+    return result;
+}
+
+void close_results( RESULT_SINK * sink )
+{
+    long i;
+
+    flush_results (sink);
+
+    for (i = 0; i < sink-> Nfiles; i++) {
+        close (sink-> file [i]. fd);
+        safe_free (sink-> file [i]. buffer);
+    }
+    sink-> Nfiles = 0;
+}
+
+/* Identity of a result line for merging: its first two fields, split at
+   tabs and commas outside double quotes, less leading blanks. That is the
+   reference and degraded names of every format but the simple one, whose
+   degraded name and score serve as well. */
+
+static CACHE_WORD record_key (const char * line)
+{
+    CACHE_WORD    h = 0xCBF29CE484222325ULL;
+    int           fields = 0;
+    int           quoted = 0;
+
+    while ((*line == ' ') || (*line == '\t')) {
+        line++;
+    }
+    for (; (*line != '\0') && (*line != '\n'); line++) {
+        if ((*line == '\\') && quoted && (line [1] != '\0')) {
+            h = (h ^ (unsigned char) *(line++)) * 0x100000001B3ULL;
+        } else if (*line == '"') {
+            quoted = !quoted;
+        } else if (!quoted && ((*line == ',') || (*line == '\t'))) {
+            if (++fields == 2) {
+                break;
+            }
+        }
+        h = (h ^ (unsigned char) *line) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+/* Seen keys, open addressing with 0 marking an empty slot. */
+
+typedef struct {
+    CACHE_WORD    * slot;
+    unsigned long   Nslots;
+    unsigned long   Nused;
+} KEY_SET;
+
+static int key_set_add (KEY_SET * set, CACHE_WORD key)
+{
+    unsigned long i;
+
+    key = (key == 0) ? 1 : key;
+    if (2 * (set-> Nused + 1) > set-> Nslots) {
+        KEY_SET grown;
+
+        grown. Nslots = (set-> Nslots == 0) ? 4096 : 2 * set-> Nslots;
+        grown. Nused = 0;
+        grown. slot = (CACHE_WORD *) safe_malloc (grown. Nslots * sizeof (CACHE_WORD));
+        if (grown. slot == NULL) {
+            return -1;
+        }
+        memset (grown. slot, 0, grown. Nslots * sizeof (CACHE_WORD));
+        for (i = 0; i < set-> Nslots; i++) {
+            if (set-> slot [i] != 0) {
+                key_set_add (&grown, set-> slot [i]);
+            }
+        }
+        safe_free (set-> slot);
+        *set = grown;
+    }
+
+    for (i = (unsigned long) key & (set-> Nslots - 1); set-> slot [i] != 0; i = (i + 1) & (set-> Nslots - 1)) {
+        if (set-> slot [i] == key) {
+            return 0;
+        }
+    }
+    set-> slot [i] = key;
+    set-> Nused++;
+    return 1;
+}
+
+/* Writes the records of the result files in_names to out_name, in the
+   order given, with the header of their format once at the top. A pair
+   recorded more than once, as by a shard that resumed after it had
+   written a result but before it could record its progress, is kept
+   only the first time. Returns the number of records written, or -1. */
+
+long merge_results( const char * out_name, const char ** in_names, long Nin )
+{
+    char    line [8192];
+    KEY_SET seen = {NULL, 0, 0};
+    FILE  * out;
+    long    Nrecords = 0;
+    long    Nduplicates = 0;
+    long    f;
+    int     header_done = 0;
+
+    for (f = 0; f < Nin; f++) {
+        if (strcmp (in_names [f], out_name) == 0) {
+            printf ("Merged results may not overwrite %s!\n", out_name);
+            return -1;
+        }
+    }
+    out = fopen (out_name, "wb");
+    if (out == NULL) {
+        printf ("Could not open results file %s!\n", out_name);
+        return -1;
+    }
+
+    for (f = 0; f < Nin; f++) {
+        FILE * in = fopen (in_names [f], "rb");
+        int    first = 1;
+
+        if (in == NULL) {
+            printf ("Could not open results file %s!\n", in_names [f]);
+            fclose (out);
+            safe_free (seen. slot);
+            return -1;
+        }
+        while (fgets (line, sizeof (line), in) != NULL) {
+            const char * text = line + strspn (line, " \t\r\n");
+            int          format;
+            int          header = 0;
+
+            if (*text == '\0') {
+                continue;
+            }
+            for (format = 0; first && (format < MAXRESULTFILES); format++) {
+                if ((result_header [format][0] != '\0') && (strcmp (line, result_header [format]) == 0)) {
+                    header = 1;
+                }
+            }
+            first = 0;
+            if (header) {
+                if (!header_done) {
+                    fputs (line, out);
+                }
+                header_done = 1;
+                continue;
+            }
+            switch (key_set_add (&seen, record_key (text))) {
+            case 1:
+                fputs (text, out);
+                if (text [strlen (text) - 1] != '\n') {
+                    fputc ('\n', out);
+                }
+                Nrecords++;
+                break;
+            case 0:
+                Nduplicates++;
+                break;
+            default:
+                fclose (in);
+                fclose (out);
+                safe_free (seen. slot);
+                return -1;
+            }
+        }
+        fclose (in);
+    }
+
+    safe_free (seen. slot);
+    if (fclose (out) != 0) {
+        printf ("Could not write results file %s!\n", out_name);
+        return -1;
+    }
+    printf ("Merged %ld records from %ld files into %s, %ld duplicates dropped.\n",
+            Nrecords, Nin, out_name, Nduplicates);
+    return Nrecords;
+}
+
+/* END OF FILE */
@@ -0,0 +1,495 @@
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
+the terms Perceptual Evaluation of Speech Quality Algorithm?
+and PESQ Algorithm?refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term PESQ Software?refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+#include "pesq.h"
+#include "dsp.h"
+
+#ifdef _WIN32
+  #define dup    _dup
+  #define dup2   _dup2
+  #define fdopen _fdopen
+  #define close  _close
+#endif
+
+#define SERVE_LINE  2048
+#define SERVE_REPLY 8192
+
+/* In stdio serving the replies own the original standard output; the
+   progress messages printed by the model are sent to standard error. */
+
+FILE * serve_redirect_stdout( void )
+{
+    int reply_fd;
+
+    fflush (stdout);
+    reply_fd = dup (1);
+    if (reply_fd < 0) {
+        return NULL;
+    }
+    if (dup2 (2, 1) < 0) {
+        close (reply_fd);
+        return NULL;
+    }
+    return fdopen (reply_fd, "w");
+}
+
+/* A job is one line 'ref deg [smos] [cond] [+swap] [+8000|+16000]
+   [+inrate=N] [+ref-range=s:e] [+deg-range=s:e] [+channel=n] [+ref-channel=n]
+   [+deg-channel=n]'; the reply is one JSON line. 'quit' ends the stream,
+   'shutdown' also stops a socket server. */
+
+#define SERVE_NEXT      0
+#define SERVE_QUIT      1
+#define SERVE_SHUTDOWN  2
+
+static int serve_line( char * line, FILE * out, RESULT_SINK * sink,
+     long sample_rate, long apply_swap, long input_rate )
+{
+    char        reply [SERVE_REPLY];
+    SIGNAL_INFO ref_info;
+    SIGNAL_INFO deg_info;
+    ERROR_INFO  err_info;
+    char       *token [8];
+    int         Ntokens = 0;
+    int         names = 0;
+    int         t;
+    long        job_rate = sample_rate;
+    long        Error_Flag = 0;
+    char       *Error_Type = "Unknown error type.";
+    char       *p = strtok (line, " \t\r\n");
+
+    while ((p != NULL) && (Ntokens < 8)) {
+        token [Ntokens++] = p;
+        p = strtok (NULL, " \t\r\n");
+    }
+    if ((Ntokens == 0) || (token [0][0] == '#')) {
+        return SERVE_NEXT;
+    }
+    if (strcmp (token [0], "quit") == 0) {
+        return SERVE_QUIT;
+    }
+    if (strcmp (token [0], "shutdown") == 0) {
+        return SERVE_SHUTDOWN;
+    }
+
+    strcpy (ref_info. path_name, "");
+    strcpy (deg_info. path_name, "");
+    ref_info. apply_swap = apply_swap;
+    deg_info. apply_swap = apply_swap;
+    ref_info. input_rate = input_rate;
+    deg_info. input_rate = input_rate;
+    ref_info. range_start = 0;
+    ref_info. range_end = 0;
+    deg_info. range_start = 0;
+    deg_info. range_end = 0;
+    ref_info. channel = 0;
+    deg_info. channel = 0;
+    ref_info. Nchannels = 1;
+    deg_info. Nchannels = 1;
+    err_info. subj_mos = 0;
+    err_info. cond_nr = 0;
+
+    for (t = 0; t < Ntokens; t++) {
+        if (strcmp (token [t], "+swap") == 0) {
+            ref_info. apply_swap = 1;
+            deg_info. apply_swap = 1;
+        } else if (strcmp (token [t], "+16000") == 0) {
+            job_rate = 16000L;
+        } else if (strcmp (token [t], "+8000") == 0) {
+            job_rate = 8000L;
+        } else if (strncmp (token [t], "+inrate=", 8) == 0) {
+            ref_info. input_rate = atol (token [t] + 8);
+            deg_info. input_rate = ref_info. input_rate;
+        } else if ((strncmp (token [t], "+ref-range=", 11) == 0) ||
+                   (strncmp (token [t], "+deg-range=", 11) == 0)) {
+            if (parse_range (token [t] + 11, (token [t][1] == 'r') ? &ref_info : &deg_info) != 0) {
+                Error_Flag = 1;
+                Error_Type = "Invalid range";
+            }
+        } else if ((strncmp (token [t], "+channel=", 9) == 0) ||
+                   (strncmp (token [t], "+ref-channel=", 13) == 0) ||
+                   (strncmp (token [t], "+deg-channel=", 13) == 0)) {
+            const char * value = strchr (token [t], '=') + 1;
+            if (((token [t][1] != 'd') && (parse_channel (value, &ref_info) != 0)) ||
+                ((token [t][1] != 'r') && (parse_channel (value, &deg_info) != 0))) {
+                Error_Flag = 1;
+                Error_Type = "Invalid channel";
+            }
+        } else if (token [t][0] == '+') {
+            Error_Flag = 1;
+            Error_Type = "Invalid job option";
+        } else {
+            switch (names++) {
+                case 0:
+                    strncat (ref_info. path_name, token [t], sizeof (ref_info. path_name) - 1);
+                    break;
+                case 1:
+                    strncat (deg_info. path_name, token [t], sizeof (deg_info. path_name) - 1);
+                    break;
+                case 2:
+                    sscanf (token [t], "%f", &(err_info. subj_mos));
+                    break;
+                case 3:
+                    sscanf (token [t], "%d", &(err_info. cond_nr));
+                    break;
+                default:
+                    Error_Flag = 1;
+                    Error_Type = "Too many job parameters";
+            }
+        }
+    }
+    if ((Error_Flag == 0) && (names < 2)) {
+        Error_Flag = 1;
+        Error_Type = "Job needs a reference and a degraded file";
+    }
+
+    if (Error_Flag == 0) {
+        select_rate (job_rate, &Error_Flag, &Error_Type);
+    }
+    if (Error_Flag == 0) {
+        double start_time = wall_clock ();
+
+        measure_pair (&ref_info, &deg_info, &err_info, sink, &Error_Flag, &Error_Type);
+        if (Error_Flag == 0) {
+            format_result (reply, sizeof (reply), RESULTS_JSON,
+                           &ref_info, &deg_info, &err_info, wall_clock () - start_time);
+        }
+    }
+    if (Error_Flag != 0) {
+        format_error (reply, sizeof (reply), &ref_info, &deg_info, Error_Flag, Error_Type);
+    }
+
+    fputs (reply, out);
+    fflush (out);
+    flush_results (sink);
+
+    return SERVE_NEXT;
+}
+
+/* Serves the jobs of stream in until it ends. Returns 1 on shutdown. */
+
+int serve_stream( FILE * in, FILE * out, RESULT_SINK * sink,
+     long sample_rate, long apply_swap, long input_rate )
+{
+    char line [SERVE_LINE];
+    int  served = SERVE_NEXT;
+
+    while ((served == SERVE_NEXT) && (fgets (line, sizeof (line), in) != NULL)) {
+        served = serve_line (line, out, sink, sample_rate, apply_swap, input_rate);
+    }
+
+    return (served == SERVE_SHUTDOWN);
+}
+
+#ifndef _WIN32
+
+/* A connection to the socket server: the descriptor, the stream replies
+   are written to and the start of a job line not yet complete. */
+
+#define SERVE_CLIENTS 16
+
+typedef struct {
+    int    fd;
+    FILE * out;
+    long   Nbuffered;
+    char   line [SERVE_LINE];
+} SERVE_CLIENT;
+
+/* Reads what client has sent and serves each job line it completes, the
+   rest of a line ending with the connection, and as fgets does, a line
+   too long for the buffer in pieces. Returns SERVE_NEXT while the
+   connection stays open. */
+
+static int serve_client( SERVE_CLIENT * client, RESULT_SINK * sink,
+     long sample_rate, long apply_swap, long input_rate )
+{
+    char job [SERVE_LINE];
+    long Nread = (long) read (client-> fd, client-> line + client-> Nbuffered,
+                              SERVE_LINE - 1 - client-> Nbuffered);
+    int  served = SERVE_NEXT;
+
+    if (Nread < 0) {
+        return ((errno == EINTR) || (errno == EAGAIN)) ? SERVE_NEXT : SERVE_QUIT;
+    }
+    client-> Nbuffered += Nread;
+
+    while (served == SERVE_NEXT) {
+        char * end = memchr (client-> line, '\n', client-> Nbuffered);
+        long   length = (end != NULL) ? end + 1 - client-> line : client-> Nbuffered;
+
+        if ((end == NULL) && (Nread > 0) && (client-> Nbuffered < SERVE_LINE - 1)) {
+            break;
+        }
+        if (length == 0) {
+            break;
+        }
+        memcpy (job, client-> line, length);
+        job [length] = '\0';
+        client-> Nbuffered -= length;
+        memmove (client-> line, client-> line + length, client-> Nbuffered);
+        served = serve_line (job, client-> out, sink, sample_rate, apply_swap, input_rate);
+    }
+
+    return ((served == SERVE_NEXT) && (Nread == 0)) ? SERVE_QUIT : served;
+}
+
+#endif
+
+/* Serves the connections to socket_path together, a job line at a time in
+   the order they arrive, so that a client holding its connection open
+   does not keep out the others. Each job is scored in turn: the others
+   wait while one is being scored. */
+
+int serve_socket( const char * socket_path, RESULT_SINK * sink,
+     long sample_rate, long apply_swap, long input_rate )
+{
+#ifdef _WIN32
+    printf ("Serving on a socket is not supported on this platform!\n");
+    return -1;
+#else
+    struct sockaddr_un address;
+    struct stat        existing;
+    struct pollfd      polled [SERVE_CLIENTS + 1];
+    SERVE_CLIENT     * clients;
+    int    listen_fd;
+    int    Nclients = 0;
+    int    stop = 0;
+    int    result = 0;
+    int    c;
+
+    if (strlen (socket_path) >= sizeof (address. sun_path)) {
+        printf ("Socket path %s is too long!\n", socket_path);
+        return -1;
+    }
+
+    listen_fd = socket (AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        printf ("Could not create socket %s!\n", socket_path);
+        return -1;
+    }
+
+    memset (&address, 0, sizeof (address));
+    address. sun_family = AF_UNIX;
+    strcpy (address. sun_path, socket_path);
+
+    /* a socket left by an earlier server is replaced, anything else kept */
+    if (lstat (socket_path, &existing) == 0) {
+        if (!S_ISSOCK (existing. st_mode)) {
+            printf ("%s exists and is not a socket!\n", socket_path);
+            close (listen_fd);
+            return -1;
+        }
+        unlink (socket_path);
+    }
+
+    /* non-blocking, as a connection polled as pending may be gone by the
+       time it is accepted */
+    if ((bind (listen_fd, (struct sockaddr *) &address, sizeof (address)) != 0) ||
+        (listen (listen_fd, 8) != 0) ||
+        (fcntl (listen_fd, F_SETFL, fcntl (listen_fd, F_GETFL) | O_NONBLOCK) != 0)) {
+        printf ("Could not listen on socket %s!\n", socket_path);
+        close (listen_fd);
+        return -1;
+    }
+
+    clients = (SERVE_CLIENT *) safe_malloc (SERVE_CLIENTS * sizeof (SERVE_CLIENT));
+    if (clients == NULL) {
+        close (listen_fd);
+        unlink (socket_path);
+        return -1;
+    }
+    for (c = 0; c < SERVE_CLIENTS; c++) {
+        clients [c]. fd = -1;
+    }
+
+    signal (SIGPIPE, SIG_IGN);
+
+    printf ("Serving jobs on %s.\n", socket_path);
+    fflush (stdout);
+
+    while (!stop) {
+        /* a descriptor of -1 is left out by poll */
+        polled [0]. fd = (Nclients < SERVE_CLIENTS) ? listen_fd : -1;
+        polled [0]. events = POLLIN;
+        for (c = 0; c < SERVE_CLIENTS; c++) {
+            polled [c + 1]. fd = clients [c]. fd;
+            polled [c + 1]. events = POLLIN;
+        }
+
+        if (poll (polled, SERVE_CLIENTS + 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            printf ("Could not wait for jobs on %s: %s!\n", socket_path, strerror (errno));
+            result = -1;
+            break;
+        }
+
+        for (c = 0; (c < SERVE_CLIENTS) && !stop; c++) {
+            int served;
+
+            if ((clients [c]. fd < 0) || !(polled [c + 1]. revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            served = serve_client (&clients [c], sink, sample_rate, apply_swap, input_rate);
+            if (served != SERVE_NEXT) {
+                fclose (clients [c]. out);
+                clients [c]. fd = -1;
+                Nclients--;
+            }
+            stop = (served == SERVE_SHUTDOWN);
+        }
+
+        if (!stop && (polled [0]. revents & POLLIN)) {
+            int conn_fd = accept (listen_fd, NULL, NULL);
+
+            if (conn_fd < 0) {
+                if ((errno == EINTR) || (errno == ECONNABORTED) ||
+                    (errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                    continue;
+                }
+                printf ("Could not accept a connection on %s: %s!\n", socket_path, strerror (errno));
+                result = -1;
+                break;
+            }
+            c = 0;
+            while (clients [c]. fd >= 0) {
+                c++;
+            }
+            clients [c]. out = fdopen (conn_fd, "w");
+            if (clients [c]. out == NULL) {
+                close (conn_fd);
+                continue;
+            }
+            clients [c]. fd = conn_fd;
+            clients [c]. Nbuffered = 0;
+            Nclients++;
+        }
+    }
+
+    for (c = 0; c < SERVE_CLIENTS; c++) {
+        if (clients [c]. fd >= 0) {
+            fclose (clients [c]. out);
+        }
+    }
+    safe_free (clients);
+    close (listen_fd);
+    unlink (socket_path);
+    return result;
+#endif
+}
+
+/* END OF FILE */
@@ -0,0 +1,193 @@
+/*****************************************************************************
+
+Perceptual Evaluation of Speech Quality (PESQ)
+ITU-T Recommendation P.862.
+Version 1.2 - 2 August 2002.
+
+              ****************************************
+              PESQ Intellectual Property Rights Notice
+              ****************************************
+
+DEFINITIONS:
+------------
+For the purposes of this Intellectual Property Rights Notice
+the terms Perceptual Evaluation of Speech Quality Algorithm?
+and PESQ Algorithm?refer to the objective speech quality
+measurement algorithm defined in ITU-T Recommendation P.862;
+the term PESQ Software?refers to the C-code component of P.862. 
+
+NOTICE:
+-------
+All copyright, trade marks, trade names, patents, know-how and
+all or any other intellectual rights subsisting in or used in
+connection with including all algorithms, documents and manuals
+relating to the PESQ Algorithm and or PESQ Software are and remain
+the sole property in law, ownership, regulations, treaties and
+patent rights of the Owners identified below. The user may not
+dispute or question the ownership of the PESQ Algorithm and
+or PESQ Software.
+
+OWNERS ARE:
+-----------
+
+1.	British Telecommunications plc (BT), all rights assigned
+      to Psytechnics Limited
+2.	Royal KPN NV, all rights assigned to OPTICOM GmbH
+
+RESTRICTIONS:
+-------------
+
+The user cannot:
+
+1.	alter, duplicate, modify, adapt, or translate in whole or in
+      part any aspect of the PESQ Algorithm and or PESQ Software
+2.	sell, hire, loan, distribute, dispose or put to any commercial
+      use other than those permitted below in whole or in part any
+      aspect of the PESQ Algorithm and or PESQ Software
+
+PERMITTED USE:
+--------------
+
+The user may:
+
+1.	Use the PESQ Software to:
+      i)   understand the PESQ Algorithm; or
+      ii)  evaluate the ability of the PESQ Algorithm to perform
+           its intended function of predicting the speech quality
+           of a system; or
+      iii) evaluate the computational complexity of the PESQ Algorithm,
+           with the limitation that none of said evaluations or its
+           results shall be used for external commercial use.
+
+2.	Use the PESQ Software to test if an implementation of the PESQ
+      Algorithm conforms to ITU-T Recommendation P.862.
+
+3.	With the prior written permission of both Psytechnics Limited
+      and OPTICOM GmbH, use the PESQ Software in accordance with the
+      above Restrictions to perform work that meets all of the following
+      criteria:
+      i)    the work must contribute directly to the maintenance of an
+            existing ITU recommendation or the development of a new ITU
+            recommendation under an approved ITU Study Item; and
+      ii)   the work and its results must be fully described in a
+            written contribution to the ITU that is presented at a formal
+            ITU meeting within one year of the start of the work; and
+      iii)  neither the work nor its results shall be put to any
+            commercial use other than making said contribution to the ITU.
+            Said permission will be provided on a case-by-case basis.
+
+
+ANY OTHER USE OR APPLICATION OF THE PESQ SOFTWARE AND/OR THE PESQ
+ALGORITHM WILL REQUIRE A PESQ LICENCE AGREEMENT, WHICH MAY BE OBTAINED
+FROM EITHER OPTICOM GMBH OR PSYTECHNICS LIMITED. 
+
+EACH COMPANY OFFERS OEM LICENSE AGREEMENTS, WHICH COMBINE OEM
+IMPLEMENTATIONS OF THE PESQ ALGORITHM TOGETHER WITH A PESQ PATENT LICENSE
+AGREEMENT. PESQ PATENT-ONLY LICENSE AGREEMENTS MAY BE OBTAINED FROM OPTICOM.
+
+
+***********************************************************************
+*  OPTICOM GmbH                    *  Psytechnics Limited             *
+*  Am Weichselgarten 7,            *  Fraser House, 23 Museum Street, *
+*  D- 91058 Erlangen, Germany      *  Ipswich IP1 1HN, England        *
+*  Phone: +49 (0) 9131 691 160     *  Phone: +44 (0) 1473 261 800     *
+*  Fax:   +49 (0) 9131 691 325     *  Fax:   +44 (0) 1473 261 880     *
+*  E-mail: info@opticom.de,        *  E-mail: info@psytechnics.com,   *
+*  www.opticom.de                  *  www.psytechnics.com             *
+***********************************************************************
+
+Further information is also available from www.pesq.org
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "pesq.h"
+#include "dsp.h"
+
+#ifdef PESQ_TRACE
+
+/* The trace file starts with TRACE_MAGIC. Records are buffered and written
+   out by trace_flush at the end of each pair, in one piece while they fit
+   the buffer, so that the batch workers appending to the same file do not
+   interleave their pairs. */
+
+#define TRACE_BUFFER    (1L << 20)
+
+FILE * Trace_File = NULL;
+
+int trace_open( const char * path_name )
+{
+    Trace_File = fopen (path_name, "ab");
+    if (Trace_File == NULL) {
+        return -1;
+    }
+    setvbuf (Trace_File, NULL, _IOFBF, TRACE_BUFFER);
+    fseek (Trace_File, 0, SEEK_END);
+    if (ftell (Trace_File) == 0) {
+        fwrite (TRACE_MAGIC, 1, sizeof (TRACE_MAGIC) - 1, Trace_File);
+    }
+    return 0;
+}
+
+static void trace_record( int kind, long index, long Nvalues )
+{
+    TRACE_RECORD record;
+
+    record. kind = (unsigned short) kind;
+    record. index = (unsigned short) index;
+    record. Nvalues = (unsigned int) Nvalues;
+    fwrite (&record, sizeof (record), 1, Trace_File);
+}
+
+/* A record of Nvalues scalars, passed as double. */
+
+void trace_values( int kind, long index, int Nvalues, ... )
+{
+    va_list values;
+    int     i;
+
+    if (Trace_File == NULL) {
+        return;
+    }
+    trace_record (kind, index, Nvalues);
+    va_start (values, Nvalues);
+    for (i = 0; i < Nvalues; i++) {
+        float value = (float) va_arg (values, double);
+        fwrite (&value, sizeof (value), 1, Trace_File);
+    }
+    va_end (values);
+}
+
+/* A record of the n values of an array, one per frame. */
+
+void trace_array( int kind, const float * x, long n )
+{
+    if (Trace_File == NULL) {
+        return;
+    }
+    trace_record (kind, 0, n);
+    fwrite (x, sizeof (float), n, Trace_File);
+}
+
+void trace_utterances( ERROR_INFO * err_info )
+{
+    long utt;
+
+    for (utt = 0; utt < err_info-> Nutterances; utt++) {
+        trace_values (TRACE_UTTERANCE, utt, 5, (double) err_info-> Utt_Start [utt],
+                      (double) err_info-> Utt_End [utt], (double) err_info-> Utt_Delay [utt],
+                      (double) err_info-> Utt_DelayEst [utt], (double) err_info-> Utt_DelayConf [utt]);
+    }
+}
+
+void trace_flush( void )
+{
+    if (Trace_File != NULL) {
+        fflush (Trace_File);
+    }
+}
+
+#endif
+
+/* END OF FILE */